@@ -0,0 +1,25 @@
+# The ASCII strings benchmark changes the case of, indexes and iterates
+# over plain ASCII text the way text processing code does.
+#
+# The correct result is [4000, 3770000, 484000].
+
+var line = 'The Quick Brown Fox Jumps Over The Lazy Dog, again and again. '
+var text = line * 8
+
+var start = microtime()
+
+var upper = 0, chars = 0, vowels = 0
+for i in 0..4000 {
+  if text.upper().lower() == text.lower() upper++
+  chars += text.length() + text[i % 100,].length()
+
+  for c in text[0, 440] {
+    if c == 'a' or c == 'e' or c == 'i' or c == 'o' or c == 'u' vowels++
+  }
+}
+
+echo [upper, chars, vowels]
+
+var end = microtime()
+
+echo 'Time taken = ${(end - start) / 1000000} seconds'
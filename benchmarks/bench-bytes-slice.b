@@ -0,0 +1,36 @@
+# The bytes slice benchmark splits a large binary payload into records and
+# slices every record into its header and body the way a protocol parser
+# would.
+#
+# The correct result is [5000, 5000, 20435000].
+
+var record = bytes(4095)
+for i in 0..4095 record[i] = i % 255 + 1
+
+var payload = bytes(0)
+for i in 0..5000 {
+  payload.extend(record)
+  payload.append(0)
+}
+
+var start = microtime()
+
+var records = 0, headers = 0, body_length = 0
+for r in 0..10 {
+  var parts = payload.split(bytes([0]))
+  for part in parts {
+    if part.length() == 0 continue
+
+    var header = part[0, 8]
+    var body = part[8,]
+    if header[0] == 1 headers++
+    body_length += body.length()
+    records++
+  }
+}
+
+echo [records / 10, headers / 10, body_length / 10]
+
+var end = microtime()
+
+echo 'Time taken = ${(end - start) / 1000000} seconds'
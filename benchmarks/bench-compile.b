@@ -0,0 +1,51 @@
+# The compile benchmark compiles every module of the standard library into
+# a bytecode image ten times. The modules, and the modules they import, are
+# compiled from their source every time so that this measures the scanner
+# and the compiler on real code.
+#
+# The correct result is 10 images written, followed by the number of lines
+# compiled per second.
+
+import os
+import _reflect
+
+var libs_dir = os.join_paths(os.dir_name(os.exe_path), 'libs')
+var image_file = os.join_paths(os.get_env('TMPDIR', '/tmp'), 'blade-bench-compile.bbi')
+
+def find_modules(dir, files) {
+  for name in os.read_dir(dir).sort() {
+    if name == '.' or name == '..' continue
+
+    var path = os.join_paths(dir, name)
+    if os.is_dir(path) {
+      find_modules(path, files)
+    } else if name.ends_with('.b') and !name.ends_with('.stub.b') {
+      files.append(path)
+    }
+  }
+
+  return files
+}
+
+var files = find_modules(libs_dir, [])
+
+var lines = 0
+for path in files {
+  lines += file(path).read().split('\n').length()
+}
+
+var start = microtime()
+
+var images = 0
+for i in 0..10 {
+  if _reflect.makeimage(image_file, libs_dir, files) images++
+}
+
+var end = microtime()
+
+echo images
+echo '${to_int(lines * 10 / ((end - start) / 1000000))} lines per second'
+
+file(image_file).delete()
+
+echo 'Time taken = ${(end - start) / 1000000} seconds'
@@ -0,0 +1,22 @@
+# The interpolation benchmark formats access log lines and HTML table rows
+# from template strings the way request logging and page rendering do.
+#
+# The correct result is a total length of 120073154.
+
+var methods = ['GET', 'POST', 'PUT', 'DELETE']
+
+var start = microtime()
+
+var total = 0
+for i in 0..1000000 {
+  var method = methods[i % 4], path = '/items/${i % 1000}'
+  var line = '${i} ${method} ${path} ${200 + i % 3} ${i % 4096}b in ${i % 97}ms'
+  var row = '<tr><td>${i}</td><td>${method}</td><td><a href="${path}">${path}</a></td></tr>'
+  total += line.length() + row.length()
+}
+
+echo total
+
+var end = microtime()
+
+echo 'Time taken = ${(end - start) / 1000000} seconds'
@@ -0,0 +1,23 @@
+# The number format benchmark converts integers and fractions to strings the
+# way the JSON and CSV writers do, through interpolation, concatenation and
+# to_string().
+#
+# The correct result is 4000000 conversions with a total length of 47087428.
+
+var start = microtime()
+
+var total = 0, conversions = 0
+for i in 0..1000000 {
+  var fraction = i / 7
+  total += '${i}'.length()
+  total += ('' + fraction).length()
+  total += to_string(-i * 3).length()
+  total += to_string(fraction * 0.001).length()
+  conversions += 4
+}
+
+echo [conversions, total]
+
+var end = microtime()
+
+echo 'Time taken = ${(end - start) / 1000000} seconds'
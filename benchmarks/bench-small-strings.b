@@ -0,0 +1,19 @@
+# The small strings benchmark creates many distinct short strings the way
+# tokenizers and serializers do, from short prefixes and small numbers.
+#
+# The correct result is 25619047.
+
+var start = microtime()
+
+var length = 0
+for i in 0..1000000 {
+  var id = 'id:' + i
+  var pair = id + '=' + (i * 7)
+  length += id.length() + pair.length()
+}
+
+echo length
+
+var end = microtime()
+
+echo 'Time taken = ${(end - start) / 1000000} seconds'
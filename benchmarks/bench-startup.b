@@ -0,0 +1,22 @@
+# The startup benchmark runs a short script that imports some of the larger
+# standard library modules fifty times, the way a command line tool would be
+# started again and again.
+#
+# The correct result is 50 runs that printed 1.
+
+import os
+
+var script = '"${os.exe_path}" -c "import markdown; import bigint; import url; import date; echo 1"'
+
+var start = microtime()
+
+var runs = 0
+for i in 0..50 {
+  if os.exec(script).trim() == '1' runs++
+}
+
+echo runs
+
+var end = microtime()
+
+echo 'Time taken = ${(end - start) / 1000000} seconds'
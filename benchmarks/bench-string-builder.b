@@ -0,0 +1,37 @@
+# The string builder benchmark renders a large HTML table once by appending
+# to a string with += and once with a StringBuilder.
+#
+# The correct result is two identical tables of 218905 characters each.
+
+import stringbuilder
+
+var rows = 10000
+
+var start = microtime()
+
+var html = '<table>'
+for i in 0..rows {
+  html += '<tr><td>'
+  html += i
+  html += '</td></tr>'
+}
+html += '</table>'
+
+var middle = microtime()
+
+var sb = stringbuilder()
+sb.append('<table>')
+for i in 0..rows {
+  sb.append('<tr><td>')
+  sb.append(i)
+  sb.append('</td></tr>')
+}
+sb.append('</table>')
+var built = sb.to_string()
+
+var end = microtime()
+
+echo [html.length(), built.length(), html == built]
+
+echo 'Time taken (+=) = ${(middle - start) / 1000000} seconds'
+echo 'Time taken (StringBuilder) = ${(end - middle) / 1000000} seconds'
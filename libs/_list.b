@@ -1,86 +1,5 @@
 # -- Extensions for the builtin list object
 
-import math
-
-def _default_comparator(a, b) {
-  if is_number(a) and is_number(b) {
-    return a > b
-  } else if is_string(a) and is_string(b) {
-    return a.compare(b) > 0
-  } else {
-    raise Exception('Default comparator only supports numbers and strings. You must provide a custom comparator for other types.')
-  }
-}
-
-var _MIN_MERGE = 32
-
-def _min_run_length(n) {
-  var r = 0
-  while n >= _MIN_MERGE {
-    r |= (n & 1)
-    n >>= 1
-  }
-  return n + r
-}
-
-def _binary_insertion_sort(arr, left, right, comparator) {
-  for i in (left + 1)..(right + 1) {
-    var val = arr[i]
-    var l = left
-    var r = i - 1
-
-    while l <= r {
-      var mid = (l + r) >> 1
-      # Use comparator: val < arr[mid]
-      if !comparator(val, arr[mid]) {
-        r = mid - 1
-      } else {
-        l = mid + 1
-      }
-    }
-
-    var j = i
-    while j > l {
-      arr[j] = arr[j - 1]
-      j--
-    }
-    arr[l] = val
-  }
-}
-
-# PLUG 2: Pass 'comparator' here
-def _merge(arr, l, m, r, temp_buffer, comparator) {
-  var len1 = m - l + 1
-  var len2 = r - m
-
-  for i in 0..len1 {
-    temp_buffer[i] = arr[l + i]
-  }
-
-  var i = 0
-  var j = m + 1
-  var k = l
-
-  while i < len1 and j <= r {
-    # Use comparator: temp_buffer[i] <= arr[j]
-    # We check <= 0 to maintain stability
-    if !comparator(temp_buffer[i], arr[j]) {
-      arr[k] = temp_buffer[i]
-      i++
-    } else {
-      arr[k] = arr[j]
-      j++
-    }
-    k++
-  }
-
-  while i < len1 {
-    arr[k] = temp_buffer[i]
-    k++
-    i++
-  }
-}
-
 class _ListExtension > list {
 
   /**
@@ -108,8 +27,11 @@ class _ListExtension > list {
    *
    * The `isort` method returns the same list that it is called on.
    *
+   * The comparator is called with two items `a` and `b` and must return `true` (or a
+   * positive number) when `a` should be placed after `b`.
+   *
    * @param {function|nil} comparator Optional comparator function to use for sorting.
-   * @default Uses default comparator.
+   * @default Uses the same ordering as `list.sort()`.
    * @returns {list}
    *
    * Example:
@@ -138,40 +60,12 @@ class _ListExtension > list {
    * with equal keys.
    */
   static isort(comparator) {
-    # Timsort implementation in Blade
-
-    if !comparator comparator = _default_comparator
     if comparator != nil and !is_function(comparator) {
       raise Exception('Comparator must be a function.')
     }
 
-    var arr = self
-
-    var n = arr.length()
-    if (n < 2) return arr
-
-    var min_run = _min_run_length(n)
-
-    for i in 0..n.step(min_run) {
-      _binary_insertion_sort(arr, i, min(i + min_run - 1, n - 1), comparator)
-    }
-
-    var temp_buffer = [nil] * (n / 2 + 1)
-
-    var size = min_run
-    while size < n {
-      for left in 0..n.step(2 * size) {
-        var mid = left + size - 1
-        var right = min(left + 2 * size - 1, n - 1)
-
-        if mid < right {
-          _merge(arr, left, mid, right, temp_buffer, comparator)
-        }
-      }
-      size *= 2
-    }
-
-    return self
+    # the native sort engine is a stable Timsort.
+    return self.sort(comparator)
   }
 
   /**
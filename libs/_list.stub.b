@@ -427,9 +427,19 @@ class list {
    * > and the strings in turn, preceeds the list in the result. Also, note that the items of the inner 
    * > list is sorted.
    * 
+   * When a comparator function is given, it is called with two items `a` and `b` and must 
+   * return `true` (or a positive number) if `a` should be placed after `b`. Sorting is stable 
+   * so items that compare equal keep their relative order.
+   * 
+   * ```blade-repl
+   * %> [3, 1, 2].sort(@(a, b) { return a < b })
+   * [3, 2, 1]
+   * ```
+   * 
+   * @param {function?} comparator
    * @return {list}
    */
-  sort() {}
+  sort(comparator) {}
 
 
   /**
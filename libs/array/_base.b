@@ -1,4 +1,4 @@
-import _struct
+import _array
 
 /**
  * This is the base array class from which all other array types inherit. It is not meant to be used directly.
@@ -25,15 +25,6 @@ class Array {
    */
   var _data_type = 'c'
 
-  /**
-   * The method that sets the value at the given index.
-   * 
-   * @should_override
-   */
-  _do_set(start, as_bytes) {
-    self._data[start] = as_bytes[0]
-  }
-
   /**
    * Returns the number of items in the array. 
    * 
@@ -58,15 +49,7 @@ class Array {
    * @returns number?
    */
   first() {
-    if self.length() > 0 {
-      return _struct.unpack(
-        self._data_type, 
-        self._data[,self._bit_size], 
-        0
-      ).values().first()
-    }
-
-    return nil
+    return _array.get(self._data, self._data_type, 0)
   }
 
   /**
@@ -75,15 +58,7 @@ class Array {
    * @returns number?
    */
   last() {
-    if self.length() > 0 {
-      return _struct.unpack(
-        self._data_type, 
-        self._data[self._data.length() - self._bit_size,], 
-        0
-      ).values().first()
-    }
-
-    return nil
+    return _array.get(self._data, self._data_type, self.length() - 1)
   }
 
   /**
@@ -98,16 +73,7 @@ class Array {
     if !is_number(index)
       raise ArgumentError('Arrays are numerically indexed')
 
-    if self.length() > index {
-      var start = index * self._bit_size
-      return _struct.unpack(
-        self._data_type, 
-        self._data[start, start + self._bit_size], 
-        0
-      ).values().first()
-    }
-
-    return nil
+    return _array.get(self._data, self._data_type, index)
   }
 
   /**
@@ -116,12 +82,7 @@ class Array {
    * @returns number?
    */
   pop() {
-    var last = self.last()
-    if last != nil {
-      self._data = self._data[,-self._bit_size]
-    }
-
-    return last
+    return _array.pop(self._data, self._data_type)
   }
 
   /**
@@ -139,11 +100,82 @@ class Array {
    * @returns list
    */
   to_list() {
-    return _struct.unpack(
-      '${self._data_type}${self.length()}', 
-      self._data, 
-      0
-    ).values()
+    return _array.tolist(self._data, self._data_type)
+  }
+
+  /**
+   * Sets every item from index _start_ up to but not including index _end_ 
+   * to _value_. If _start_ is not given, it defaults to 0 and if _end_ is 
+   * not given, it defaults to the length of the array. Negative indexes 
+   * count from the end of the array.
+   * 
+   * @param number value
+   * @param number? start
+   * @param number? end
+   */
+  fill(value, start, end) {
+    if !is_number(value)
+      raise ArgumentError('number expected')
+    _array.fill(self._data, self._data_type, value, start, end)
+  }
+
+  /**
+   * Returns a list of the items from index _start_ up to but not including 
+   * index _end_. If _start_ is not given, it defaults to 0 and if _end_ is 
+   * not given, it defaults to the length of the array. Negative indexes 
+   * count from the end of the array.
+   * 
+   * @param number? start
+   * @param number? end
+   * @returns list
+   */
+  slice(start, end) {
+    return _array.tolist(_array.slice(self._data, self._data_type, start, end), self._data_type)
+  }
+
+  /**
+   * Copies all the items in _array_ into the current array starting at 
+   * index _at_, overwriting existing items and growing the array when 
+   * required. _array_ must be of the same type as the current array.
+   * 
+   * @param Array array
+   * @param number? at: Default = 0
+   */
+  copy(array, at) {
+    if typeof(array) != typeof(self)
+      raise TypeError('instance of ${typeof(self)} expected')
+    if at == nil at = 0
+    if !is_number(at)
+      raise ArgumentError('Arrays are numerically indexed')
+
+    _array.copy(self._data, self._data_type, at, array.to_bytes())
+  }
+
+  /**
+   * Returns the sum of all the items in the array.
+   * 
+   * @returns number
+   */
+  sum() {
+    return _array.sum(self._data, self._data_type)
+  }
+
+  /**
+   * Returns the smallest item in the array or nil if the array is empty.
+   * 
+   * @returns number?
+   */
+  min() {
+    return _array.min(self._data, self._data_type)
+  }
+
+  /**
+   * Returns the largest item in the array or nil if the array is empty.
+   * 
+   * @returns number?
+   */
+  max() {
+    return _array.max(self._data, self._data_type)
   }
 
   /**
@@ -174,10 +206,10 @@ class Array {
   }
 
   @itern(n) {
-    if index == nil return 0
-    if !is_number(index)
+    if n == nil return self.length() > 0 ? 0 : nil
+    if !is_number(n)
       raise ArgumentError('Arrays are numerically indexed')
-    if index < self.length() - 1 return index + 1
+    if n < self.length() - 1 return n + 1
     return nil
   }
 }
\ No newline at end of file
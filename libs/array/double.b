@@ -1,4 +1,4 @@
-import _struct
+import _array
 import ._base { Array }
 
 
@@ -34,8 +34,10 @@ class DoubleArray < Array {
    * number of elements, but with all the elements set to 0. 
    * - If n is a list, it creates a new DoubleArray with its elements set to 
    * the values in the list.
+   * - If n is a bytes, it creates a new DoubleArray with its elements read 
+   * from a copy of the bytes in the platform byte order.
    * 
-   * @param {number|list} n
+   * @param {number|list|bytes} n
    * @constructor
    */
   DoubleArray(n) {
@@ -49,9 +51,14 @@ class DoubleArray < Array {
         }
       }
 
-      self._data = _struct.pack('${self._data_type}${n.length()}', n)
+      self._data = _array.fromlist(self._data_type, n)
+    } else if is_bytes(n) {
+      if n.length() % self._bit_size != 0
+        raise ValueError('bytes length must be a multiple of ${self._bit_size}')
+
+      self._data = n.clone()
     } else {
-      raise TypeError('number or list expected, ${typeof(n)} given')
+      raise TypeError('number, list or bytes expected, ${typeof(n)} given')
     }
   }
 
@@ -66,20 +73,7 @@ class DoubleArray < Array {
     if value < DOUBLE_MIN or value > DOUBLE_MAX
       raise ValueError('value out of float range')
 
-    var as_bytes = _struct.pack(self._data_type, [value])
-    self._data.extend(as_bytes)
-    as_bytes.dispose()
-  }
-
-  _do_set(start, as_bytes) {
-    self._data[start] = as_bytes[0]
-    self._data[start + 1] = as_bytes[1]
-    self._data[start + 2] = as_bytes[2]
-    self._data[start + 3] = as_bytes[3]
-    self._data[start + 4] = as_bytes[4]
-    self._data[start + 5] = as_bytes[5]
-    self._data[start + 6] = as_bytes[6]
-    self._data[start + 7] = as_bytes[7]
+    _array.append(self._data, self._data_type, value)
   }
 
   /**
@@ -95,21 +89,7 @@ class DoubleArray < Array {
     if !is_number(value)
       raise ArgumentError('DoubleArray stores numerical values')
 
-    var as_bytes = _struct.pack(self._data_type, [value])
-    var start = index * self._bit_size
-    
-    if self.length() <= index {
-      var diff = index - self.length() + 1 # +1 for the new data
-
-      var extension = bytes(diff * self._bit_size)
-      self._data.extend(extension)
-      extension.dispose()
-    }
-
-    self._do_set(start, as_bytes)
-    as_bytes.dispose()
-
-    return value
+    return _array.set(self._data, self._data_type, index, value)
   }
 
   /**
@@ -131,8 +111,7 @@ class DoubleArray < Array {
    * @returns [[array.DoubleArray]]
    */
   reverse() {
-    var data = self.to_list().reverse()
-    return DoubleArray(data)
+    return DoubleArray(_array.reverse(self._data, self._data_type))
   }
 
   /**
@@ -142,6 +121,6 @@ class DoubleArray < Array {
    * @returns DoubleArray
    */
   clone() {
-    return DoubleArray(self.to_list())
+    return DoubleArray(self._data)
   }
 }
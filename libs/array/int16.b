@@ -1,4 +1,4 @@
-import _struct
+import _array
 import ._base { Array }
 
 
@@ -34,8 +34,10 @@ class Int16Array < Array {
    * number of elements, but with all the elements set to 0. 
    * - If n is a list, it creates a new Int16Array with its elements set to 
    * the values in the list.
+   * - If n is a bytes, it creates a new Int16Array with its elements read 
+   * from a copy of the bytes in the platform byte order.
    * 
-   * @param {number|list} n
+   * @param {number|list|bytes} n
    * @constructor
    */
   Int16Array(n) {
@@ -49,9 +51,14 @@ class Int16Array < Array {
         }
       }
 
-      self._data = _struct.pack('${self._data_type}${n.length()}', n)
+      self._data = _array.fromlist(self._data_type, n)
+    } else if is_bytes(n) {
+      if n.length() % self._bit_size != 0
+        raise ValueError('bytes length must be a multiple of ${self._bit_size}')
+
+      self._data = n.clone()
     } else {
-      raise TypeError('number or list expected, ${typeof(n)} given')
+      raise TypeError('number, list or bytes expected, ${typeof(n)} given')
     }
   }
 
@@ -66,14 +73,7 @@ class Int16Array < Array {
     if value < INT16_MIN or value > INT16_MAX
       raise ValueError('value out of int16 range')
 
-    var as_bytes = _struct.pack(self._data_type, [value])
-    self._data.extend(as_bytes)
-    as_bytes.dispose()
-  }
-
-  _do_set(start, as_bytes) {
-    self._data[start] = as_bytes[0]
-    self._data[start + 1] = as_bytes[1]
+    _array.append(self._data, self._data_type, value)
   }
 
   /**
@@ -89,21 +89,7 @@ class Int16Array < Array {
     if !is_number(value) and !is_int(value)
       raise ArgumentError('Int16Array stores integer values')
 
-    var as_bytes = _struct.pack(self._data_type, [value])
-    var start = index * self._bit_size
-    
-    if self.length() <= index {
-      var diff = index - self.length() + 1 # +1 for the new data
-
-      var extension = bytes(diff * self._bit_size)
-      self._data.extend(extension)
-      extension.dispose()
-    }
-
-    self._do_set(start, as_bytes)
-    as_bytes.dispose()
-
-    return value
+    return _array.set(self._data, self._data_type, index, value)
   }
 
   /**
@@ -125,8 +111,7 @@ class Int16Array < Array {
    * @returns [[array.Int16Array]]
    */
   reverse() {
-    var data = self.to_list().reverse()
-    return Int16Array(data)
+    return Int16Array(_array.reverse(self._data, self._data_type))
   }
 
   /**
@@ -136,6 +121,6 @@ class Int16Array < Array {
    * @returns Int16Array
    */
   clone() {
-    return Int16Array(self.to_list())
+    return Int16Array(self._data)
   }
 }
@@ -1,4 +1,4 @@
-import _struct
+import _array
 import ._base { Array }
 
 
@@ -28,8 +28,10 @@ class UInt16Array < Array {
    * number of elements, but with all the elements set to 0. 
    * - If n is a list, it creates a new UInt16Array with its elements set to 
    * the values in the list.
+   * - If n is a bytes, it creates a new UInt16Array with its elements read 
+   * from a copy of the bytes in the platform byte order.
    * 
-   * @param {number|list} n
+   * @param {number|list|bytes} n
    * @constructor
    */
   UInt16Array(n) {
@@ -43,9 +45,14 @@ class UInt16Array < Array {
         }
       }
 
-      self._data = _struct.pack('${self._data_type}${n.length()}', n)
+      self._data = _array.fromlist(self._data_type, n)
+    } else if is_bytes(n) {
+      if n.length() % self._bit_size != 0
+        raise ValueError('bytes length must be a multiple of ${self._bit_size}')
+
+      self._data = n.clone()
     } else {
-      raise TypeError('number or list expected, ${typeof(n)} given')
+      raise TypeError('number, list or bytes expected, ${typeof(n)} given')
     }
   }
 
@@ -60,14 +67,7 @@ class UInt16Array < Array {
     if value < 0 or value > UINT16_MAX
       raise ValueError('value out of uint16 range')
 
-    var as_bytes = _struct.pack(self._data_type, [value])
-    self._data.extend(as_bytes)
-    as_bytes.dispose()
-  }
-
-  _do_set(start, as_bytes) {
-    self._data[start] = as_bytes[0]
-    self._data[start + 1] = as_bytes[1]
+    _array.append(self._data, self._data_type, value)
   }
 
   /**
@@ -83,21 +83,7 @@ class UInt16Array < Array {
     if !is_number(value) and !is_int(value)
       raise ArgumentError('UInt16Array stores integer values')
 
-    var as_bytes = _struct.pack(self._data_type, [value])
-    var start = index * self._bit_size
-    
-    if self.length() <= index {
-      var diff = index - self.length() + 1 # +1 for the new data
-
-      var extension = bytes(diff * self._bit_size)
-      self._data.extend(extension)
-      extension.dispose()
-    }
-
-    self._do_set(start, as_bytes)
-    as_bytes.dispose()
-
-    return value
+    return _array.set(self._data, self._data_type, index, value)
   }
 
   /**
@@ -119,8 +105,7 @@ class UInt16Array < Array {
    * @returns [[array.UInt16Array]]
    */
   reverse() {
-    var data = self.to_list().reverse()
-    return UInt16Array(data)
+    return UInt16Array(_array.reverse(self._data, self._data_type))
   }
 
   /**
@@ -130,6 +115,6 @@ class UInt16Array < Array {
    * @returns UInt16Array
    */
   clone() {
-    return UInt16Array(self.to_list())
+    return UInt16Array(self._data)
   }
 }
@@ -1,4 +1,4 @@
-import _struct
+import _array
 import ._base { Array }
 
 
@@ -28,8 +28,10 @@ class UInt32Array < Array {
    * number of elements, but with all the elements set to 0. 
    * - If n is a list, it creates a new UInt32Array with its elements set to 
    * the values in the list.
+   * - If n is a bytes, it creates a new UInt32Array with its elements read 
+   * from a copy of the bytes in the platform byte order.
    * 
-   * @param {number|list} n
+   * @param {number|list|bytes} n
    * @constructor
    */
   UInt32Array(n) {
@@ -43,9 +45,14 @@ class UInt32Array < Array {
         }
       }
 
-      self._data = _struct.pack('${self._data_type}${n.length()}', n)
+      self._data = _array.fromlist(self._data_type, n)
+    } else if is_bytes(n) {
+      if n.length() % self._bit_size != 0
+        raise ValueError('bytes length must be a multiple of ${self._bit_size}')
+
+      self._data = n.clone()
     } else {
-      raise TypeError('number or list expected, ${typeof(n)} given')
+      raise TypeError('number, list or bytes expected, ${typeof(n)} given')
     }
   }
 
@@ -60,16 +67,7 @@ class UInt32Array < Array {
     if value < 0 or value > UINT32_MAX
       raise ValueError('value out of uint32 range')
 
-    var as_bytes = _struct.pack(self._data_type, [value])
-    self._data.extend(as_bytes)
-    as_bytes.dispose()
-  }
-
-  _do_set(start, as_bytes) {
-    self._data[start] = as_bytes[0]
-    self._data[start + 1] = as_bytes[1]
-    self._data[start + 2] = as_bytes[2]
-    self._data[start + 3] = as_bytes[3]
+    _array.append(self._data, self._data_type, value)
   }
 
   /**
@@ -85,21 +83,7 @@ class UInt32Array < Array {
     if !is_number(value) and !is_int(value)
       raise ArgumentError('UInt32Array stores integer values')
 
-    var as_bytes = _struct.pack(self._data_type, [value])
-    var start = index * self._bit_size
-    
-    if self.length() <= index {
-      var diff = index - self.length() + 1 # +1 for the new data
-
-      var extension = bytes(diff * self._bit_size)
-      self._data.extend(extension)
-      extension.dispose()
-    }
-
-    self._do_set(start, as_bytes)
-    as_bytes.dispose()
-
-    return value
+    return _array.set(self._data, self._data_type, index, value)
   }
 
   /**
@@ -121,8 +105,7 @@ class UInt32Array < Array {
    * @returns [[array.UInt32Array]]
    */
   reverse() {
-    var data = self.to_list().reverse()
-    return UInt32Array(data)
+    return UInt32Array(_array.reverse(self._data, self._data_type))
   }
 
   /**
@@ -132,6 +115,6 @@ class UInt32Array < Array {
    * @returns UInt32Array
    */
   clone() {
-    return UInt32Array(self.to_list())
+    return UInt32Array(self._data)
   }
 }
@@ -0,0 +1,200 @@
+/**
+ * @module heap
+ *
+ * This module provides a binary heap that can be used as a priority queue.
+ *
+ * Heaps always keep their smallest item at the top so that it can be read
+ * with [[heap.Heap.peek()]] or removed with [[heap.Heap.pop()]] in O(log n)
+ * time while new items are added with [[heap.Heap.push()]] in O(log n) time.
+ *
+ * ```blade
+ * import heap
+ *
+ * var h = heap([5, 1, 4])
+ * h.push(3)
+ *
+ * echo h.pop() # 1
+ * echo h.pop() # 3
+ * echo h.peek() # 4
+ * ```
+ *
+ * Items are ordered the same way as [[list.sort()]] orders them unless a
+ * comparator function is given. The comparator is called with two items
+ * _a_ and _b_ and should return a number greater than zero (or `true`) when
+ * _a_ should come after _b_. For example, a heap that always returns the
+ * largest number first can be created like this:
+ *
+ * ```blade
+ * import heap
+ *
+ * var h = heap([5, 1, 4], @(a, b) { return b - a })
+ * echo h.pop() # 5
+ * ```
+ *
+ * @copyright Richard Ore, 2025
+ */
+
+import _heap
+
+
+/**
+ * The Heap class is a priority queue backed by a binary min-heap.
+ *
+ * @printable
+ * @serializable
+ */
+class Heap {
+
+  var _items
+  var _comparator
+
+  /**
+   * Creates a new Heap containing the items in the given list or an empty
+   * Heap when no list is given. The list itself is not modified.
+   *
+   * @param list? items
+   * @param function? comparator
+   * @constructor
+   */
+  Heap(items, comparator) {
+    if items != nil and !is_list(items) {
+      raise TypeError('expected list, ${typeof(items)} given')
+    }
+    if comparator != nil and !is_function(comparator) {
+      raise TypeError('expected function, ${typeof(comparator)} given')
+    }
+
+    self._comparator = comparator
+    self._items = items ? items.clone() : []
+    _heap.heapify(self._items, comparator)
+  }
+
+  /**
+   * Adds the given value to the heap.
+   *
+   * @param any value
+   */
+  push(value) {
+    _heap.push(self._items, value, self._comparator)
+  }
+
+  /**
+   * Adds all the items in the given list to the heap.
+   *
+   * @param list values
+   */
+  push_all(values) {
+    if !is_list(values) {
+      raise TypeError('expected list, ${typeof(values)} given')
+    }
+
+    if values.length() > self._items.length() {
+      self._items.extend(values)
+      _heap.heapify(self._items, self._comparator)
+    } else {
+      for value in values {
+        _heap.push(self._items, value, self._comparator)
+      }
+    }
+  }
+
+  /**
+   * Removes and returns the smallest item in the heap or nil if the heap
+   * is empty.
+   *
+   * @returns any
+   */
+  pop() {
+    return _heap.pop(self._items, self._comparator)
+  }
+
+  /**
+   * Adds the given value to the heap and then removes and returns the
+   * smallest item. This is faster than calling push() followed by pop().
+   *
+   * @param any value
+   * @returns any
+   */
+  push_pop(value) {
+    return _heap.pushpop(self._items, value, self._comparator)
+  }
+
+  /**
+   * Returns the smallest item in the heap without removing it or nil if
+   * the heap is empty.
+   *
+   * @returns any
+   */
+  peek() {
+    return _heap.peek(self._items)
+  }
+
+  /**
+   * Returns the number of items in the heap.
+   *
+   * @returns number
+   */
+  length() {
+    return self._items.length()
+  }
+
+  /**
+   * Returns `true` if the heap contains no item or `false` otherwise.
+   *
+   * @returns bool
+   */
+  is_empty() {
+    return self._items.length() == 0
+  }
+
+  /**
+   * Removes all items from the heap.
+   */
+  clear() {
+    self._items.clear()
+  }
+
+  /**
+   * Returns the items in the heap as a list in the order they would be
+   * popped. The heap itself is not modified.
+   *
+   * @returns list
+   */
+  to_list() {
+    return self._items.clone().sort(self._comparator)
+  }
+
+  /**
+   * Returns a string representation of the heap.
+   *
+   * @returns string
+   */
+  to_string() {
+    return '<Heap(${self._items.length()})>'
+  }
+
+  @to_string() {
+    return self.to_string()
+  }
+
+  @to_list() {
+    return self.to_list()
+  }
+
+  @to_json() {
+    return self.to_list()
+  }
+}
+
+
+/**
+ * Default export function for the [[heap.Heap]] class.
+ *
+ * @param list? items
+ * @param function? comparator
+ * @returns [[heap.Heap]]
+ * @default
+ */
+def heap(items, comparator) {
+  return Heap(items, comparator)
+}
@@ -8,12 +8,14 @@ import .defaults
 import url
 import socket
 import url
-import ssl
 import hash
 import mime
-import zlib
 import json
-import convert
+
+# only needed for https, compressed and chunked responses.
+import lazy ssl
+import lazy zlib
+import lazy convert
 
 var _host_name_prefix = '/^[a-z0-9\-]+[.]/'
 var _host_name_postfix = '/[.][a-z0-9\-]+$/'
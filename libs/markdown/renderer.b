@@ -1,4 +1,5 @@
 import .common.utils { assign, unescape_all, escape_html }
+import stringbuilder { StringBuilder }
 
 var default_rules = {}
 
@@ -239,7 +240,7 @@ class Renderer {
    */
   render_inline(tokens, options, env) {
     var type,
-        result = '',
+        result = StringBuilder(),
         rules = self.rules,
         i = 0
   
@@ -247,13 +248,13 @@ class Renderer {
       type = tokens[i].type
   
       if rules.contains(type) {
-        result += rules[type](tokens, i, options, env, self)
+        result.append(rules[type](tokens, i, options, env, self))
       } else {
-        result += self.render_token(tokens, i, options)
+        result.append(self.render_token(tokens, i, options))
       }
     }
   
-    return result
+    return result.to_string()
   }
 
   /**
@@ -268,19 +269,19 @@ class Renderer {
    * @internal
    */
   render_inline_as_text(tokens, options, env) {
-    var result = '', i = 0
+    var result = StringBuilder(), i = 0
   
     iter var len = tokens.length(); i < len; i++ {
       if tokens[i].type == 'text' {
-        result += tokens[i].content
+        result.append(tokens[i].content)
       } else if tokens[i].type == 'image' {
-        result += self.render_inline_as_text(tokens[i].children, options, env)
+        result.append(self.render_inline_as_text(tokens[i].children, options, env))
       } else if tokens[i].type == 'softbreak' {
-        result += '\n'
+        result.append('\n')
       }
     }
   
-    return result
+    return result.to_string()
   }
 
   /**
@@ -294,22 +295,22 @@ class Renderer {
    **/
   render(tokens, options, env) {
     var i = 0, len, type,
-        result = '',
+        result = StringBuilder(),
         rules = self.rules
   
     iter len = tokens.length(); i < len; i++ {
       type = tokens[i].type
   
       if type == 'inline' {
-        result += self.render_inline(tokens[i].children, options, env)
+        result.append(self.render_inline(tokens[i].children, options, env))
       } else if rules.contains(type) {
-        result += rules[type](tokens, i, options, env, self)
+        result.append(rules[type](tokens, i, options, env, self))
       } else {
-        result += self.render_token(tokens, i, options)
+        result.append(self.render_token(tokens, i, options))
       }
     }
   
-    return result
+    return result.to_string()
   }
 }
 
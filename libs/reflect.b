@@ -399,3 +399,39 @@ def run_script(path) {
 def call_function(function, args) {
   return _reflect.callfunction(function, args)
 }
+
+/**
+ * Saves the state of the program to the file at the given path and returns 
+ * `false`. Running `blade -r <path>` later resumes the program from this 
+ * call with it returning `true` instead, skipping everything the program did 
+ * before it such as importing modules and building its data.
+ * 
+ * The snapshot holds every value the program can reach. Native modules are 
+ * bound again when it is resumed, but open files and pointers returned by 
+ * native functions cannot be saved. Snapshots can only be saved from the main 
+ * thread and not from functions called by native functions such as the 
+ * callback of `list.map()`.
+ * 
+ * For example,
+ * 
+ * ```blade
+ * import reflect
+ * 
+ * var routes = build_routes()  # expensive
+ * 
+ * if !reflect.snapshot('app.snapshot') {
+ *   echo 'Snapshot saved'
+ * } else {
+ *   serve(routes)
+ * }
+ * ```
+ * 
+ * @param string path
+ * @returns bool
+ */
+def snapshot(path) {
+  if !is_string(path)
+    raise TypeError('string expected in argument 1 (path)')
+
+  return _reflect.snapshot(path)
+}
@@ -69,7 +69,12 @@
  */
 
 import _reflect
+import _set
 
+# returns the member storage of another Set.
+def _members(set) {
+  return _reflect.getprop(set, '_items')
+}
 
 /**
  * The Set class provides some methods that allow you to compose sets like 
@@ -82,7 +87,8 @@ import _reflect
  */
 class Set {
 
-  var _items = []
+  # members are kept as the keys of a dictionary for O(1) lookups.
+  var _items
 
   /**
    * Creates a new Set object from a list or dictionary or an empty Set object 
@@ -92,18 +98,12 @@ class Set {
    * @constructor
    */
   Set(items) {
-    if items != nil {
-      if !is_list(items) and !is_dict(items) {
-        raise TypeError('expected list or dictionary, ${tyepof(items)} given')
-      }
-  
-      if is_dict(items) {
-        items = items.keys()
-      }
-  
-      # only keep unique items
-      self._items = items.unique()
+    if items != nil and !is_list(items) and !is_dict(items) {
+      raise TypeError('expected list or dictionary, ${typeof(items)} given')
     }
+
+    # only keep unique items
+    self._items = _set.create(items)
   }
 
   /**
@@ -118,10 +118,7 @@ class Set {
       raise TypeError('instance of Set expected, ${typeof(other)} given')
     }
 
-    var items = self.to_list()
-    items.extend(other.to_list())
-
-    return Set(items)
+    return _from_members(_set.union(self._items, _members(other)))
   }
 
   /**
@@ -135,17 +132,7 @@ class Set {
       raise TypeError('instance of Set expected, ${typeof(other)} given')
     }
 
-    var common = []
-
-    if !other.is_empty() {
-      for item in self._items {
-        if other.contains(item) {
-          common.append(item)
-        }
-      }
-    }
-
-    return Set(common)
+    return _from_members(_set.intersect(self._items, _members(other)))
   }
 
   /**
@@ -159,19 +146,7 @@ class Set {
       raise TypeError('instance of Set expected, ${typeof(other)} given')
     }
 
-    var diff = []
-
-    if other.is_empty() {
-      diff.extend(self._items)
-    } else {
-      for item in self._items {
-        if !other.contains(item) {
-          diff.append(item)
-        }
-      }
-    }
-
-    return Set(diff)
+    return _from_members(_set.difference(self._items, _members(other)))
   }
 
   /**
@@ -186,27 +161,7 @@ class Set {
       raise TypeError('instance of Set expected, ${typeof(other)} given')
     }
 
-    var diff = []
-
-    if self.is_empty() {
-      diff.extend(other.to_list())
-    } else if other.is_empty() {
-      diff.extend(self._items)
-    } else {
-      for item in self._items {
-        if !other.contains(item) {
-          diff.append(item)
-        }
-      }
-
-      for item in other {
-        if !self.contains(item) {
-          diff.append(item)
-        }
-      }
-    }
-
-    return Set(diff)
+    return _from_members(_set.symmetricdifference(self._items, _members(other)))
   }
 
   /**
@@ -221,13 +176,7 @@ class Set {
       raise TypeError('instance of Set expected, ${typeof(other)} given')
     }
 
-    var intersect = self.intersect(other)
-    var is_disjoint = intersect.is_empty()
-
-    # free resource
-    intersect.clear()
-
-    return is_disjoint
+    return _set.isdisjoint(self._items, _members(other))
   }
 
   /**
@@ -241,18 +190,7 @@ class Set {
       raise TypeError('instance of Set expected, ${typeof(other)} given')
     }
 
-    # important early exit
-    if self.length() <= other.length() {
-      return false
-    }
-
-    for item in other {
-      if !self.contains(item) {
-        return false
-      }
-    }
-
-    return true
+    return _set.issubset(self._items, _members(other))
   }
 
   /**
@@ -266,18 +204,7 @@ class Set {
       raise TypeError('instance of Set expected, ${typeof(other)} given')
     }
 
-    # important early exit
-    if self.length() >= other.length() {
-      return false
-    }
-
-    for item in self {
-      if !other.contains(item) {
-        return false
-      }
-    }
-
-    return true
+    return _set.issubset(_members(other), self._items)
   }
 
   /**
@@ -297,7 +224,7 @@ class Set {
    * @returns bool
    */
   contains(value) {
-    return self._items.contains(value)
+    return _set.contains(self._items, value)
   }
 
   /**
@@ -328,7 +255,7 @@ class Set {
    * @returns any
    */
   remove(value) {
-    return self._items.remove(value)
+    return _set.remove(self._items, value)
   }
 
   /**
@@ -339,12 +266,7 @@ class Set {
    * @returns bool
    */
   add(value) {
-    if !self._items.contains(value) {
-      self._items.append(value)
-      return true
-    }
-
-    return false
+    return _set.add(self._items, value)
   }
 
   /**
@@ -353,7 +275,7 @@ class Set {
    * @returns [[set.Set]]
    */
   clone() {
-    return Set(self.to_list())
+    return Set(self._items)
   }
 
   /**
@@ -367,14 +289,14 @@ class Set {
       raise ArgumentError('callback function expected, ${typeof(callback)} given')
     }
 
-    var fn_meta = _reflect.getfunctionmetadata(function)
+    var fn_meta = _reflect.getfunctionmetadata(callback)
 
     if fn_meta.arity > 1 {
-      for index, item in self._items {
+      for index, item in self._items.keys() {
         callback(item, index)
       }
     } else {
-      for item in self._items {
+      for item in self._items.keys() {
         callback(item)
       }
     }
@@ -387,7 +309,7 @@ class Set {
    */
   to_string() {
     return '<Set(${self.length()}) {' +
-      ', '.join(self._items) +
+      ', '.join(self._items.keys()) +
     '}>'
   }
 
@@ -397,7 +319,7 @@ class Set {
    * @returns list
    */
   to_list() {
-    return self._items.clone()
+    return self._items.keys()
   }
 
   @to_string() {
@@ -421,7 +343,7 @@ class Set {
   }
 
   @iter(index) {
-    return self._items[index]
+    return _set.at(self._items, index)
   }
 
   def + {
@@ -445,20 +367,17 @@ class Set {
       raise NumericError('operation = not defined for Set and ${typeof(__arg__)}')
     }
 
-    if self.length() != __arg__.length() {
-      return false
-    }
-
-    for item in __arg__ {
-      if !self.contains(item) {
-        return false
-      }
-    }
-
-    return true
+    return _set.equals(self._items, _members(__arg__))
   }
 }
 
+# creates a Set that uses the given member storage.
+def _from_members(items) {
+  var set = Set()
+  _reflect.setprop(set, '_items', items)
+  return set
+}
+
 
 /**
  * Default export function for the [[set.Set]] class.
@@ -0,0 +1,139 @@
+/**
+ * @module stringbuilder
+ *
+ * This module provides a mutable buffer for building large strings piece
+ * by piece.
+ *
+ * Adding to a string with `+=` in a loop copies everything built so far on
+ * every iteration. A [[stringbuilder.StringBuilder]] grows its buffer in
+ * place instead so that each append costs time proportional only to the
+ * appended value, and the final string is created once.
+ *
+ * ```blade
+ * import stringbuilder
+ *
+ * var sb = stringbuilder()
+ * for i in 0..3 {
+ *   sb.append('<li>').append(i).append('</li>')
+ * }
+ *
+ * echo sb.to_string() # <li>0</li><li>1</li><li>2</li>
+ * ```
+ *
+ * @copyright Richard Ore, 2025
+ */
+
+import _stringbuilder
+
+
+/**
+ * The StringBuilder class builds a string from appended values.
+ *
+ * @printable
+ */
+class StringBuilder {
+
+  var _builder
+
+  /**
+   * Creates a new empty StringBuilder. When _capacity_ is given, room for
+   * that many bytes is reserved up front.
+   *
+   * @param number? capacity
+   * @constructor
+   */
+  StringBuilder(capacity) {
+    if capacity != nil and !is_number(capacity) {
+      raise TypeError('expected number, ${typeof(capacity)} given')
+    }
+
+    self._builder = capacity ? _stringbuilder.create(capacity) : _stringbuilder.create()
+  }
+
+  /**
+   * Appends the given value to the text and returns the builder so that
+   * calls can be chained. Strings, numbers and bytes are appended directly,
+   * `nil` is ignored and any other value is converted with `to_string()`.
+   *
+   * @param any value
+   * @returns [[stringbuilder.StringBuilder]]
+   */
+  append(value) {
+    if !is_string(value) and !is_number(value) and !is_bytes(value) and value != nil {
+      value = to_string(value)
+    }
+
+    _stringbuilder.append(self._builder, value)
+    return self
+  }
+
+  /**
+   * Appends every item in the given list to the text and returns the
+   * builder.
+   *
+   * @param list values
+   * @returns [[stringbuilder.StringBuilder]]
+   */
+  append_all(values) {
+    if !is_list(values) {
+      raise TypeError('expected list, ${typeof(values)} given')
+    }
+
+    for value in values {
+      self.append(value)
+    }
+    return self
+  }
+
+  /**
+   * Returns the length of the text built so far.
+   *
+   * @returns number
+   */
+  length() {
+    return _stringbuilder.length(self._builder)
+  }
+
+  /**
+   * Removes all text from the builder.
+   */
+  clear() {
+    _stringbuilder.clear(self._builder)
+  }
+
+  /**
+   * Returns the text built so far as a string. The text is moved into the
+   * string without being copied, so the builder is empty afterwards.
+   *
+   * @returns string
+   */
+  to_string() {
+    return _stringbuilder.tostring(self._builder)
+  }
+
+  /**
+   * Returns the text built so far as bytes. The text is moved into the
+   * bytes without being copied, so the builder is empty afterwards.
+   *
+   * @returns bytes
+   */
+  to_bytes() {
+    return _stringbuilder.tobytes(self._builder)
+  }
+
+  @to_string() {
+    return self.to_string()
+  }
+}
+
+
+/**
+ * Default export function for the [[stringbuilder.StringBuilder]] class.
+ *
+ * @param number? capacity
+ * @returns [[stringbuilder.StringBuilder]]
+ * @default
+ */
+def stringbuilder(capacity) {
+  return StringBuilder(capacity)
+}
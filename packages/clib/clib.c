@@ -261,6 +261,8 @@ static inline void *switch_c_values(b_vm *vm, int i, b_value value, size_t size)
     case b_clib_type_uchar_ptr: {
       unsigned char **v = N_ALLOCATE(unsigned char *, size);
       if(IS_BYTES(value)) {
+        // the function may write into the bytes.
+        unshare_bytes(vm, AS_BYTES(value));
         v[0] = AS_BYTES(value)->bytes.bytes;
       } else {
         v[0] = NULL;
@@ -274,6 +276,7 @@ static inline void *switch_c_values(b_vm *vm, int i, b_value value, size_t size)
       } else if(IS_FILE(value)) {
         v[0] = AS_FILE(value)->file;
       } else if(IS_BYTES(value)) {
+        unshare_bytes(vm, AS_BYTES(value));
         v[0] = AS_BYTES(value)->bytes.bytes;
       } else if(IS_LIST(value)) {
         b_obj_list *list = AS_LIST(value);
@@ -663,6 +663,8 @@ DECLARE_MODULE_METHOD(curl__easy_setopt) {
       RETURN_VALUE_ERROR("bytes length exceeds maximum input length of %d", CURL_MAX_INPUT_LENGTH);
     }
 
+    // curl may write into buffers such as CURLOPT_ERRORBUFFER.
+    unshare_bytes(vm, bytes);
     result = curl_easy_setopt(curl, opt, bytes->bytes.bytes);
   } else if(IS_NUMBER(args[2])) {
     result = curl_easy_setopt(curl, opt, (long)AS_NUMBER(args[2]));
@@ -44,6 +44,8 @@ const struct _json_value json_value_none;
 #include <ctype.h>
 #include <math.h>
 
+#include "value.h"
+
 typedef unsigned int json_uchar;
 
 /* There has to be a better way to do this */
@@ -247,6 +249,7 @@ json_value * json_parse_ex (json_settings * settings,
    long flags = 0;
    double num_digits = 0, num_e = 0;
    double num_fraction = 0;
+   const json_char * num_start = 0;
 
    /* Skip UTF-8 BOM
     */
@@ -685,6 +688,7 @@ json_value * json_parse_ex (json_settings * settings,
                            num_digits = 0;
                            num_fraction = 0;
                            num_e = 0;
+                           num_start = state.ptr;
 
                            if (b != '-')
                            {
@@ -868,6 +872,11 @@ json_value * json_parse_ex (json_settings * settings,
                      top->u.dbl = - top->u.dbl;
                }
 
+               /* the digits were only accumulated to validate the number, the
+                * value itself is converted exactly from the text. */
+               if (top->type == json_double)
+                  top->u.dbl = parse_number (num_start, state.ptr - num_start);
+
                flags |= flag_next | flag_reproc;
                break;
 
@@ -1,6 +1,7 @@
 #!-- part of the json module
 
 import reflect
+import stringbuilder { StringBuilder }
 
 def _get_string(value) {
   var string_data = '"' + 
@@ -97,7 +98,7 @@ class Encoder {
       when 'bytes' return _get_string(value.to_string())
       when 'string' return _get_string(value)
       when 'list' {
-        var result = ''
+        var result = StringBuilder()
         self._depth++
         for val in value {
           # inner lists will increase the depth
@@ -107,17 +108,18 @@ class Encoder {
           # json.encode to be directly compatible with the original definition
           # of JSON by JavaScript.
           catch {
-            result += ',${self._start_alignment()}${self._encode(val)}'
+            result.append(',${self._start_alignment()}${self._encode(val)}')
           }
         }
-        if result {
-          result = '[${result[self._merge_strip_start,]}${self._end_alignment()}]'
-        } else result = '[]'
+        var items = result.to_string()
+        if items {
+          items = '[${items[self._merge_strip_start,]}${self._end_alignment()}]'
+        } else items = '[]'
         self._depth--
-        return result
+        return items
       }
       when 'dictionary' {
-        var result = ''
+        var result = StringBuilder()
         self._depth++
         for key, val in value {
           # inner dictionaries will increase the depth
@@ -127,14 +129,15 @@ class Encoder {
           # json.encode to be directly compatible with the original definition
           # of JSON by JavaScript.
           catch {
-            result += ',${self._start_alignment()}"${to_string(key)}":${spacing}${self._encode(val)}'
+            result.append(',${self._start_alignment()}"${to_string(key)}":${spacing}${self._encode(val)}')
           }
         }
-        if result {
-          result = '{${result[self._merge_strip_start,]}${self._end_alignment()}}'
-        } else result = '{}'
+        var items = result.to_string()
+        if items {
+          items = '{${items[self._merge_strip_start,]}${self._end_alignment()}}'
+        } else items = '{}'
         self._depth--
-        return result
+        return items
       }
       default {
 
@@ -0,0 +1,45 @@
+/**
+ * make_image.b
+ *
+ * This script compiles every module in Blade's libs directory into a single
+ * bytecode image that imports of the standard library are loaded from
+ * instead of reading and compiling each module on every run.
+ *
+ * Usage: blade -n make_image.b <libs directory> <image file>
+ *
+ * @note This script MUST be run from CMakeLists.txt.
+ *
+ * @copyright Richard Ore
+ */
+
+import os
+import io
+import _reflect
+
+if os.args.length() < 4 {
+  io.stderr.write('Usage: make_image.b <libs directory> <image file>\n')
+  os.exit(1)
+}
+
+var libs_dir = os.real_path(os.args[2])
+var image_file = os.args[3]
+
+def find_modules(dir, files) {
+  for name in os.read_dir(dir).sort() {
+    if name == '.' or name == '..' continue
+
+    var path = os.join_paths(dir, name)
+    if os.is_dir(path) {
+      find_modules(path, files)
+    } else if name.ends_with('.b') and !name.ends_with('.stub.b') {
+      files.append(path)
+    }
+  }
+
+  return files
+}
+
+if !_reflect.makeimage(image_file, libs_dir, find_modules(libs_dir, [])) {
+  io.stderr.write('Failed to write ${image_file}\n')
+  os.exit(1)
+}
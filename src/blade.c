@@ -1,3 +1,4 @@
+#include "bytecode.h"
 #include "pathinfo.h"
 #include "util.h"
 #include "vm.h"
@@ -235,9 +236,44 @@ static void run_code(b_vm *vm, char *source) {
     exit(EXIT_RUNTIME);
 }
 
+static void compile_files(b_vm *vm, char *path, int jobs) {
+  if (jobs <= 0) {
+#if defined(HAVE_SYSCONF) && defined(_SC_NPROCESSORS_ONLN)
+    jobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#elif defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    jobs = (int) info.dwNumberOfProcessors;
+#endif
+    if (jobs <= 0) {
+      jobs = 1;
+    }
+  }
+
+  // modules are linked to the modules they import through the cache.
+  vm->use_bytecode_cache = true;
+
+  if (compile_bytecode(vm, path, jobs) > 0)
+    exit(EXIT_COMPILE);
+}
+
+static void run_snapshot(b_vm *vm, char *file) {
+  char error[256];
+  if (!load_snapshot(vm, file, error, sizeof(error))) {
+    fprintf(stderr, "(Blade):\n  Launch aborted for %s\n  Reason: %s\n", file, error);
+    exit(EXIT_FAILURE);
+  }
+
+  b_ptr_result result = run(vm, 0);
+  fflush(stdout);
+
+  if (result == PTR_RUNTIME_ERR)
+    exit(EXIT_RUNTIME);
+}
+
 void show_usage(char *argv[], bool fail) {
   FILE *out = fail ? stderr : stdout;
-  fprintf(out, "Usage: %s [-[h | c | d | e | v | g | w]] [filename]\n", argv[0]);
+  fprintf(out, "Usage: %s [-[h | c | d | e | v | g | w | n | r | j]] [filename]\n", argv[0]);
   fprintf(out, "   -h       Show this help message.\n");
   fprintf(out, "   -v       Show version string.\n");
   fprintf(out, "   -b arg   Buffer terminal outputs with the given size.\n");
@@ -247,6 +283,10 @@ void show_usage(char *argv[], bool fail) {
                "            can start. [Default = %d (%s)]\n", DEFAULT_GC_START / 1024, format_size(DEFAULT_GC_START));
   fprintf(out, "   -c arg   Runs the given code.\n");
   fprintf(out, "   -w       Show runtime warnings.\n");
+  fprintf(out, "   -n       Do not use or update the bytecode cache of imported modules.\n");
+  fprintf(out, "   -r       Resumes the program saved in the snapshot given as filename.\n");
+  fprintf(out, "   -j arg   Compiles filename (a file or directory) and its imports into the\n"
+               "            bytecode cache on arg threads and exits. [0 = one per core]\n");
   exit(fail ? EXIT_FAILURE : EXIT_SUCCESS);
 }
 
@@ -256,15 +296,18 @@ int main(int argc, char *argv[]) {
   bool should_print_bytecode = false;
   long stdout_buffer_size = 0L;
   bool should_exit_after_bytecode = false;
+  bool use_bytecode_cache = true;
+  bool resume_snapshot = false;
+  int compile_jobs = -1;
   char *source = NULL;
   int next_gc_start = DEFAULT_GC_START;
 
   if (argc > 1) {
     int opt;
 #ifdef __linux__
-    while ((opt = getopt(argc, argv, "+hdeb:s:vg:wc:")) != -1) {
+    while ((opt = getopt(argc, argv, "+hdeb:s:vg:wc:nrj:")) != -1) {
 #else
-    while ((opt = getopt(argc, argv, "hdeb:s:vg:wc:")) != -1) {
+    while ((opt = getopt(argc, argv, "hdeb:s:vg:wc:nrj:")) != -1) {
 #endif
       switch (opt) {
         case 'h': {
@@ -303,6 +346,21 @@ int main(int argc, char *argv[]) {
           show_warnings = true;
           break;
         }
+        case 'n': {
+          use_bytecode_cache = false;
+          break;
+        }
+        case 'r': {
+          resume_snapshot = true;
+          break;
+        }
+        case 'j': {
+          compile_jobs = (int) strtol(optarg, NULL, 10);
+          if (compile_jobs < 0) {
+            compile_jobs = 0;
+          }
+          break;
+        }
         default: {
           show_usage(argv, true); // exits
           break;
@@ -320,6 +378,8 @@ int main(int argc, char *argv[]) {
     vm->show_warnings = show_warnings;
     vm->should_print_bytecode = should_print_bytecode;
     vm->should_exit_after_bytecode = should_exit_after_bytecode;
+    // cached modules skip the compiler so they have no bytecode to print.
+    vm->use_bytecode_cache = use_bytecode_cache && !should_print_bytecode;
     vm->next_gc = next_gc_start;
 
     if (stdout_buffer_size) {
@@ -352,6 +412,29 @@ int main(int argc, char *argv[]) {
     // always do this last so that we can have access to everything else
     bind_native_modules(vm);
 
+    if (resume_snapshot) {
+      if (argc <= optind) {
+        show_usage(argv, true); // exits
+      }
+
+      // the snapshot already holds the core library.
+      run_snapshot(vm, argv[optind]);
+      free_vm(vm);
+      free(std_args);
+      return EXIT_SUCCESS;
+    }
+
+    if (compile_jobs >= 0) {
+      if (argc <= optind) {
+        show_usage(argv, true); // exits
+      }
+
+      compile_files(vm, argv[optind], compile_jobs);
+      free_vm(vm);
+      free(std_args);
+      return EXIT_SUCCESS;
+    }
+
     // Initialize core...
     char *core_module = get_core_library_file_path("_core");
     run_file(vm, core_module);
@@ -9,20 +9,92 @@ void init_blob(b_blob *blob) {
   blob->capacity = 0;
   blob->code = NULL;
   blob->lines = NULL;
+  blob->lines_length = 0;
+  blob->lines_capacity = 0;
+  blob->last_line = 0;
+  blob->last_run = -1;
   init_value_arr(&blob->constants);
 }
 
+/**
+ * the line table holds a run for every stretch of code compiled from the
+ * same line. a run is the number of bytes it covers (1 - 255) followed by
+ * the difference between its line and the line of the run before it as a
+ * zigzag encoded variable length integer.
+ *
+ * most runs take two bytes where a line for every byte of code took four
+ * bytes per byte. lines are only needed for stack traces and disassembly so
+ * the table is decoded then.
+ */
+static void write_line_byte(b_vm *vm, b_blob *blob, uint8_t byte) {
+  if (blob->lines_capacity < blob->lines_length + 1) {
+    int old_capacity = blob->lines_capacity;
+    blob->lines_capacity = GROW_CAPACITY(old_capacity);
+    blob->lines = GROW_ARRAY(uint8_t, blob->lines, old_capacity, blob->lines_capacity);
+  }
+
+  blob->lines[blob->lines_length++] = byte;
+}
+
 void write_blob(b_vm *vm, b_blob *blob, uint8_t byte, int line) {
   if (blob->capacity < blob->count + 1) {
     int old_capacity = blob->capacity;
     blob->capacity = GROW_CAPACITY(old_capacity);
     blob->code = GROW_ARRAY(uint8_t, blob->code, old_capacity, blob->capacity);
-    blob->lines = GROW_ARRAY(int, blob->lines, old_capacity, blob->capacity);
   }
 
   blob->code[blob->count] = byte;
-  blob->lines[blob->count] = line;
   blob->count++;
+
+  if (blob->last_run >= 0 && line == blob->last_line && blob->lines[blob->last_run] < UINT8_MAX) {
+    blob->lines[blob->last_run]++;
+    return;
+  }
+
+  blob->last_run = blob->lines_length;
+  write_line_byte(vm, blob, 1);
+
+  int delta = line - blob->last_line;
+  uint32_t value = ((uint32_t) delta << 1) ^ (uint32_t) (delta >> 31);
+  do {
+    uint8_t part = value & 0x7F;
+    value >>= 7;
+    write_line_byte(vm, blob, value != 0 ? part | 0x80 : part);
+  } while (value != 0);
+
+  blob->last_line = line;
+}
+
+void init_blob_lines(b_blob_lines *lines) {
+  lines->index = 0;
+  lines->end = 0;
+  lines->line = 0;
+}
+
+int next_blob_line(b_blob *blob, b_blob_lines *lines, int offset) {
+  int i = lines->index;
+
+  while (offset >= lines->end && i < blob->lines_length) {
+    lines->end += blob->lines[i++];
+
+    uint32_t value = 0;
+    for (int shift = 0; i < blob->lines_length && shift < 32; shift += 7) {
+      uint8_t part = blob->lines[i++];
+      value |= (uint32_t) (part & 0x7F) << shift;
+      if ((part & 0x80) == 0) break;
+    }
+
+    lines->line += (int) (value >> 1) ^ -(int) (value & 1);
+  }
+
+  lines->index = i;
+  return lines->line;
+}
+
+int get_blob_line(b_blob *blob, int offset) {
+  b_blob_lines lines;
+  init_blob_lines(&lines);
+  return next_blob_line(blob, &lines, offset);
 }
 
 void free_blob(b_vm *vm, b_blob *blob) {
@@ -30,7 +102,7 @@ void free_blob(b_vm *vm, b_blob *blob) {
     FREE_ARRAY(uint8_t, blob->code, blob->capacity);
   }
   if (blob->lines != NULL) {
-    FREE_ARRAY(int, blob->lines, blob->capacity);
+    FREE_ARRAY(uint8_t, blob->lines, blob->lines_capacity);
   }
   free_value_arr(vm, &blob->constants);
   init_blob(blob);
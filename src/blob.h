@@ -79,6 +79,7 @@ typedef enum {
   OP_SET_INDEX,
 
   OP_CALL_IMPORT,
+  OP_LAZY_IMPORT,
   OP_NATIVE_MODULE,
   OP_SELECT_IMPORT,
   OP_SELECT_NATIVE_IMPORT,
@@ -91,6 +92,7 @@ typedef enum {
   OP_END_CATCH,
 
   OP_STRINGIFY,
+  OP_CONCAT,
   OP_SWITCH,
   OP_CHOICE,
 
@@ -103,7 +105,11 @@ typedef struct {
   int count;
   int capacity;
   uint8_t *code;
-  int *lines;
+  uint8_t *lines; // run-length encoded, see get_blob_line().
+  int lines_length;
+  int lines_capacity;
+  int last_line;
+  int last_run; // offset of the run the next byte may join or -1.
   b_value_arr constants;
 } b_blob;
 
@@ -113,6 +119,22 @@ void free_blob(b_vm *vm, b_blob *blob);
 
 void write_blob(b_vm *vm, b_blob *blob, uint8_t byte, int line);
 
+// reads the line table in step with code walked from the start of a blob.
+typedef struct {
+  int index; // of the next run in the line table.
+  int end; // offset of the code after the current run.
+  int line;
+} b_blob_lines;
+
+void init_blob_lines(b_blob_lines *lines);
+
+// returns the source line of the byte of code at offset. offsets must not
+// be smaller than the one before.
+int next_blob_line(b_blob *blob, b_blob_lines *lines, int offset);
+
+// returns the source line of the byte of code at offset.
+int get_blob_line(b_blob *blob, int offset);
+
 int add_constant(b_vm *vm, b_blob *blob, b_value value);
 
 #endif
\ No newline at end of file
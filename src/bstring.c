@@ -12,6 +12,198 @@
 #include <strsep.h>
 #endif /* ifndef HAVE_STRSEP */
 
+#if defined(__GNUC__) || defined(__clang__)
+#  if defined(__AVX2__)
+#    include <immintrin.h>
+#    define STRING_SEARCH_AVX2 1
+#  elif defined(__SSE2__)
+#    include <emmintrin.h>
+#    define STRING_SEARCH_SSE2 1
+#  endif
+#endif
+
+// needles at least this long are searched with the two-way algorithm.
+#define TWO_WAY_MIN_NEEDLE 32
+
+/**
+ * Crochemore-Perrin two-way search with a last byte shift table. it runs in
+ * linear time regardless of the haystack and needle content.
+ */
+static const char *two_way_search(const unsigned char *haystack, const unsigned char *end,
+                                  const unsigned char *needle, size_t length) {
+#define BYTE_BIT(set, b, op) ((set)[(size_t)(b) / (8 * sizeof *(set))] op (size_t)1 << ((size_t)(b) % (8 * sizeof *(set))))
+  size_t byteset[32 / sizeof(size_t)] = {0};
+  size_t shift[256];
+  size_t i, ip, jp, k, p, ms, p0, mem, mem0;
+
+  for (i = 0; i < length; i++) {
+    BYTE_BIT(byteset, needle[i], |=);
+    shift[needle[i]] = i + 1;
+  }
+
+  // maximal suffix of the needle
+  ip = -1; jp = 0; k = p = 1;
+  while (jp + k < length) {
+    if (needle[ip + k] == needle[jp + k]) {
+      if (k == p) {
+        jp += p;
+        k = 1;
+      } else k++;
+    } else if (needle[ip + k] > needle[jp + k]) {
+      jp += k;
+      k = 1;
+      p = jp - ip;
+    } else {
+      ip = jp++;
+      k = p = 1;
+    }
+  }
+  ms = ip;
+  p0 = p;
+
+  // and with the opposite comparison
+  ip = -1; jp = 0; k = p = 1;
+  while (jp + k < length) {
+    if (needle[ip + k] == needle[jp + k]) {
+      if (k == p) {
+        jp += p;
+        k = 1;
+      } else k++;
+    } else if (needle[ip + k] < needle[jp + k]) {
+      jp += k;
+      k = 1;
+      p = jp - ip;
+    } else {
+      ip = jp++;
+      k = p = 1;
+    }
+  }
+  if (ip + 1 > ms + 1) ms = ip;
+  else p = p0;
+
+  // periodic needle?
+  if (memcmp(needle, needle + p, ms + 1)) {
+    mem0 = 0;
+    p = (ms > length - ms - 1 ? ms : length - ms - 1) + 1;
+  } else {
+    mem0 = length - p;
+  }
+  mem = 0;
+
+  while ((size_t) (end - haystack) >= length) {
+    // check the last byte first and skip ahead on a mismatch
+    if (BYTE_BIT(byteset, haystack[length - 1], &)) {
+      k = length - shift[haystack[length - 1]];
+      if (k) {
+        if (k < mem) k = mem;
+        haystack += k;
+        mem = 0;
+        continue;
+      }
+    } else {
+      haystack += length;
+      mem = 0;
+      continue;
+    }
+
+    // compare the right half
+    for (k = ms + 1 > mem ? ms + 1 : mem; k < length && needle[k] == haystack[k]; k++);
+    if (k < length) {
+      haystack += k - ms;
+      mem = 0;
+      continue;
+    }
+
+    // compare the left half
+    for (k = ms + 1; k > mem && needle[k - 1] == haystack[k - 1]; k--);
+    if (k <= mem) {
+      return (const char *) haystack;
+    }
+    haystack += p;
+    mem = mem0;
+  }
+
+  return NULL;
+#undef BYTE_BIT
+}
+
+/**
+ * returns a pointer to the first occurrence of needle in haystack or NULL.
+ *
+ * unlike strstr(), both strings are length bounded so embedded NULs are
+ * searched like any other byte. candidates are found by comparing the first
+ * and last byte of the needle against a whole vector of positions at once
+ * where SSE2 or AVX2 is available, with memchr() used otherwise.
+ */
+const char *find_substring(const char *haystack, size_t haystack_length,
+                           const char *needle, size_t needle_length) {
+  if (needle_length == 0) {
+    return haystack;
+  } else if (needle_length > haystack_length) {
+    return NULL;
+  } else if (needle_length == 1) {
+    return memchr(haystack, needle[0], haystack_length);
+  } else if (needle_length >= TWO_WAY_MIN_NEEDLE) {
+    return two_way_search((const unsigned char *) haystack, (const unsigned char *) haystack + haystack_length,
+                          (const unsigned char *) needle, needle_length);
+  }
+
+  size_t i = 0, last = haystack_length - needle_length;
+
+#if defined(STRING_SEARCH_AVX2)
+  const __m256i first_byte = _mm256_set1_epi8(needle[0]);
+  const __m256i last_byte = _mm256_set1_epi8(needle[needle_length - 1]);
+
+  for (; i + 32 <= last + 1; i += 32) {
+    __m256i block_first = _mm256_loadu_si256((const __m256i *) (haystack + i));
+    __m256i block_last = _mm256_loadu_si256((const __m256i *) (haystack + i + needle_length - 1));
+    uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_and_si256(
+        _mm256_cmpeq_epi8(first_byte, block_first), _mm256_cmpeq_epi8(last_byte, block_last)));
+
+    while (mask != 0) {
+      size_t offset = i + __builtin_ctz(mask);
+      if (memcmp(haystack + offset + 1, needle + 1, needle_length - 2) == 0) {
+        return haystack + offset;
+      }
+      mask &= mask - 1;
+    }
+  }
+#elif defined(STRING_SEARCH_SSE2)
+  const __m128i first_byte = _mm_set1_epi8(needle[0]);
+  const __m128i last_byte = _mm_set1_epi8(needle[needle_length - 1]);
+
+  for (; i + 16 <= last + 1; i += 16) {
+    __m128i block_first = _mm_loadu_si128((const __m128i *) (haystack + i));
+    __m128i block_last = _mm_loadu_si128((const __m128i *) (haystack + i + needle_length - 1));
+    uint32_t mask = (uint32_t) _mm_movemask_epi8(_mm_and_si128(
+        _mm_cmpeq_epi8(first_byte, block_first), _mm_cmpeq_epi8(last_byte, block_last)));
+
+    while (mask != 0) {
+      size_t offset = i + __builtin_ctz(mask);
+      if (memcmp(haystack + offset + 1, needle + 1, needle_length - 2) == 0) {
+        return haystack + offset;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+
+  while (i <= last) {
+    const char *candidate = memchr(haystack + i, needle[0], last - i + 1);
+    if (candidate == NULL) {
+      return NULL;
+    }
+
+    i = candidate - haystack;
+    if (memcmp(candidate + 1, needle + 1, needle_length - 1) == 0) {
+      return candidate;
+    }
+    i++;
+  }
+
+  return NULL;
+}
+
 /**
  * a Blade regex must always start and end with the same delimiter e.g. /
  *
@@ -123,15 +315,128 @@ char *remove_regex_delimiter(b_vm *vm, b_obj_string *string) {
   return str;
 }
 
+/**
+ * compiled regular expressions are cached per vm so that patterns used over
+ * and over are only compiled (and jit compiled) once. entries are keyed by
+ * the delimited regex string and its compile options and the least recently
+ * used entry is evicted when the cache is full.
+ *
+ * a cached regex also owns a match data that callers may reuse as long as
+ * they do not call back into Blade code while using it. callers that do must
+ * retain the regex and create their own match data.
+ */
+struct s_regex {
+  char *source;
+  int length;
+  uint32_t hash;
+  uint32_t options;
+  pcre2_code *code;
+  pcre2_match_data *match_data;
+  uint64_t last_used;
+  int ref_count;
+};
+
+static void release_regex(b_regex *regex) {
+  if (--regex->ref_count > 0) {
+    return;
+  }
+
+  pcre2_match_data_free(regex->match_data);
+  pcre2_code_free(regex->code);
+  free(regex->source);
+  free(regex);
+}
+
+void free_regex_cache(b_vm *vm) {
+  for (int i = 0; i < REGEX_CACHE_SIZE; i++) {
+    if (vm->regexes[i] != NULL) {
+      release_regex(vm->regexes[i]);
+      vm->regexes[i] = NULL;
+    }
+  }
+}
+
+/**
+ * returns the compiled regex for string or NULL if it fails to compile.
+ */
+static b_regex *get_regex(b_vm *vm, b_obj_string *string, uint32_t options,
+                          int *error_number, PCRE2_SIZE *error_offset) {
+  int slot = 0;
+
+  for (int i = 0; i < REGEX_CACHE_SIZE; i++) {
+    b_regex *regex = vm->regexes[i];
+    if (regex == NULL) {
+      slot = i;
+      break;
+    }
+
+    if (regex->hash == string->hash && regex->length == string->length &&
+        regex->options == options && memcmp(regex->source, string->chars, string->length) == 0) {
+      regex->last_used = ++vm->regex_clock;
+      return regex;
+    }
+
+    if (regex->last_used < vm->regexes[slot]->last_used) {
+      slot = i;
+    }
+  }
+
+  char *real_regex = remove_regex_delimiter(vm, string);
+  pcre2_code *code = pcre2_compile((PCRE2_SPTR) real_regex, PCRE2_ZERO_TERMINATED, options,
+                                   error_number, error_offset, NULL);
+  free(real_regex);
+
+  if (code == NULL) {
+    return NULL;
+  }
+
+  // not every platform supports the jit, the interpreter is used when it fails.
+  (void) pcre2_jit_compile(code, PCRE2_JIT_COMPLETE);
+
+  b_regex *regex = malloc(sizeof(b_regex));
+  regex->source = malloc(string->length + 1);
+  memcpy(regex->source, string->chars, string->length + 1);
+  regex->length = string->length;
+  regex->hash = string->hash;
+  regex->options = options;
+  regex->code = code;
+  regex->match_data = pcre2_match_data_create_from_pattern(code, NULL);
+  regex->last_used = ++vm->regex_clock;
+  regex->ref_count = 1;
+
+  if (vm->regexes[slot] != NULL) {
+    release_regex(vm->regexes[slot]);
+  }
+  vm->regexes[slot] = regex;
+
+  return regex;
+}
+
 DECLARE_STRING_METHOD(length) {
   ENFORCE_ARG_COUNT(length, 0);
   b_obj_string* string = AS_STRING(METHOD_OBJECT);
   RETURN_NUMBER(string->is_ascii ? string->length : string->utf8_length);
 }
 
+/**
+ * maps every byte of an ASCII string with the given ctype function.
+ */
+static b_obj_string *ascii_case_map(b_vm *vm, b_obj_string *string, int (*map)(int)) {
+  STRING_BUFFER(chars, string->length);
+  for (int i = 0; i < string->length; i++) {
+    chars[i] = (char) map((unsigned char) string->chars[i]);
+  }
+  chars[string->length] = '\0';
+  return TAKE_STRING_BUFFER(chars, string->length);
+}
+
 DECLARE_STRING_METHOD(upper) {
   ENFORCE_ARG_COUNT(upper, 0);
   b_obj_string *str = AS_STRING(METHOD_OBJECT);
+  if (str->is_ascii) {
+    RETURN_OBJ(ascii_case_map(vm, str, toupper));
+  }
+
   char *string = utf8_toupper(str->chars, str->utf8_length);
   RETURN_TT_STRING(string);
 }
@@ -139,6 +444,10 @@ DECLARE_STRING_METHOD(upper) {
 DECLARE_STRING_METHOD(lower) {
   ENFORCE_ARG_COUNT(lower, 0);
   b_obj_string *str = AS_STRING(METHOD_OBJECT);
+  if (str->is_ascii) {
+    RETURN_OBJ(ascii_case_map(vm, str, tolower));
+  }
+
   char *string = utf8_tolower(str->chars, str->utf8_length);
   RETURN_TT_STRING(string);
 }
@@ -153,6 +462,12 @@ DECLARE_STRING_METHOD(case_fold) {
   }
 
   b_obj_string *str = AS_STRING(METHOD_OBJECT);
+
+  // both foldings of an ASCII letter are its lowercase form.
+  if (str->is_ascii) {
+    RETURN_OBJ(ascii_case_map(vm, str, tolower));
+  }
+
   size_t out_length;
   char *string = utf8_case_fold(str->chars, str->utf8_length, !is_full, &out_length);
   RETURN_T_STRING(string, out_length);
@@ -199,7 +514,7 @@ DECLARE_STRING_METHOD(is_lower) {
   if(!string->is_ascii) {
     for (int i = 0; i < string->utf8_length; i++) {
       int start = i, end = i + 1;
-      utf8slice(string->chars, &start, &end);
+      string_utf8_slice(vm, string, &start, &end);
       int as_num = utf8_decode((uint8_t *)(string->chars + start), end - start);
       if(!alpha_found && !isdigit(as_num)) alpha_found = true;
 
@@ -209,8 +524,8 @@ DECLARE_STRING_METHOD(is_lower) {
     }
   } else {
     for (int i = 0; i < string->length; i++) {
-      if(!alpha_found && !isdigit(string->chars[0])) alpha_found = true;
-      if(isupper(string->chars[0])) {
+      if(!alpha_found && !isdigit(string->chars[i])) alpha_found = true;
+      if(isupper(string->chars[i])) {
         RETURN_FALSE;
       }
     }
@@ -227,7 +542,7 @@ DECLARE_STRING_METHOD(is_upper) {
   if(!string->is_ascii) {
     for (int i = 0; i < string->utf8_length; i++) {
       int start = i, end = i + 1;
-      utf8slice(string->chars, &start, &end);
+      string_utf8_slice(vm, string, &start, &end);
       int as_num = utf8_decode((uint8_t *)(string->chars + start), end - start);
       if(!alpha_found && !isdigit(as_num)) alpha_found = true;
 
@@ -237,8 +552,8 @@ DECLARE_STRING_METHOD(is_upper) {
     }
   } else {
     for (int i = 0; i < string->length; i++) {
-      if(!alpha_found && !isdigit(string->chars[0])) alpha_found = true;
-      if(islower(string->chars[0])) {
+      if(!alpha_found && !isdigit(string->chars[i])) alpha_found = true;
+      if(islower(string->chars[i])) {
         RETURN_FALSE;
       }
     }
@@ -295,6 +610,11 @@ DECLARE_STRING_METHOD(trim) {
       end--;
   }
 
+  // strings are immutable so an untrimmed string can be returned as is.
+  if (string == AS_C_STRING(METHOD_OBJECT) && end - string + 1 == AS_STRING(METHOD_OBJECT)->length) {
+    RETURN_VALUE(METHOD_OBJECT);
+  }
+
   RETURN_L_STRING(string, end - string + 1);
 }
 
@@ -325,6 +645,10 @@ DECLARE_STRING_METHOD(ltrim) {
     RETURN_OBJ(copy_string(vm, "", 0));
   }
 
+  if (string == AS_C_STRING(METHOD_OBJECT) && (int) strlen(string) == AS_STRING(METHOD_OBJECT)->length) {
+    RETURN_VALUE(METHOD_OBJECT);
+  }
+
   RETURN_STRING(string);
 }
 
@@ -355,6 +679,10 @@ DECLARE_STRING_METHOD(rtrim) {
       end--;
   }
 
+  if (end - string + 1 == AS_STRING(METHOD_OBJECT)->length) {
+    RETURN_VALUE(METHOD_OBJECT);
+  }
+
   RETURN_L_STRING(string, end - string + 1);
 }
 
@@ -437,18 +765,36 @@ DECLARE_STRING_METHOD(index_of) {
 
   if(string->length > 0 && needle->length > 0) {
     char *haystack = string->chars;
-    if(!string->is_ascii && string->length != string->utf8_length) {
-      for (int i = start_index; i < string->utf8_length; i++) {
-        int start = i, end = i + 1;
-        utf8slice(haystack, &start, &end);
+    bool is_utf8 = !string->is_ascii && string->length != string->utf8_length;
+    if (start_index < 0) start_index = 0;
 
-        if (memcmp(haystack + start, needle->chars, needle->length) == 0) {
-          RETURN_NUMBER(i);
-        }
+    int start = start_index, end = start_index + 1;
+    if(is_utf8) {
+      string_utf8_slice(vm, string, &start, &end);
+    }
+
+    if (start < 0 || start >= string->length) {
+      RETURN_NUMBER(-1);
+    }
+
+    const char *result = find_substring(haystack + start, string->length - start, needle->chars, needle->length);
+
+    // only matches that start on a character boundary count.
+    while (is_utf8 && result != NULL && (*result & 0xC0) == 0x80) {
+      result++;
+      result = find_substring(result, string->length - (result - haystack), needle->chars, needle->length);
+    }
+
+    if (result != NULL) {
+      if (!is_utf8) {
+        RETURN_NUMBER((int) (result - haystack));
       }
-    } else {
-      char *result = strstr(haystack + start_index, needle->chars);
-      if (result != NULL) RETURN_NUMBER((int) (result - haystack));
+
+      int index = start_index;
+      for (const char *p = haystack + start; p < result; p++) {
+        if ((*p & 0xC0) != 0x80) index++;
+      }
+      RETURN_NUMBER(index);
     }
   }
 
@@ -493,8 +839,9 @@ DECLARE_STRING_METHOD(count) {
   if (substr->length == 0 || string->length == 0) RETURN_NUMBER(0);
 
   int count = 0;
+  const char *end = string->chars + string->length;
   const char *tmp = string->chars;
-  while ((tmp = utf8_strstr(tmp, substr->chars))) {
+  while ((tmp = find_substring(tmp, end - tmp, substr->chars, substr->length)) != NULL) {
     count++;
     tmp++;
   }
@@ -504,7 +851,8 @@ DECLARE_STRING_METHOD(count) {
 
 DECLARE_STRING_METHOD(to_number) {
   ENFORCE_ARG_COUNT(to_number, 0);
-  RETURN_NUMBER(strtod(AS_C_STRING(METHOD_OBJECT), NULL));
+  b_obj_string *string = AS_STRING(METHOD_OBJECT);
+  RETURN_NUMBER(parse_number(string->chars, string->length));
 }
 
 DECLARE_STRING_METHOD(ascii) {
@@ -530,7 +878,7 @@ DECLARE_STRING_METHOD(to_list) {
     for (int i = 0; i < length; i++) {
       int start = i, end = i + 1;
       if(!string->is_ascii) {
-        utf8slice(string->chars, &start, &end);
+        string_utf8_slice(vm, string, &start, &end);
       }
       write_list(vm, list, STRING_L_VAL(string->chars + start, (int) (end - start)));
     }
@@ -637,29 +985,21 @@ DECLARE_STRING_METHOD(match) {
     RETURN_BOOL(strstr(string->chars, substr->chars) - string->chars > -1);
   }
 
-  char *real_regex = remove_regex_delimiter(vm, substr);
-
   int error_number;
   PCRE2_SIZE error_offset;
 
-  PCRE2_SPTR pattern = (PCRE2_SPTR) real_regex;
   PCRE2_SPTR subject = (PCRE2_SPTR) string->chars;
   PCRE2_SIZE subject_length = (PCRE2_SIZE) string->length;
 
-  pcre2_code *re =
-      pcre2_compile(pattern, PCRE2_ZERO_TERMINATED, compile_options,
-                    &error_number, &error_offset, NULL);
-  free(real_regex);
-
-  REGEX_COMPILATION_ERROR(re, error_number, error_offset);
+  b_regex *regex = get_regex(vm, substr, compile_options, &error_number, &error_offset);
+  REGEX_COMPILATION_ERROR(regex, error_number, error_offset);
 
-  pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, NULL);
+  pcre2_code *re = regex->code;
+  pcre2_match_data *match_data = regex->match_data;
 
   int rc = pcre2_match(re, subject, subject_length, start_offset, 0, match_data, NULL);
 
   if (rc < 0) {
-    pcre2_match_data_free(match_data);
-    pcre2_code_free(re);
     if (rc == PCRE2_ERROR_NOMATCH) {
       RETURN_FALSE;
     } else {
@@ -704,9 +1044,6 @@ DECLARE_STRING_METHOD(match) {
     }
   }
 
-  pcre2_match_data_free(match_data);
-  pcre2_code_free(re);
-
   RETURN_OBJ(result);
 }
 
@@ -734,8 +1071,6 @@ DECLARE_STRING_METHOD(matches) {
     }
   }
 
-  char *real_regex = remove_regex_delimiter(vm, substr);
-
   int error_number;
   PCRE2_SIZE error_offset;
   uint32_t option_bits;
@@ -744,22 +1079,18 @@ DECLARE_STRING_METHOD(matches) {
   uint32_t name_entry_size;
   PCRE2_SPTR name_table;
 
-  PCRE2_SPTR pattern = (PCRE2_SPTR) real_regex;
   PCRE2_SPTR subject = (PCRE2_SPTR) string->chars;
   PCRE2_SIZE subject_length = (PCRE2_SIZE) string->length;
 
-  pcre2_code *re = pcre2_compile(pattern, PCRE2_ZERO_TERMINATED, compile_options, &error_number, &error_offset, NULL);
-  free(real_regex);
+  b_regex *regex = get_regex(vm, substr, compile_options, &error_number, &error_offset);
+  REGEX_COMPILATION_ERROR(regex, error_number, error_offset);
 
-  REGEX_COMPILATION_ERROR(re, error_number, error_offset);
-
-  pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, NULL);
+  pcre2_code *re = regex->code;
+  pcre2_match_data *match_data = regex->match_data;
 
   int rc = pcre2_match(re, subject, subject_length, start_offset, 0, match_data, NULL);
 
   if (rc < 0) {
-    pcre2_match_data_free(match_data);
-    pcre2_code_free(re);
     if (rc == PCRE2_ERROR_NOMATCH) {
       RETURN_FALSE;
     } else {
@@ -874,8 +1205,6 @@ DECLARE_STRING_METHOD(matches) {
     }
 
     if (rc < 0 && rc != PCRE2_ERROR_PARTIAL) {
-      pcre2_match_data_free(match_data);
-      pcre2_code_free(re);
       REGEX_ERR("regular expression error %d", rc);
     }
 
@@ -933,9 +1262,6 @@ DECLARE_STRING_METHOD(matches) {
     }
   }
 
-  pcre2_match_data_free(match_data);
-  pcre2_code_free(re);
-
   RETURN_OBJ(result);
 }
 
@@ -962,64 +1288,45 @@ DECLARE_STRING_METHOD(split) {
   if ((int)compile_options == -1) {
     // not a regex, do a regular split
     if (delimeter->length > 0) {
-      char* start = string->chars;
-      char* end = strstr(start, delimeter->chars);
-
-      while (end != NULL) {
-        int len = end - start;
-        char *res = malloc((len + 1) * sizeof(char));
-        memcpy(res, start, len);
-        res[len] = '\0';
+      const char *start = string->chars, *end = string->chars + string->length;
+      const char *found;
 
-        write_list(vm, list, GC_T_STRING(res, len));
-
-        start = end + strlen(delimeter->chars);
-        end = strstr(start, delimeter->chars);
+      // the list is protected, so pieces are copied straight into it.
+      while ((found = find_substring(start, end - start, delimeter->chars, delimeter->length)) != NULL) {
+        write_list(vm, list, STRING_L_VAL(start, (int) (found - start)));
+        start = found + delimeter->length;
       }
 
       // Last substring
-      int len = strlen(start);
-      if(len > -1) {
-        char *res = malloc((len + 1) * sizeof(char));
-        memcpy(res, start, len);
-        res[len] = '\0';
-        
-        write_list(vm, list, GC_T_STRING(res, len));
-      }
+      write_list(vm, list, STRING_L_VAL(start, (int) (end - start)));
     } else {
       int length = string->is_ascii ? string->length : string->utf8_length;
       for (int i = 0; i < length; i++) {
 
         int start = i, end = i + 1;
         if(!string->is_ascii) {
-          utf8slice(string->chars, &start, &end);
+          string_utf8_slice(vm, string, &start, &end);
         }
 
         write_list(vm, list, STRING_L_VAL(string->chars + start, (int) (end - start)));
       }
     }
   } else {
-    char *real_regex = remove_regex_delimiter(vm, delimeter);
-
     int error_number;
     PCRE2_SIZE error_offset;
 
-    PCRE2_SPTR pattern = (PCRE2_SPTR) real_regex;
     PCRE2_SPTR subject = (PCRE2_SPTR) string->chars;
     PCRE2_SIZE subject_length = (PCRE2_SIZE) string->length;
 
-    pcre2_code *re = pcre2_compile(pattern, PCRE2_ZERO_TERMINATED, compile_options, &error_number, &error_offset, NULL);
-    free(real_regex);
-
-    REGEX_COMPILATION_ERROR(re, error_number, error_offset);
+    b_regex *regex = get_regex(vm, delimeter, compile_options, &error_number, &error_offset);
+    REGEX_COMPILATION_ERROR(regex, error_number, error_offset);
 
-    pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, NULL);
+    pcre2_code *re = regex->code;
+    pcre2_match_data *match_data = regex->match_data;
 
     int rc = pcre2_match(re, subject, subject_length, 0, 0, match_data, NULL);
 
     if (rc < 0) {
-      pcre2_match_data_free(match_data);
-      pcre2_code_free(re);
       if (rc == PCRE2_ERROR_NOMATCH) {
         write_list(vm, list, STRING_L_VAL(string->chars, string->length));
         RETURN_OBJ(list);
@@ -1061,8 +1368,6 @@ DECLARE_STRING_METHOD(split) {
       }
 
       if (rc < 0 && rc != PCRE2_ERROR_PARTIAL) {
-        pcre2_match_data_free(match_data);
-        pcre2_code_free(re);
         REGEX_ERR("regular expression error %d", rc);
       }
 
@@ -1097,9 +1402,6 @@ DECLARE_STRING_METHOD(split) {
     if(total_length > 0) {
       write_list(vm, list, STRING_L_VAL((char *) subject, total_length));
     }
-
-    pcre2_match_data_free(match_data);
-    pcre2_code_free(re);
   }
 
   RETURN_OBJ(list);
@@ -1127,53 +1429,54 @@ DECLARE_STRING_METHOD(replace) {
   int32_t compile_options = use_regex ? is_regex(substr) : -1;
   if (compile_options == -1) {
     // not a regex, do a regular replace
-    char *result = strdup("");
+    const char *end = string->chars + string->length;
+    const char *found;
 
-    int total_length = 0;
-    for(int i = 0; i < string->length; i++) {
-      if(memcmp(string->chars + i, substr->chars, substr->length) == 0) {
-        if(substr->length > 0) {
-          result = append_strings_n(result, rep_substr->chars, rep_substr->length);
-        }
-        i += substr->length - 1;
-        total_length += rep_substr->length;
-      } else {
-        result = append_strings_n(result, &string->chars[i], 1);
-        total_length++;
-      }
+    int count = 0;
+    for (const char *p = string->chars; (found = find_substring(p, end - p, substr->chars, substr->length)) != NULL;
+         p = found + substr->length) {
+      count++;
     }
+
+    if (count == 0) {
+      RETURN_VALUE(METHOD_OBJECT);
+    }
+
+    int total_length = string->length + count * (rep_substr->length - substr->length);
+    char *result = ALLOCATE(char, (size_t) total_length + 1);
+    char *out = result;
+    const char *p = string->chars;
+
+    for (; (found = find_substring(p, end - p, substr->chars, substr->length)) != NULL; p = found + substr->length) {
+      memcpy(out, p, found - p);
+      out += found - p;
+      memcpy(out, rep_substr->chars, rep_substr->length);
+      out += rep_substr->length;
+    }
+    memcpy(out, p, end - p);
     result[total_length] = 0;
 
     RETURN_T_STRING(result, total_length);
   }
 
-  char *real_regex = remove_regex_delimiter(vm, substr);
-
   PCRE2_SPTR input = (PCRE2_SPTR) string->chars;
-  PCRE2_SPTR pattern = (PCRE2_SPTR) real_regex;
   PCRE2_SPTR replacement = (PCRE2_SPTR) rep_substr->chars;
 
   int result, error_number;
   PCRE2_SIZE error_offset;
 
-  pcre2_code *re = pcre2_compile(pattern, PCRE2_ZERO_TERMINATED,
-                                 compile_options | PCRE2_MULTILINE,
-                                 &error_number, &error_offset, 0);
-  free(real_regex);
+  b_regex *regex = get_regex(vm, substr, compile_options | PCRE2_MULTILINE, &error_number, &error_offset);
+  REGEX_COMPILATION_ERROR(regex, error_number, error_offset);
 
-  REGEX_COMPILATION_ERROR(re, error_number, error_offset);
-
-  pcre2_match_context *match_context = pcre2_match_context_create(0);
+  pcre2_code *re = regex->code;
 
   PCRE2_SIZE output_length = 0;
   result = pcre2_substitute(
       re, input, PCRE2_ZERO_TERMINATED, 0,
       PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_OVERFLOW_LENGTH,
-      0, match_context, replacement, PCRE2_ZERO_TERMINATED, 0, &output_length);
+      regex->match_data, NULL, replacement, PCRE2_ZERO_TERMINATED, 0, &output_length);
 
   if (result < 0 && result != PCRE2_ERROR_NOMEMORY) {
-    pcre2_code_free(re);
-    pcre2_match_context_free(match_context);
     REGEX_ERR("regular expression post-compilation failed for replacement",
               result);
   }
@@ -1182,12 +1485,10 @@ DECLARE_STRING_METHOD(replace) {
 
   result = pcre2_substitute(
       re, input, PCRE2_ZERO_TERMINATED, 0,
-      PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_UNSET_EMPTY, 0, match_context,
+      PCRE2_SUBSTITUTE_GLOBAL | PCRE2_SUBSTITUTE_UNSET_EMPTY, regex->match_data, NULL,
       replacement, PCRE2_ZERO_TERMINATED, output_buffer, &output_length);
 
   if (result < 0 && result != PCRE2_ERROR_NOMEMORY) {
-    pcre2_code_free(re);
-    pcre2_match_context_free(match_context);
     REGEX_ERR("regular expression error at replacement time", result);
   }
 
@@ -1195,9 +1496,6 @@ DECLARE_STRING_METHOD(replace) {
   b_obj_string *response =
       take_string(vm, (char *) output_buffer, (int) output_length);
 
-  pcre2_match_context_free(match_context);
-  pcre2_code_free(re);
-
   RETURN_OBJ(response);
 }
 
@@ -1227,23 +1525,20 @@ DECLARE_STRING_METHOD(replace_with) {
     RETURN_VALUE_ERROR(_INVALID_REGEX_ERROR);
   }
 
-  char *real_regex = remove_regex_delimiter(vm, pattern_string);
-
   int error_number;
   int rc;
   PCRE2_SIZE error_offset;
 
-  PCRE2_SPTR pattern = (PCRE2_SPTR) real_regex;
   PCRE2_SPTR subject = (PCRE2_SPTR) string->chars;
   PCRE2_SIZE subject_length = (PCRE2_SIZE) string->length;
 
-  pcre2_code *re =
-      pcre2_compile(pattern, PCRE2_ZERO_TERMINATED, compile_options,
-                    &error_number, &error_offset, NULL);
-  free(real_regex);
-
-  REGEX_COMPILATION_ERROR(re, error_number, error_offset);
+  b_regex *regex = get_regex(vm, pattern_string, compile_options, &error_number, &error_offset);
+  REGEX_COMPILATION_ERROR(regex, error_number, error_offset);
 
+  // the replacer may use regular expressions too and evict this one from
+  // the cache or reuse its match data, so keep our own.
+  regex->ref_count++;
+  pcre2_code *re = regex->code;
   pcre2_match_data *match_data = pcre2_match_data_create_from_pattern(re, NULL);
   char *result = calloc(1, sizeof(char));
 
@@ -1255,7 +1550,8 @@ DECLARE_STRING_METHOD(replace_with) {
         break;
       } else {
         pcre2_match_data_free(match_data);
-        pcre2_code_free(re);
+        release_regex(regex);
+        free(result);
         REGEX_RC_ERROR();
       }
     }
@@ -1323,6 +1619,9 @@ DECLARE_STRING_METHOD(replace_with) {
     b_value call_result = call_closure(vm, replacer, call_args);
 
     if(!IS_STRING(call_result)) {
+      pcre2_match_data_free(match_data);
+      release_regex(regex);
+      free(result);
       RETURN_TYPE_ERROR("replace_with() function returned non-string");
     }
 
@@ -1340,7 +1639,7 @@ DECLARE_STRING_METHOD(replace_with) {
   }
 
   pcre2_match_data_free(match_data);
-  pcre2_code_free(re);
+  release_regex(regex);
 
   RETURN_TT_STRING(result);
 
@@ -1378,7 +1677,7 @@ DECLARE_STRING_METHOD(__iter__) {
     if(!string->is_ascii) {
       int start = index, end = index + 1;
       if(!string->is_ascii) {
-        utf8slice(string->chars, &start, &end);
+        string_utf8_slice(vm, string, &start, &end);
       }
 
       RETURN_L_STRING(string->chars + start, (int) (end - start));
@@ -40,4 +40,9 @@ DECLARE_STRING_METHOD(compare);
 DECLARE_STRING_METHOD(__iter__);
 DECLARE_STRING_METHOD(__itern__);
 
+const char *find_substring(const char *haystack, size_t haystack_length,
+                           const char *needle, size_t needle_length);
+
+void free_regex_cache(b_vm *vm);
+
 #endif
\ No newline at end of file
@@ -0,0 +1,2575 @@
+#include "bytecode.h"
+#include "compiler.h"
+#include "memory.h"
+#include "module.h"
+#include "pathinfo.h"
+#include "util.h"
+#include "vm.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#if !defined(HAVE_DIRENT_H) || defined(_WIN32)
+#include "dirent/dirent.h"
+#else
+#include <dirent.h>
+#endif /* HAVE_DIRENT_H */
+
+#ifdef _WIN32
+#include <direct.h>
+#define make_directory(path) _mkdir(path)
+#else
+#define make_directory(path) mkdir(path, 0755)
+#endif /* _WIN32 */
+
+/**
+ * a cache file holds the header followed by the module function.
+ *
+ * header:    magic, format, BVM version, source mtime, source mtime
+ *            nanoseconds, source size, source path, checksum
+ * function:  type, arity, up value count, variadic flag, name, code, line
+ *            table, constants
+ *
+ * integers are stored in the byte order of the machine that wrote the file
+ * and the magic number doubles as a byte order check. the checksum covers
+ * every byte after it so that a damaged file is a cache miss instead of
+ * code the vm runs. bump BYTECODE_FORMAT whenever the layout changes.
+ */
+#define BYTECODE_MAGIC 0x43424C42 // BLBC
+#define BYTECODE_FORMAT 5
+#define BYTECODE_EXTENSION ".bbc"
+
+/**
+ * an image holds the functions of every module in a library directory.
+ *
+ * header:    magic, format, BVM version, checksum, module count
+ * module:    path relative to the library directory, function size, function
+ *
+ * images are built together with the library directory they sit next to so
+ * that, unlike cache files, their modules are not checked against the
+ * source.
+ */
+#define BYTECODE_IMAGE_MAGIC 0x49424C42 // BLBI
+#define BYTECODE_IMAGE_EXTENSION ".bbi"
+
+typedef enum {
+  CONST_NIL,
+  CONST_TRUE,
+  CONST_FALSE,
+  CONST_NUMBER,
+  CONST_STRING,
+  CONST_FUNCTION,
+  CONST_SWITCH,
+  CONST_IMPORT,
+  CONST_LAZY_IMPORT,
+} b_const_tag;
+
+typedef struct {
+  unsigned char *bytes;
+  size_t length;
+  size_t capacity;
+  bool ok;
+} b_bytecode_writer;
+
+/**
+ * the modules loaded while loading an import. a module imported again
+ * under the same name is shared instead of being loaded again, which is
+ * what the vm would do with it at runtime anyway.
+ */
+typedef struct {
+  b_obj_closure **closures;
+  int count;
+  int capacity;
+} b_import_list;
+
+typedef struct {
+  const unsigned char *bytes;
+  size_t length;
+  size_t offset;
+  b_import_list *imports;
+} b_bytecode_reader;
+
+typedef struct {
+  const char *path;
+  int path_length;
+  size_t offset;
+  size_t length;
+} b_image_module;
+
+// the image of the standard library. it is opened on the first import and
+// kept for the life of the process.
+static struct {
+  bool is_open;
+  char *directory;
+  int directory_length;
+  unsigned char *bytes;
+  b_image_module *modules;
+  int count;
+} library_image;
+
+static char *get_cache_directory() {
+  char *directory = getenv("BLADE_CACHE_DIR");
+  if (directory != NULL && directory[0] != '\0') {
+    return strdup(directory);
+  }
+
+#ifdef _WIN32
+  directory = getenv("LOCALAPPDATA");
+  if (directory != NULL && directory[0] != '\0') {
+    return merge_paths(directory, "blade\\cache");
+  }
+#else
+  directory = getenv("XDG_CACHE_HOME");
+  if (directory != NULL && directory[0] != '\0') {
+    return merge_paths(directory, "blade");
+  }
+
+  directory = getenv("HOME");
+  if (directory != NULL && directory[0] != '\0') {
+    return merge_paths(directory, ".cache/blade");
+  }
+#endif /* _WIN32 */
+
+  return NULL;
+}
+
+static bool create_cache_directory(char *directory) {
+  char separator = BLADE_PATH_SEPARATOR[0];
+
+  // parent directories may fail for reasons such as permissions and still
+  // exist so that only the last one is checked.
+  for (char *p = strchr(directory + 1, separator); p != NULL; p = strchr(p + 1, separator)) {
+    *p = '\0';
+    make_directory(directory);
+    *p = separator;
+  }
+
+  return make_directory(directory) == 0 || errno == EEXIST;
+}
+
+/**
+ * cache files are named after a hash of the source path. the path itself
+ * is stored in the file so that a hash collision is only a cache miss.
+ */
+// st_mtime alone misses edits made within the same second that keep the
+// size of the file.
+static int64_t get_mtime_nanoseconds(const struct stat *source) {
+#if defined(__APPLE__)
+  return (int64_t) source->st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+  return 0;
+#else
+  return (int64_t) source->st_mtim.tv_nsec;
+#endif
+}
+
+static char *get_cache_file(const char *source_file, bool create) {
+  char *directory = get_cache_directory();
+  if (directory == NULL) {
+    return NULL;
+  }
+
+  if (create && !create_cache_directory(directory)) {
+    free(directory);
+    return NULL;
+  }
+
+  uint64_t hash = 14695981039346656037ULL;
+  for (const char *c = source_file; *c != '\0'; c++) {
+    hash ^= (unsigned char) *c;
+    hash *= 1099511628211ULL;
+  }
+
+  char name[17 + sizeof(BYTECODE_EXTENSION)];
+  snprintf(name, sizeof(name), "%016llx" BYTECODE_EXTENSION, (unsigned long long) hash);
+
+  char *file = merge_paths(directory, name);
+  free(directory);
+  return file;
+}
+
+static void write_bytes(b_bytecode_writer *writer, const void *bytes, size_t length) {
+  if (!writer->ok) return;
+
+  if (writer->capacity - writer->length < length) {
+    size_t capacity = writer->capacity < 4096 ? 4096 : writer->capacity;
+    while (capacity - writer->length < length) {
+      capacity *= 2;
+    }
+
+    unsigned char *new_bytes = (unsigned char *) realloc(writer->bytes, capacity);
+    if (new_bytes == NULL) {
+      writer->ok = false;
+      return;
+    }
+
+    writer->bytes = new_bytes;
+    writer->capacity = capacity;
+  }
+
+  memcpy(writer->bytes + writer->length, bytes, length);
+  writer->length += length;
+}
+
+static void write_byte(b_bytecode_writer *writer, uint8_t value) {
+  write_bytes(writer, &value, sizeof(value));
+}
+
+static void write_int(b_bytecode_writer *writer, int32_t value) {
+  write_bytes(writer, &value, sizeof(value));
+}
+
+static void write_long(b_bytecode_writer *writer, int64_t value) {
+  write_bytes(writer, &value, sizeof(value));
+}
+
+static void write_string(b_bytecode_writer *writer, const char *chars, int length) {
+  write_int(writer, length);
+  write_bytes(writer, chars, length);
+}
+
+/**
+ * FNV-1a over eight bytes at a time. the library image is checked on every
+ * start so hashing it a byte at a time like hash_string() would cost more
+ * than reading it.
+ */
+static uint32_t checksum_bytes(const unsigned char *bytes, size_t length) {
+  uint64_t hash = 14695981039346656037u;
+  size_t i = 0;
+
+  for (; i + sizeof(uint64_t) <= length; i += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes + i, sizeof(word));
+    hash = (hash ^ word) * 1099511628211u;
+  }
+  for (; i < length; i++) {
+    hash = (hash ^ bytes[i]) * 1099511628211u;
+  }
+
+  return (uint32_t) (hash ^ (hash >> 32));
+}
+
+// reserves the checksum of the bytes written after it.
+static size_t write_checksum_slot(b_bytecode_writer *writer) {
+  size_t offset = writer->length;
+  write_int(writer, 0);
+  return offset;
+}
+
+static bool write_checksum(b_bytecode_writer *writer, size_t offset) {
+  if (!writer->ok) {
+    return false;
+  }
+
+  size_t start = offset + sizeof(uint32_t);
+  uint32_t checksum = checksum_bytes(writer->bytes + start, writer->length - start);
+  memcpy(writer->bytes + offset, &checksum, sizeof(checksum));
+  return true;
+}
+
+static bool write_function(b_bytecode_writer *writer, b_obj_func *function);
+
+static bool write_constant(b_bytecode_writer *writer, b_value value) {
+  if (IS_NIL(value)) {
+    write_byte(writer, CONST_NIL);
+  } else if (IS_BOOL(value)) {
+    write_byte(writer, AS_BOOL(value) ? CONST_TRUE : CONST_FALSE);
+  } else if (IS_NUMBER(value)) {
+    double number = AS_NUMBER(value);
+    write_byte(writer, CONST_NUMBER);
+    write_bytes(writer, &number, sizeof(number));
+  } else if (IS_STRING(value)) {
+    write_byte(writer, CONST_STRING);
+    write_string(writer, AS_STRING(value)->chars, AS_STRING(value)->length);
+  } else if (IS_FUNCTION(value)) {
+    write_byte(writer, CONST_FUNCTION);
+    return write_function(writer, AS_FUNCTION(value));
+  } else if (IS_SWITCH(value)) {
+    b_obj_switch *sw = AS_SWITCH(value);
+    write_byte(writer, CONST_SWITCH);
+    write_int(writer, sw->default_jump);
+    write_int(writer, sw->exit_jump);
+    write_int(writer, sw->table.count);
+
+    for (int i = 0; i < sw->table.capacity; i++) {
+      b_entry *entry = &sw->table.entries[i];
+      if (!IS_EMPTY(entry->key)) {
+        if (!write_constant(writer, entry->key) || !write_constant(writer, entry->value)) {
+          return false;
+        }
+      }
+    }
+  } else if (IS_CLOSURE(value)) {
+    // the closure of an imported module. the import is stored as written
+    // in the source and resolved again when loaded because the file it
+    // resolves to depends on the root file and working directory.
+    b_obj_module *module = AS_CLOSURE(value)->function->module;
+    if (module->import_file == NULL) {
+      return false;
+    }
+
+    write_byte(writer, CONST_IMPORT);
+    write_string(writer, module->name, (int) strlen(module->name));
+    write_string(writer, module->import_file, (int) strlen(module->import_file));
+    write_byte(writer, module->import_is_relative);
+  } else if (IS_MODULE(value)) {
+    // a lazy import. the module is only loaded when the import runs.
+    b_obj_module *module = AS_MODULE(value);
+    if (module->import_file == NULL) {
+      return false;
+    }
+
+    write_byte(writer, CONST_LAZY_IMPORT);
+    write_string(writer, module->name, (int) strlen(module->name));
+    write_string(writer, module->import_file, (int) strlen(module->import_file));
+    write_byte(writer, module->import_is_relative);
+  } else {
+    return false;
+  }
+
+  return writer->ok;
+}
+
+static bool write_function(b_bytecode_writer *writer, b_obj_func *function) {
+  write_byte(writer, function->type);
+  write_int(writer, function->arity);
+  write_int(writer, function->up_value_count);
+  write_byte(writer, function->is_variadic);
+
+  write_byte(writer, function->name != NULL);
+  if (function->name != NULL) {
+    write_string(writer, function->name->chars, function->name->length);
+  }
+
+  b_blob *blob = &function->blob;
+  write_int(writer, blob->count);
+  write_bytes(writer, blob->code, blob->count);
+  write_int(writer, blob->lines_length);
+  write_bytes(writer, blob->lines, blob->lines_length);
+
+  write_int(writer, blob->constants.count);
+  for (int i = 0; i < blob->constants.count; i++) {
+    if (!write_constant(writer, blob->constants.values[i])) {
+      return false;
+    }
+  }
+
+  return writer->ok;
+}
+
+// writes to a temporary file first so that other processes never see a
+// partially written file. the writer lives on the stack of the thread
+// writing the file, so its address keeps the threads of a parallel
+// compile from sharing a temporary file.
+static bool write_cache_file(const char *path, b_bytecode_writer *writer) {
+  char temp_file[48];
+  snprintf(temp_file, sizeof(temp_file), ".%d.%p.tmp", (int) getpid(), (void *) writer);
+  char *temp_path = append_strings(strdup(path), temp_file);
+
+  bool saved = false;
+  FILE *fp = fopen(temp_path, "wb");
+  if (fp != NULL) {
+    saved = fwrite(writer->bytes, 1, writer->length, fp) == writer->length;
+    saved = fclose(fp) == 0 && saved;
+
+#ifdef _WIN32
+    // rename() does not replace existing files on windows.
+    remove(path);
+#endif /* _WIN32 */
+    if (!saved || rename(temp_path, path) != 0) {
+      remove(temp_path);
+      saved = false;
+    }
+  }
+
+  free(temp_path);
+  return saved;
+}
+
+bool save_bytecode(b_vm *vm, b_obj_func *function) {
+  const char *source_file = function->module->file;
+
+  struct stat source;
+  if (stat(source_file, &source) != 0) {
+    return false;
+  }
+
+  b_bytecode_writer writer = {NULL, 0, 0, true};
+  write_int(&writer, BYTECODE_MAGIC);
+  write_int(&writer, BYTECODE_FORMAT);
+  write_string(&writer, BVM_VERSION, (int) strlen(BVM_VERSION));
+  write_long(&writer, (int64_t) source.st_mtime);
+  write_long(&writer, get_mtime_nanoseconds(&source));
+  write_long(&writer, (int64_t) source.st_size);
+  write_string(&writer, source_file, (int) strlen(source_file));
+  size_t checksum_offset = write_checksum_slot(&writer);
+
+  char *cache_file = NULL;
+  bool saved = write_function(&writer, function) &&
+               write_checksum(&writer, checksum_offset) &&
+               (cache_file = get_cache_file(source_file, true)) != NULL &&
+               write_cache_file(cache_file, &writer);
+
+  free(cache_file);
+  free(writer.bytes);
+  return saved;
+}
+
+bool save_bytecode_image(b_vm *vm, const char *image_file, const char *directory, char **files, int count) {
+  int directory_length = (int) strlen(directory);
+
+  b_bytecode_writer writer = {NULL, 0, 0, true};
+  write_int(&writer, BYTECODE_IMAGE_MAGIC);
+  write_int(&writer, BYTECODE_FORMAT);
+  write_string(&writer, BVM_VERSION, (int) strlen(BVM_VERSION));
+  size_t checksum_offset = write_checksum_slot(&writer);
+
+  size_t count_offset = writer.length;
+  write_int(&writer, 0);
+
+  // every module must be compiled from its source and not from an
+  // older image.
+  bool use_bytecode_cache = vm->use_bytecode_cache;
+  vm->use_bytecode_cache = false;
+
+  int32_t module_count = 0;
+  for (int i = 0; i < count && writer.ok; i++) {
+    const char *file = files[i];
+    if (strncmp(file, directory, directory_length) != 0 || file[directory_length] != BLADE_PATH_SEPARATOR[0]) {
+      continue;
+    }
+
+    char *source = read_file(file);
+    if (source == NULL) {
+      continue;
+    }
+
+    b_obj_module *module = new_module(vm, strdup(""), strdup(file), NULL);
+    push(vm, OBJ_VAL(module));
+    b_obj_func *function = compile(vm, module, source);
+    free(source);
+
+    if (function != NULL) {
+      size_t start = writer.length;
+      const char *path = file + directory_length + 1;
+      write_string(&writer, path, (int) strlen(path));
+
+      size_t size_offset = writer.length;
+      write_long(&writer, 0);
+
+      if (write_function(&writer, function)) {
+        int64_t size = (int64_t) (writer.length - size_offset - sizeof(int64_t));
+        memcpy(writer.bytes + size_offset, &size, sizeof(size));
+        module_count++;
+      } else {
+        writer.length = start;
+      }
+    }
+
+    pop(vm);
+  }
+
+  vm->use_bytecode_cache = use_bytecode_cache;
+
+  bool saved = false;
+  if (writer.ok) {
+    memcpy(writer.bytes + count_offset, &module_count, sizeof(module_count));
+    saved = write_checksum(&writer, checksum_offset) && write_cache_file(image_file, &writer);
+  }
+
+  free(writer.bytes);
+  return saved;
+}
+
+static bool read_bytes(b_bytecode_reader *reader, void *bytes, size_t length) {
+  if (reader->length - reader->offset < length) {
+    return false;
+  }
+
+  memcpy(bytes, reader->bytes + reader->offset, length);
+  reader->offset += length;
+  return true;
+}
+
+static bool read_byte(b_bytecode_reader *reader, uint8_t *value) {
+  return read_bytes(reader, value, sizeof(*value));
+}
+
+static bool read_int(b_bytecode_reader *reader, int32_t *value) {
+  return read_bytes(reader, value, sizeof(*value));
+}
+
+static bool read_long(b_bytecode_reader *reader, int64_t *value) {
+  return read_bytes(reader, value, sizeof(*value));
+}
+
+// reads the number of the items that follow, each taking at least size
+// bytes, so that a damaged count fails here instead of in a loop or an
+// allocation.
+static bool read_count(b_bytecode_reader *reader, int32_t *count, size_t size) {
+  return read_int(reader, count) && *count >= 0 && (size_t) *count <= (reader->length - reader->offset) / size;
+}
+
+// returns the next string in the file without copying it.
+static const char *read_chars(b_bytecode_reader *reader, int *length) {
+  if (!read_int(reader, length) || *length < 0 ||
+      reader->length - reader->offset < (size_t) *length) {
+    return NULL;
+  }
+
+  const char *chars = (const char *) reader->bytes + reader->offset;
+  reader->offset += *length;
+  return chars;
+}
+
+static bool read_string_equals(b_bytecode_reader *reader, const char *expected) {
+  int length;
+  const char *chars = read_chars(reader, &length);
+  return chars != NULL && length == (int) strlen(expected) && memcmp(chars, expected, length) == 0;
+}
+
+// checks the rest of the file against the checksum before any of it is
+// decoded.
+static bool read_checksum(b_bytecode_reader *reader) {
+  int32_t checksum;
+  return read_int(reader, &checksum) &&
+         (uint32_t) checksum == checksum_bytes(reader->bytes + reader->offset, reader->length - reader->offset);
+}
+
+static char *read_c_string(b_bytecode_reader *reader) {
+  int length;
+  const char *chars = read_chars(reader, &length);
+  if (chars == NULL) {
+    return NULL;
+  }
+
+  char *string = (char *) malloc(length + 1);
+  if (string != NULL) {
+    memcpy(string, chars, length);
+    string[length] = '\0';
+  }
+  return string;
+}
+
+static b_obj_func *read_function(b_vm *vm, b_bytecode_reader *reader, b_obj_module *module);
+
+static b_obj_func *load_module_bytecode(b_vm *vm, b_obj_module *module, b_import_list *imports);
+
+static bool add_import(b_import_list *imports, b_obj_closure *closure);
+
+// returns true if any module imported by the function is the given module
+// or one of its parents. visited holds the imports already checked so that
+// modules shared by many others are only walked once.
+static bool imports_any_of(b_obj_func *function, b_obj_module *module, b_import_list *visited) {
+  b_value_arr *constants = &function->blob.constants;
+
+  for (int i = 0; i < constants->count; i++) {
+    b_value value = constants->values[i];
+
+    if (IS_FUNCTION(value)) {
+      if (imports_any_of(AS_FUNCTION(value), module, visited)) {
+        return true;
+      }
+    } else if (IS_CLOSURE(value)) {
+      b_obj_closure *closure = AS_CLOSURE(value);
+
+      bool is_visited = false;
+      for (int j = 0; j < visited->count && !is_visited; j++) {
+        is_visited = visited->closures[j] == closure;
+      }
+
+      if (is_visited) {
+        continue;
+      }
+
+      add_import(visited, closure);
+
+      b_obj_func *import = closure->function;
+      for (b_obj_module *check_module = module; check_module != NULL; check_module = check_module->parent) {
+        if (strcmp(import->module->file, check_module->file) == 0) {
+          return true;
+        }
+      }
+
+      if (imports_any_of(import, module, visited)) {
+        return true;
+      }
+    }
+  }
+
+  return false;
+}
+
+static b_obj_closure *find_import(b_import_list *imports, const char *name, const char *path, b_obj_module *module) {
+  for (int i = 0; i < imports->count; i++) {
+    b_obj_module *import = imports->closures[i]->function->module;
+
+    if (strcmp(import->file, path) == 0 && strcmp(import->name, name) == 0) {
+      // a shared module must not import the module importing it now or
+      // the compiler would have reported a cyclic import.
+      b_import_list visited = {NULL, 0, 0};
+      bool is_cyclic = imports_any_of(imports->closures[i]->function, module, &visited);
+      free(visited.closures);
+
+      return is_cyclic ? NULL : imports->closures[i];
+    }
+  }
+
+  return NULL;
+}
+
+static bool add_import(b_import_list *imports, b_obj_closure *closure) {
+  if (imports->count == imports->capacity) {
+    int capacity = GROW_CAPACITY(imports->capacity);
+    b_obj_closure **closures = (b_obj_closure **) realloc(imports->closures, sizeof(b_obj_closure *) * capacity);
+    if (closures == NULL) {
+      return false;
+    }
+
+    imports->closures = closures;
+    imports->capacity = capacity;
+  }
+
+  imports->closures[imports->count++] = closure;
+  return true;
+}
+
+/**
+ * recreates the module of a cached import the same way the compiler's
+ * import statement does. any import that would not compile exactly as it
+ * did when the file was written makes the whole file stale.
+ */
+static b_obj_module *read_import_module(b_vm *vm, b_bytecode_reader *reader, b_obj_module *module) {
+  uint8_t is_relative;
+  char *name = read_c_string(reader);
+  char *import_file = read_c_string(reader);
+  char *path = NULL;
+
+  if (name == NULL || import_file == NULL || !read_byte(reader, &is_relative) ||
+      (path = resolve_import_path(vm, import_file, module->file, vm->root_file, is_relative)) == NULL) {
+    free(name);
+    free(import_file);
+    return NULL;
+  }
+
+  // cyclic imports are reported by the compiler
+  for (b_obj_module *check_module = module; check_module->parent != NULL; check_module = check_module->parent) {
+    if (strcmp(path, check_module->parent->file) == 0) {
+      free(name);
+      free(import_file);
+      free(path);
+      return NULL;
+    }
+  }
+
+  b_obj_module *import = new_module(vm, name, path, module);
+  import->import_file = import_file;
+  import->import_is_relative = is_relative;
+  return import;
+}
+
+static b_obj_closure *read_import(b_vm *vm, b_bytecode_reader *reader, b_obj_module *module) {
+  b_obj_module *import = read_import_module(vm, reader, module);
+  if (import == NULL) {
+    return NULL;
+  }
+
+  b_obj_closure *closure = find_import(reader->imports, import->name, import->file, module);
+  if (closure != NULL) {
+    push(vm, OBJ_VAL(closure));
+    return closure;
+  }
+
+  push(vm, OBJ_VAL(import));
+
+  b_obj_func *function = load_module_bytecode(vm, import, reader->imports);
+  if (function == NULL) {
+    return NULL;
+  }
+
+  push(vm, OBJ_VAL(function));
+  closure = new_closure(vm, function);
+  pop_n(vm, 2);
+  push(vm, OBJ_VAL(closure));
+
+  register_module__FILE__(vm, import);
+  return add_import(reader->imports, closure) ? closure : NULL;
+}
+
+static bool read_constant(b_vm *vm, b_bytecode_reader *reader, b_obj_module *module, b_value *value) {
+  uint8_t tag;
+  if (!read_byte(reader, &tag)) {
+    return false;
+  }
+
+  switch (tag) {
+    case CONST_NIL:
+      *value = NIL_VAL;
+      return true;
+    case CONST_TRUE:
+      *value = TRUE_VAL;
+      return true;
+    case CONST_FALSE:
+      *value = FALSE_VAL;
+      return true;
+    case CONST_NUMBER: {
+      double number;
+      if (!read_bytes(reader, &number, sizeof(number))) {
+        return false;
+      }
+      *value = NUMBER_VAL(number);
+      return true;
+    }
+    case CONST_STRING: {
+      int length;
+      const char *chars = read_chars(reader, &length);
+      if (chars == NULL) {
+        return false;
+      }
+      *value = OBJ_VAL(copy_string(vm, chars, length));
+      push(vm, *value);
+      return true;
+    }
+    case CONST_FUNCTION: {
+      b_obj_func *function = read_function(vm, reader, module);
+      if (function == NULL) {
+        return false;
+      }
+      *value = OBJ_VAL(function);
+      return true;
+    }
+    case CONST_SWITCH: {
+      b_obj_switch *sw = new_switch(vm);
+      push(vm, OBJ_VAL(sw));
+
+      int32_t count;
+      if (!read_int(reader, &sw->default_jump) || !read_int(reader, &sw->exit_jump) ||
+          !read_count(reader, &count, 2)) {
+        return false;
+      }
+
+      for (int i = 0; i < count; i++) {
+        b_value key, jump;
+        if (!read_constant(vm, reader, module, &key) || !read_constant(vm, reader, module, &jump)) {
+          return false;
+        }
+        table_set(vm, &sw->table, key, jump);
+        if (IS_OBJ(key)) pop(vm);
+        if (IS_OBJ(jump)) pop(vm);
+      }
+
+      *value = OBJ_VAL(sw);
+      return true;
+    }
+    case CONST_IMPORT: {
+      b_obj_closure *closure = read_import(vm, reader, module);
+      if (closure == NULL) {
+        return false;
+      }
+      *value = OBJ_VAL(closure);
+      return true;
+    }
+    case CONST_LAZY_IMPORT: {
+      b_obj_module *import = read_import_module(vm, reader, module);
+      if (import == NULL) {
+        return false;
+      }
+      import->is_lazy = true;
+      push(vm, OBJ_VAL(import));
+      *value = OBJ_VAL(import);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+/**
+ * objects read are pushed to keep them from the gc until they are stored in
+ * the function (or switch) that holds them. on failure whatever is left on
+ * the stack is dropped by load_bytecode().
+ */
+// reads the code and line table of a function.
+static bool read_blob(b_vm *vm, b_bytecode_reader *reader, b_blob *blob) {
+  int32_t count, lines_length;
+  if (!read_int(reader, &count) || count <= 0 || reader->length - reader->offset < (size_t) count) {
+    return false;
+  }
+
+  blob->code = ALLOCATE(uint8_t, count);
+  blob->capacity = blob->count = count;
+  read_bytes(reader, blob->code, count);
+
+  if (!read_int(reader, &lines_length) || lines_length <= 0 ||
+      reader->length - reader->offset < (size_t) lines_length) {
+    return false;
+  }
+
+  blob->lines = ALLOCATE(uint8_t, lines_length);
+  blob->lines_capacity = blob->lines_length = lines_length;
+  read_bytes(reader, blob->lines, lines_length);
+
+  // code written to the blob after this starts a run of its own.
+  blob->last_line = get_blob_line(blob, count - 1);
+  return true;
+}
+
+static b_obj_func *read_function(b_vm *vm, b_bytecode_reader *reader, b_obj_module *module) {
+  uint8_t type, is_variadic, has_name;
+  if (!read_byte(reader, &type) || type > TYPE_SCRIPT) {
+    return NULL;
+  }
+
+  b_obj_func *function = new_function(vm, module, (b_func_type) type);
+  push(vm, OBJ_VAL(function));
+
+  if (!read_int(reader, &function->arity) || function->arity < 0 || function->arity > MAX_FUNCTION_PARAMETERS ||
+      !read_int(reader, &function->up_value_count) || function->up_value_count < 0 ||
+      function->up_value_count > UINT8_COUNT ||
+      !read_byte(reader, &is_variadic) || !read_byte(reader, &has_name)) {
+    return NULL;
+  }
+  function->is_variadic = is_variadic;
+
+  if (has_name) {
+    int length;
+    const char *chars = read_chars(reader, &length);
+    if (chars == NULL) {
+      return NULL;
+    }
+    function->name = copy_string(vm, chars, length);
+  }
+
+  b_blob *blob = &function->blob;
+  if (!read_blob(vm, reader, blob)) {
+    return NULL;
+  }
+
+  int32_t constant_count;
+  if (!read_count(reader, &constant_count, 1)) {
+    return NULL;
+  }
+
+  for (int i = 0; i < constant_count; i++) {
+    b_value value;
+    if (!read_constant(vm, reader, module, &value)) {
+      return NULL;
+    }
+    write_value_arr(vm, &blob->constants, value);
+    if (IS_OBJ(value)) pop(vm);
+  }
+
+  return function;
+}
+
+static unsigned char *read_cache_file(const char *path, size_t *length) {
+  FILE *fp = fopen(path, "rb");
+  if (fp == NULL) {
+    return NULL;
+  }
+
+  unsigned char *bytes = NULL;
+  long size;
+  if (fseek(fp, 0L, SEEK_END) == 0 && (size = ftell(fp)) > 0 && fseek(fp, 0L, SEEK_SET) == 0) {
+    bytes = (unsigned char *) malloc(size);
+    if (bytes != NULL && fread(bytes, 1, size, fp) != (size_t) size) {
+      free(bytes);
+      bytes = NULL;
+    }
+    *length = (size_t) size;
+  }
+
+  fclose(fp);
+  return bytes;
+}
+
+static void open_library_image() {
+  library_image.is_open = true;
+
+  char *exe_dir = get_exe_dir();
+  if (exe_dir == NULL) {
+    return;
+  }
+
+  char *directory = merge_paths(exe_dir, LIBRARY_DIRECTORY);
+  free(exe_dir);
+
+  char *image_file = append_strings(strdup(directory), BYTECODE_IMAGE_EXTENSION);
+  b_bytecode_reader reader = {NULL, 0, 0, NULL};
+  reader.bytes = read_cache_file(image_file, &reader.length);
+  free(image_file);
+
+  int32_t magic, format, count;
+  if (reader.bytes == NULL ||
+      !read_int(&reader, &magic) || magic != BYTECODE_IMAGE_MAGIC ||
+      !read_int(&reader, &format) || format != BYTECODE_FORMAT ||
+      !read_string_equals(&reader, BVM_VERSION) ||
+      !read_checksum(&reader) ||
+      !read_count(&reader, &count, sizeof(int32_t) + sizeof(int64_t)) || count == 0) {
+    free((void *) reader.bytes);
+    free(directory);
+    return;
+  }
+
+  b_image_module *modules = (b_image_module *) malloc(sizeof(b_image_module) * count);
+  if (modules == NULL) {
+    free((void *) reader.bytes);
+    free(directory);
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    b_image_module *module = &modules[i];
+    int64_t size;
+
+    if ((module->path = read_chars(&reader, &module->path_length)) == NULL ||
+        !read_long(&reader, &size) || size <= 0 || (uint64_t) size > reader.length - reader.offset) {
+      free(modules);
+      free((void *) reader.bytes);
+      free(directory);
+      return;
+    }
+
+    module->offset = reader.offset;
+    module->length = (size_t) size;
+    reader.offset += module->length;
+  }
+
+  library_image.directory = directory;
+  library_image.directory_length = (int) strlen(directory);
+  library_image.bytes = (unsigned char *) reader.bytes;
+  library_image.modules = modules;
+  library_image.count = count;
+}
+
+static b_obj_func *load_image_bytecode(b_vm *vm, b_obj_module *module, b_import_list *imports) {
+  if (!library_image.is_open) {
+    open_library_image();
+  }
+
+  const char *file = module->file;
+  if (library_image.count == 0 ||
+      strncmp(file, library_image.directory, library_image.directory_length) != 0 ||
+      file[library_image.directory_length] != BLADE_PATH_SEPARATOR[0]) {
+    return NULL;
+  }
+
+  const char *path = file + library_image.directory_length + 1;
+  int path_length = (int) strlen(path);
+
+  for (int i = 0; i < library_image.count; i++) {
+    b_image_module *image_module = &library_image.modules[i];
+
+    if (image_module->path_length == path_length && memcmp(image_module->path, path, path_length) == 0) {
+      b_bytecode_reader reader = {library_image.bytes + image_module->offset, image_module->length, 0, imports};
+      b_value *stack_top = vm->stack_top;
+
+      b_obj_func *function = read_function(vm, &reader, module);
+      if (reader.offset != reader.length) {
+        function = NULL;
+      }
+
+      vm->stack_top = stack_top;
+      return function;
+    }
+  }
+
+  return NULL;
+}
+
+static b_obj_func *load_module_bytecode(b_vm *vm, b_obj_module *module, b_import_list *imports) {
+  b_obj_func *function = load_image_bytecode(vm, module, imports);
+  if (function != NULL) {
+    return function;
+  }
+
+  struct stat source;
+  if (stat(module->file, &source) != 0) {
+    return NULL;
+  }
+
+  char *cache_file = get_cache_file(module->file, false);
+  if (cache_file == NULL) {
+    return NULL;
+  }
+
+  b_bytecode_reader reader = {NULL, 0, 0, imports};
+  reader.bytes = read_cache_file(cache_file, &reader.length);
+  free(cache_file);
+  if (reader.bytes == NULL) {
+    return NULL;
+  }
+
+  int32_t magic, format;
+  int64_t mtime, mtime_nanoseconds, size;
+
+  if (read_int(&reader, &magic) && magic == BYTECODE_MAGIC &&
+      read_int(&reader, &format) && format == BYTECODE_FORMAT &&
+      read_string_equals(&reader, BVM_VERSION) &&
+      read_long(&reader, &mtime) && mtime == (int64_t) source.st_mtime &&
+      read_long(&reader, &mtime_nanoseconds) && mtime_nanoseconds == get_mtime_nanoseconds(&source) &&
+      read_long(&reader, &size) && size == (int64_t) source.st_size &&
+      read_string_equals(&reader, module->file) &&
+      read_checksum(&reader)) {
+    b_value *stack_top = vm->stack_top;
+
+    function = read_function(vm, &reader, module);
+    if (reader.offset != reader.length) {
+      function = NULL;
+    }
+
+    vm->stack_top = stack_top;
+  }
+
+  free((void *) reader.bytes);
+  return function;
+}
+
+b_obj_func *load_bytecode(b_vm *vm, b_obj_module *module) {
+  b_import_list imports = {NULL, 0, 0};
+  b_obj_func *function = load_module_bytecode(vm, module, &imports);
+  free(imports.closures);
+  return function;
+}
+
+/**
+ * a parallel compile finds the modules to compile by scanning the import
+ * statements of the modules it is given and of every module they import.
+ * the modules are then compiled by a pool of threads that each own a vm.
+ *
+ * a module is only compiled once the modules it imports are in the cache
+ * so that its imports are loaded from there instead of being compiled
+ * again by every module that imports them. lazy imports are compiled
+ * without waiting on them since the module does not load them.
+ */
+typedef struct {
+  char *file;
+  int *dependents;
+  int dependent_count;
+  int dependent_capacity;
+  int waiting; // imports that are not compiled yet.
+  bool is_scheduled;
+} b_compile_unit;
+
+typedef struct {
+  b_compile_unit *units;
+  int count;
+  int capacity;
+  int *ready;
+  int ready_count;
+  int done;
+  int busy;
+  int failed;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+} b_compile_graph;
+
+typedef struct {
+  b_vm *vm;
+  b_compile_graph *graph;
+  pthread_t thread;
+} b_compile_worker;
+
+// takes ownership of file.
+static int add_compile_unit(b_compile_graph *graph, char *file) {
+  for (int i = 0; i < graph->count; i++) {
+    if (strcmp(graph->units[i].file, file) == 0) {
+      free(file);
+      return i;
+    }
+  }
+
+  if (graph->count == graph->capacity) {
+    int capacity = graph->capacity < 8 ? 8 : graph->capacity * 2;
+    b_compile_unit *units = (b_compile_unit *) realloc(graph->units, sizeof(b_compile_unit) * capacity);
+    if (units == NULL) {
+      free(file);
+      return -1;
+    }
+
+    graph->units = units;
+    graph->capacity = capacity;
+  }
+
+  b_compile_unit *unit = &graph->units[graph->count];
+  memset(unit, 0, sizeof(b_compile_unit));
+  unit->file = file;
+  return graph->count++;
+}
+
+static void add_compile_dependency(b_compile_graph *graph, int index, int dependency) {
+  b_compile_unit *unit = &graph->units[dependency];
+  if (unit->dependent_count == unit->dependent_capacity) {
+    int capacity = unit->dependent_capacity < 4 ? 4 : unit->dependent_capacity * 2;
+    int *dependents = (int *) realloc(unit->dependents, sizeof(int) * capacity);
+    if (dependents == NULL) {
+      return;
+    }
+
+    unit->dependents = dependents;
+    unit->dependent_capacity = capacity;
+  }
+
+  unit->dependents[unit->dependent_count++] = index;
+  graph->units[index].waiting++;
+}
+
+static bool is_lazy_token(b_token token, b_scanner *scanner) {
+  if (token.type != IDENTIFIER_TOKEN || token.length != 4 || memcmp(token.start, "lazy", 4) != 0) {
+    return false;
+  }
+
+  b_scanner lookahead = *scanner;
+  b_token next = scan_token(&lookahead);
+  return next.type == IDENTIFIER_TOKEN ||
+         ((next.type == DOT_TOKEN || next.type == RANGE_TOKEN) && next.start > token.start + 4);
+}
+
+/**
+ * adds the modules imported by the module to the graph. import paths are
+ * read the way the compiler reads them and statements it would reject are
+ * skipped since compiling the module reports them.
+ */
+static void scan_compile_unit(b_vm *vm, b_compile_graph *graph, int index) {
+  const char *file = graph->units[index].file;
+
+  char *source = read_file(file);
+  if (source == NULL) {
+    return;
+  }
+
+  b_scanner scanner;
+  init_scanner(&scanner, source);
+
+  b_token token = scan_token(&scanner);
+  while (token.type != EOF_TOKEN) {
+    if (token.type != IMPORT_TOKEN) {
+      token = scan_token(&scanner);
+      continue;
+    }
+
+    token = scan_token(&scanner);
+
+    bool is_lazy = is_lazy_token(token, &scanner);
+    if (is_lazy) {
+      token = scan_token(&scanner);
+    }
+
+    bool is_relative = token.type == DOT_TOKEN;
+    b_token previous = token;
+    if (token.type == DOT_TOKEN || token.type == RANGE_TOKEN) {
+      token = scan_token(&scanner);
+    }
+
+    char *module_file = NULL;
+    bool is_complete = false;
+
+    for (int part_count = 0;; part_count++) {
+      if (previous.type == RANGE_TOKEN) {
+        is_relative = true;
+        module_file = append_strings(module_file == NULL ? strdup("") : module_file, "/../");
+      }
+
+      if (token.type != IDENTIFIER_TOKEN || (part_count == 0 && token.start[0] == '_' && !is_relative)) {
+        break;
+      }
+
+      if (module_file != NULL && module_file[strlen(module_file) - 1] != BLADE_PATH_SEPARATOR[0]) {
+        module_file = append_strings(module_file, BLADE_PATH_SEPARATOR);
+      }
+      module_file = append_strings_n(module_file == NULL ? strdup("") : module_file, (char *) token.start,
+                                     token.length);
+
+      previous = token;
+      token = scan_token(&scanner);
+      if (token.type != DOT_TOKEN && token.type != RANGE_TOKEN) {
+        is_complete = true;
+        break;
+      }
+
+      previous = token;
+      token = scan_token(&scanner);
+    }
+
+    if (is_complete) {
+      char *path = resolve_import_path(vm, module_file, file, vm->root_file, is_relative);
+      if (path != NULL) {
+        int dependency = add_compile_unit(graph, path);
+        if (dependency >= 0 && dependency != index && !is_lazy) {
+          add_compile_dependency(graph, index, dependency);
+        }
+      }
+    }
+
+    free(module_file);
+  }
+
+  free(source);
+}
+
+static void add_compile_directory(b_compile_graph *graph, const char *directory) {
+  DIR *dir = opendir(directory);
+  if (dir == NULL) {
+    return;
+  }
+
+  int extension_length = (int) strlen(BLADE_EXTENSION);
+  int stub_length = (int) strlen(".stub" BLADE_EXTENSION);
+
+  struct dirent *ent;
+  while ((ent = readdir(dir)) != NULL) {
+    // skips . and .. as well as hidden directories such as .blade
+    if (ent->d_name[0] == '.') {
+      continue;
+    }
+
+    char *path = merge_paths((char *) directory, ent->d_name);
+    if (path == NULL) {
+      continue;
+    }
+
+    int name_length = (int) strlen(ent->d_name);
+
+    struct stat sb;
+    if (stat(path, &sb) == 0 && S_ISDIR(sb.st_mode)) {
+      add_compile_directory(graph, path);
+    } else if (name_length > extension_length &&
+               strcmp(ent->d_name + name_length - extension_length, BLADE_EXTENSION) == 0 &&
+               // stubs only document native modules, see scripts/make_image.b
+               !(name_length > stub_length &&
+                 strcmp(ent->d_name + name_length - stub_length, ".stub" BLADE_EXTENSION) == 0)) {
+      char *file = realpath(path, NULL);
+      if (file != NULL) {
+        add_compile_unit(graph, file);
+      }
+    }
+
+    free(path);
+  }
+
+  closedir(dir);
+}
+
+// called with the graph locked.
+static void schedule_compile_unit(b_compile_graph *graph, int index) {
+  b_compile_unit *unit = &graph->units[index];
+  if (!unit->is_scheduled && unit->waiting <= 0) {
+    unit->is_scheduled = true;
+    graph->ready[graph->ready_count++] = index;
+  }
+}
+
+static bool compile_unit(b_vm *vm, const char *file) {
+  b_obj_module *module = new_module(vm, strdup(""), strdup(file), NULL);
+  push(vm, OBJ_VAL(module));
+
+  bool compiled = load_bytecode(vm, module) != NULL;
+  if (!compiled) {
+    char *source = read_file(file);
+    if (source == NULL) {
+      fprintf(stderr, "(Blade):\n  Could not compile %s\n  Reason: %s\n", file, strerror(errno));
+    } else {
+      b_obj_func *function = compile(vm, module, source);
+      free(source);
+
+      if (function != NULL) {
+        compiled = save_bytecode(vm, function);
+        if (!compiled) {
+          fprintf(stderr, "(Blade):\n  Could not cache %s\n", file);
+        }
+      }
+    }
+  }
+
+  pop(vm);
+  return compiled;
+}
+
+static void *run_compile_worker(void *data) {
+  b_compile_worker *worker = (b_compile_worker *) data;
+  b_compile_graph *graph = worker->graph;
+
+  pthread_mutex_lock(&graph->lock);
+  for (;;) {
+    while (graph->ready_count == 0 && graph->done < graph->count) {
+      if (graph->busy == 0) {
+        // nothing is ready and nothing will be, so the rest import each
+        // other and the cycle is left for the compiler to report.
+        for (int i = 0; i < graph->count; i++) {
+          if (!graph->units[i].is_scheduled) {
+            graph->units[i].waiting = 0;
+            schedule_compile_unit(graph, i);
+            break;
+          }
+        }
+      } else {
+        pthread_cond_wait(&graph->changed, &graph->lock);
+      }
+    }
+
+    if (graph->ready_count == 0) {
+      break;
+    }
+
+    int index = graph->ready[--graph->ready_count];
+    graph->busy++;
+    pthread_mutex_unlock(&graph->lock);
+
+    bool compiled = compile_unit(worker->vm, graph->units[index].file);
+
+    pthread_mutex_lock(&graph->lock);
+    graph->busy--;
+    graph->done++;
+    if (!compiled) {
+      graph->failed++;
+    }
+
+    b_compile_unit *unit = &graph->units[index];
+    for (int i = 0; i < unit->dependent_count; i++) {
+      graph->units[unit->dependents[i]].waiting--;
+      schedule_compile_unit(graph, unit->dependents[i]);
+    }
+
+    pthread_cond_broadcast(&graph->changed);
+  }
+  pthread_mutex_unlock(&graph->lock);
+
+  return NULL;
+}
+
+int compile_bytecode(b_vm *vm, const char *path, int jobs) {
+  char *real_path = realpath(path, NULL);
+  if (real_path == NULL) {
+    fprintf(stderr, "(Blade):\n  Could not compile %s\n  Reason: %s\n", path, strerror(errno));
+    return 1;
+  }
+
+  b_compile_graph graph;
+  memset(&graph, 0, sizeof(b_compile_graph));
+
+  struct stat sb;
+  char *root_file;
+  if (stat(real_path, &sb) == 0 && S_ISDIR(sb.st_mode)) {
+    root_file = merge_paths(real_path, LIBRARY_DIRECTORY_INDEX BLADE_EXTENSION);
+    add_compile_directory(&graph, real_path);
+    free(real_path);
+  } else {
+    root_file = real_path;
+    add_compile_unit(&graph, strdup(real_path));
+  }
+
+  char *vm_root_file = vm->root_file;
+  vm->root_file = root_file;
+
+  // the graph grows as its modules are scanned.
+  for (int i = 0; i < graph.count; i++) {
+    scan_compile_unit(vm, &graph, i);
+  }
+
+  if (jobs > graph.count) {
+    jobs = graph.count;
+  }
+
+  graph.ready = (int *) malloc(sizeof(int) * (graph.count + 1));
+  b_compile_worker *workers = (b_compile_worker *) calloc(jobs, sizeof(b_compile_worker));
+
+  if (graph.ready != NULL && workers != NULL) {
+    for (int i = 0; i < graph.count; i++) {
+      schedule_compile_unit(&graph, i);
+    }
+
+    // everything the workers share is set up before they start.
+    if (!library_image.is_open) {
+      open_library_image();
+    }
+
+    pthread_mutex_init(&graph.lock, NULL);
+    pthread_cond_init(&graph.changed, NULL);
+
+    int started = 0;
+    for (int i = 0; i < jobs; i++) {
+      b_vm *worker_vm = (b_vm *) malloc(sizeof(b_vm));
+      if (worker_vm == NULL) {
+        break;
+      }
+
+      memset(worker_vm, 0, sizeof(b_vm));
+      init_vm(worker_vm);
+      worker_vm->show_warnings = vm->show_warnings;
+      worker_vm->use_bytecode_cache = true;
+      worker_vm->root_file = root_file;
+      bind_native_modules(worker_vm);
+
+      workers[i].vm = worker_vm;
+      workers[i].graph = &graph;
+      if (pthread_create(&workers[i].thread, NULL, run_compile_worker, &workers[i]) != 0) {
+        free_vm(worker_vm);
+        break;
+      }
+
+      started++;
+    }
+
+    // without any thread, the modules are compiled by this one.
+    if (started == 0) {
+      b_compile_worker worker = {.vm = vm, .graph = &graph};
+      run_compile_worker(&worker);
+    }
+
+    for (int i = 0; i < started; i++) {
+      pthread_join(workers[i].thread, NULL);
+      free_vm(workers[i].vm);
+    }
+
+    pthread_cond_destroy(&graph.changed);
+    pthread_mutex_destroy(&graph.lock);
+  } else {
+    graph.failed = graph.count;
+  }
+
+  vm->root_file = vm_root_file;
+  free(root_file);
+
+  int failed = graph.failed;
+  for (int i = 0; i < graph.count; i++) {
+    free(graph.units[i].file);
+    free(graph.units[i].dependents);
+  }
+
+  free(graph.units);
+  free(graph.ready);
+  free(workers);
+  return failed;
+}
+
+/**
+ * a snapshot holds the heap of a vm and its call stack as they are when a
+ * native function calls save_snapshot() so that a new vm can resume the
+ * program from the return of that call.
+ *
+ * header:    magic, format, BVM version, root file, checksum
+ * objects:   object count, the data of every object, then the references
+ *            of every object to values and other objects by index
+ * roots:     globals, modules, method tables, exception class, stack,
+ *            frames, catch blocks, open up values
+ *
+ * objects the vm and the native modules create before any script runs
+ * (native functions, native modules and the values they hold) are stored
+ * as the path they are reached by from the vm instead and bound to the same
+ * objects of the vm loading the snapshot.
+ */
+#define SNAPSHOT_MAGIC 0x53424C42 // BLBS
+#define SNAPSHOT_EXTERN 0xFF
+#define SNAPSHOT_ERROR_SIZE 256
+
+typedef enum {
+  SNAPSHOT_NIL,
+  SNAPSHOT_TRUE,
+  SNAPSHOT_FALSE,
+  SNAPSHOT_EMPTY,
+  SNAPSHOT_NUMBER,
+  SNAPSHOT_OBJECT,
+} b_snapshot_tag;
+
+typedef struct {
+  const void **keys;
+  int *values;
+  int count;
+  int capacity;
+} b_pointer_map;
+
+typedef struct {
+  char *path;
+  b_obj *object;
+} b_extern;
+
+typedef struct {
+  b_extern *items;
+  int count;
+  int capacity;
+  bool ok;
+} b_extern_list;
+
+typedef struct {
+  b_vm *vm;
+  b_obj **objects;
+  int count;
+  int capacity;
+  b_pointer_map indexes;
+  b_pointer_map extern_indexes;
+  b_extern_list externs;
+  char *error;
+} b_snapshot;
+
+static uint32_t hash_pointer(const void *pointer) {
+  uint64_t key = (uint64_t) (uintptr_t) pointer;
+  key ^= key >> 33;
+  key *= 0xff51afd7ed558ccdULL;
+  key ^= key >> 33;
+  return (uint32_t) key;
+}
+
+static int pointer_map_get(b_pointer_map *map, const void *key) {
+  if (map->count == 0) {
+    return -1;
+  }
+
+  for (uint32_t i = hash_pointer(key) & (map->capacity - 1);; i = (i + 1) & (map->capacity - 1)) {
+    if (map->keys[i] == NULL) return -1;
+    if (map->keys[i] == key) return map->values[i];
+  }
+}
+
+static bool pointer_map_set(b_pointer_map *map, const void *key, int value) {
+  if ((map->count + 1) * 4 > map->capacity * 3) {
+    int capacity = map->capacity < 64 ? 64 : map->capacity * 2;
+    const void **keys = (const void **) calloc(capacity, sizeof(void *));
+    int *values = (int *) malloc(sizeof(int) * capacity);
+    if (keys == NULL || values == NULL) {
+      free(keys);
+      free(values);
+      return false;
+    }
+
+    for (int i = 0; i < map->capacity; i++) {
+      if (map->keys[i] != NULL) {
+        uint32_t j = hash_pointer(map->keys[i]) & (capacity - 1);
+        while (keys[j] != NULL) j = (j + 1) & (capacity - 1);
+        keys[j] = map->keys[i];
+        values[j] = map->values[i];
+      }
+    }
+
+    free(map->keys);
+    free(map->values);
+    map->keys = keys;
+    map->values = values;
+    map->capacity = capacity;
+  }
+
+  uint32_t i = hash_pointer(key) & (map->capacity - 1);
+  while (map->keys[i] != NULL && map->keys[i] != key) i = (i + 1) & (map->capacity - 1);
+
+  if (map->keys[i] == NULL) {
+    map->count++;
+  }
+  map->keys[i] = key;
+  map->values[i] = value;
+  return true;
+}
+
+static void free_pointer_map(b_pointer_map *map) {
+  free(map->keys);
+  free(map->values);
+}
+
+static bool is_native_module(b_obj_module *module) {
+  return module->handle != NULL || strcmp(module->file, "<__native__>") == 0;
+}
+
+static void add_extern(b_extern_list *list, const char *parent, char tag, b_obj_string *key, b_obj *object) {
+  if (!list->ok) return;
+
+  if (list->count == list->capacity) {
+    int capacity = GROW_CAPACITY(list->capacity);
+    b_extern *items = (b_extern *) realloc(list->items, sizeof(b_extern) * capacity);
+    if (items == NULL) {
+      list->ok = false;
+      return;
+    }
+
+    list->items = items;
+    list->capacity = capacity;
+  }
+
+  size_t parent_length = strlen(parent);
+  char *path = (char *) malloc(parent_length + key->length + 3);
+  if (path == NULL) {
+    list->ok = false;
+    return;
+  }
+
+  memcpy(path, parent, parent_length);
+  path[parent_length] = '/';
+  path[parent_length + 1] = tag;
+  memcpy(path + parent_length + 2, key->chars, key->length);
+  path[parent_length + key->length + 2] = '\0';
+
+  list->items[list->count].path = path;
+  list->items[list->count].object = object;
+  list->count++;
+}
+
+/**
+ * adds the objects of a table created by the vm or a native module. native
+ * functions stored under another name than their own (e.g. by a script)
+ * are left out since a new vm will not have them there.
+ */
+static void collect_table_externs(b_extern_list *list, const char *parent, char tag, b_table *table, bool natives_only) {
+  for (int i = 0; i < table->capacity; i++) {
+    b_entry *entry = &table->entries[i];
+    if (!IS_STRING(entry->key) || !IS_OBJ(entry->value) || IS_STRING(entry->value)) {
+      continue;
+    }
+
+    b_obj_string *key = AS_STRING(entry->key);
+    b_obj *object = AS_OBJ(entry->value);
+
+    if (object->type == OBJ_NATIVE) {
+      if (strcmp(((b_obj_native *) object)->name, key->chars) != 0) {
+        continue;
+      }
+    } else if (natives_only) {
+      continue;
+    }
+
+    add_extern(list, parent, tag, key, object);
+
+    if (object->type == OBJ_CLASS && list->ok) {
+      b_obj_class *klass = (b_obj_class *) object;
+      char *path = list->items[list->count - 1].path;
+      collect_table_externs(list, path, 'M', &klass->methods, false);
+      collect_table_externs(list, path, 'P', &klass->properties, false);
+      collect_table_externs(list, path, 'S', &klass->static_properties, false);
+    }
+  }
+}
+
+static void collect_externs(b_vm *vm, b_extern_list *list) {
+  collect_table_externs(list, "", 'g', &vm->globals, true);
+  collect_table_externs(list, "", 's', &vm->methods_string, true);
+  collect_table_externs(list, "", 'l', &vm->methods_list, true);
+  collect_table_externs(list, "", 'd', &vm->methods_dict, true);
+  collect_table_externs(list, "", 'f', &vm->methods_file, true);
+  collect_table_externs(list, "", 'b', &vm->methods_bytes, true);
+  collect_table_externs(list, "", 'r', &vm->methods_range, true);
+
+  for (int i = 0; i < vm->modules.capacity && list->ok; i++) {
+    b_entry *entry = &vm->modules.entries[i];
+    if (IS_STRING(entry->key) && IS_MODULE(entry->value) && is_native_module(AS_MODULE(entry->value))) {
+      add_extern(list, "", 'm', AS_STRING(entry->key), AS_OBJ(entry->value));
+      if (list->ok) {
+        collect_table_externs(list, list->items[list->count - 1].path, 'v', &AS_MODULE(entry->value)->values, false);
+      }
+    }
+  }
+}
+
+static void free_externs(b_extern_list *list) {
+  for (int i = 0; i < list->count; i++) {
+    free(list->items[i].path);
+  }
+  free(list->items);
+}
+
+static int compare_externs(const void *a, const void *b) {
+  return strcmp(((const b_extern *) a)->path, ((const b_extern *) b)->path);
+}
+
+// returns the index of the object in the snapshot and queues new objects
+// to be written.
+static int32_t add_snapshot_object(b_snapshot *snapshot, b_obj *object) {
+  int index = pointer_map_get(&snapshot->indexes, object);
+  if (index >= 0) {
+    return index;
+  }
+
+  if (snapshot->count == snapshot->capacity) {
+    int capacity = GROW_CAPACITY(snapshot->capacity);
+    b_obj **objects = (b_obj **) realloc(snapshot->objects, sizeof(b_obj *) * capacity);
+    if (objects == NULL) {
+      snapshot->error = "out of memory";
+      return 0;
+    }
+
+    snapshot->objects = objects;
+    snapshot->capacity = capacity;
+  }
+
+  if (!pointer_map_set(&snapshot->indexes, object, snapshot->count)) {
+    snapshot->error = "out of memory";
+    return 0;
+  }
+
+  snapshot->objects[snapshot->count] = object;
+  return snapshot->count++;
+}
+
+static void write_snapshot_value(b_snapshot *snapshot, b_bytecode_writer *writer, b_value value) {
+  if (IS_NIL(value)) {
+    write_byte(writer, SNAPSHOT_NIL);
+  } else if (IS_EMPTY(value)) {
+    write_byte(writer, SNAPSHOT_EMPTY);
+  } else if (IS_BOOL(value)) {
+    write_byte(writer, AS_BOOL(value) ? SNAPSHOT_TRUE : SNAPSHOT_FALSE);
+  } else if (IS_NUMBER(value)) {
+    double number = AS_NUMBER(value);
+    write_byte(writer, SNAPSHOT_NUMBER);
+    write_bytes(writer, &number, sizeof(number));
+  } else {
+    write_byte(writer, SNAPSHOT_OBJECT);
+    write_int(writer, add_snapshot_object(snapshot, AS_OBJ(value)));
+  }
+}
+
+static void write_snapshot_object(b_snapshot *snapshot, b_bytecode_writer *writer, void *object) {
+  if (object == NULL) {
+    write_byte(writer, SNAPSHOT_NIL);
+  } else {
+    write_snapshot_value(snapshot, writer, OBJ_VAL(object));
+  }
+}
+
+static void write_snapshot_table(b_snapshot *snapshot, b_bytecode_writer *writer, b_table *table) {
+  int32_t count = 0;
+  for (int i = 0; i < table->capacity; i++) {
+    if (!IS_EMPTY(table->entries[i].key)) count++;
+  }
+
+  write_int(writer, count);
+  for (int i = 0; i < table->capacity; i++) {
+    b_entry *entry = &table->entries[i];
+    if (!IS_EMPTY(entry->key)) {
+      write_snapshot_value(snapshot, writer, entry->key);
+      write_snapshot_value(snapshot, writer, entry->value);
+    }
+  }
+}
+
+static void write_snapshot_c_string(b_bytecode_writer *writer, const char *chars) {
+  write_byte(writer, chars != NULL);
+  if (chars != NULL) {
+    write_string(writer, chars, (int) strlen(chars));
+  }
+}
+
+/**
+ * writes what is needed to create the object to data and its references
+ * to refs.
+ */
+static void write_snapshot_entry(b_snapshot *snapshot, b_bytecode_writer *data, b_bytecode_writer *refs, b_obj *object) {
+  b_vm *vm = snapshot->vm;
+
+  int extern_index = pointer_map_get(&snapshot->extern_indexes, object);
+  if (extern_index >= 0) {
+    const char *path = snapshot->externs.items[extern_index].path;
+    write_byte(data, SNAPSHOT_EXTERN);
+    write_string(data, path, (int) strlen(path));
+    write_byte(data, object->type == OBJ_MODULE && ((b_obj_module *) object)->imported);
+    return;
+  }
+
+  write_byte(data, object->type);
+
+  switch (object->type) {
+    case OBJ_STRING: {
+      b_obj_string *string = (b_obj_string *) object;
+      write_string(data, string->chars, string->length);
+      break;
+    }
+    case OBJ_RANGE: {
+      b_obj_range *range = (b_obj_range *) object;
+      write_int(data, range->lower);
+      write_int(data, range->upper);
+      write_int(data, range->range);
+      write_int(data, range->step);
+      break;
+    }
+    case OBJ_LIST: {
+      b_value_arr *items = &((b_obj_list *) object)->items;
+      write_int(refs, items->count);
+      for (int i = 0; i < items->count; i++) {
+        write_snapshot_value(snapshot, refs, items->values[i]);
+      }
+      break;
+    }
+    case OBJ_DICT: {
+      b_obj_dict *dict = (b_obj_dict *) object;
+      write_int(refs, dict->names.count);
+      for (int i = 0; i < dict->names.count; i++) {
+        write_snapshot_value(snapshot, refs, dict->names.values[i]);
+      }
+      write_snapshot_table(snapshot, refs, &dict->items);
+      break;
+    }
+    case OBJ_FILE: {
+      b_obj_file *file = (b_obj_file *) object;
+      if (file->file != NULL && !file->is_std) {
+        snapshot->error = "open files cannot be saved";
+        return;
+      }
+
+      write_byte(data, file->is_open);
+      write_byte(data, file->is_std);
+      write_byte(data, file->is_tty);
+      write_int(data, file->number);
+      write_snapshot_object(snapshot, refs, file->path);
+      write_snapshot_object(snapshot, refs, file->mode);
+      break;
+    }
+    case OBJ_BYTES: {
+      // views are saved with their own copy of the bytes they share.
+      b_byte_arr *bytes = &((b_obj_bytes *) object)->bytes;
+      write_int(data, bytes->count);
+      write_bytes(data, bytes->bytes, bytes->count);
+      break;
+    }
+    case OBJ_UP_VALUE: {
+      b_obj_up_value *up_value = (b_obj_up_value *) object;
+      bool is_open = up_value->location != &up_value->closed;
+      write_byte(refs, is_open);
+      if (is_open) {
+        write_int(refs, (int32_t) (up_value->location - vm->stack));
+      } else {
+        write_snapshot_value(snapshot, refs, up_value->closed);
+      }
+      break;
+    }
+    case OBJ_BOUND_METHOD: {
+      b_obj_bound *bound = (b_obj_bound *) object;
+      write_snapshot_value(snapshot, refs, bound->receiver);
+      write_snapshot_object(snapshot, refs, bound->method);
+      break;
+    }
+    case OBJ_CLOSURE: {
+      b_obj_closure *closure = (b_obj_closure *) object;
+      write_int(data, closure->up_value_count);
+      write_snapshot_object(snapshot, refs, closure->function);
+      for (int i = 0; i < closure->up_value_count; i++) {
+        write_snapshot_object(snapshot, refs, closure->up_values[i]);
+      }
+      break;
+    }
+    case OBJ_FUNCTION: {
+      b_obj_func *function = (b_obj_func *) object;
+      b_blob *blob = &function->blob;
+      write_byte(data, function->type);
+      write_int(data, function->arity);
+      write_int(data, function->up_value_count);
+      write_byte(data, function->is_variadic);
+      write_int(data, blob->count);
+      write_bytes(data, blob->code, blob->count);
+      write_int(data, blob->lines_length);
+      write_bytes(data, blob->lines, blob->lines_length);
+
+      write_snapshot_object(snapshot, refs, function->name);
+      write_snapshot_object(snapshot, refs, function->module);
+      write_int(refs, blob->constants.count);
+      for (int i = 0; i < blob->constants.count; i++) {
+        write_snapshot_value(snapshot, refs, blob->constants.values[i]);
+      }
+      break;
+    }
+    case OBJ_INSTANCE: {
+      b_obj_instance *instance = (b_obj_instance *) object;
+      write_snapshot_object(snapshot, refs, instance->klass);
+      write_snapshot_table(snapshot, refs, &instance->properties);
+      break;
+    }
+    case OBJ_CLASS: {
+      b_obj_class *klass = (b_obj_class *) object;
+      write_snapshot_object(snapshot, refs, klass->name);
+      write_snapshot_value(snapshot, refs, klass->initializer);
+      write_snapshot_object(snapshot, refs, klass->superclass);
+      write_snapshot_table(snapshot, refs, &klass->properties);
+      write_snapshot_table(snapshot, refs, &klass->static_properties);
+      write_snapshot_table(snapshot, refs, &klass->methods);
+      break;
+    }
+    case OBJ_MODULE: {
+      b_obj_module *module = (b_obj_module *) object;
+      if (is_native_module(module)) {
+        snapshot->error = "native modules not loaded at startup cannot be saved";
+        return;
+      }
+
+      write_snapshot_c_string(data, module->name);
+      write_snapshot_c_string(data, module->file);
+      write_snapshot_c_string(data, module->import_file);
+      write_byte(data, module->import_is_relative);
+      write_byte(data, module->imported);
+      write_byte(data, module->is_lazy);
+      write_snapshot_table(snapshot, refs, &module->values);
+      break;
+    }
+    case OBJ_SWITCH: {
+      b_obj_switch *sw = (b_obj_switch *) object;
+      write_int(data, sw->default_jump);
+      write_int(data, sw->exit_jump);
+      write_snapshot_table(snapshot, refs, &sw->table);
+      break;
+    }
+    case OBJ_NATIVE:
+      snapshot->error = "native functions not created at startup cannot be saved";
+      break;
+    case OBJ_PTR:
+      snapshot->error = "pointers cannot be saved";
+      break;
+    default:
+      snapshot->error = "unknown object";
+      break;
+  }
+}
+
+bool save_snapshot(b_vm *vm, const char *file, int arg_count, char *error, int error_size) {
+  // the c code between a native function and the closures it calls cannot
+  // be saved.
+  if (vm->id != 0 || vm->is_repl || vm->native_call_depth > 0) {
+    snprintf(error, error_size, "%s", vm->id != 0 ? "not on the main thread" :
+                                      vm->is_repl ? "not supported in the REPL" :
+                                      "called from a function called by a native function");
+    return false;
+  }
+
+  b_snapshot snapshot = {vm, NULL, 0, 0, {NULL, NULL, 0, 0}, {NULL, NULL, 0, 0}, {NULL, 0, 0, true}, NULL};
+  b_bytecode_writer data = {NULL, 0, 0, true};
+  b_bytecode_writer refs = {NULL, 0, 0, true};
+  b_bytecode_writer roots = {NULL, 0, 0, true};
+
+  collect_externs(vm, &snapshot.externs);
+  for (int i = 0; i < snapshot.externs.count && snapshot.externs.ok; i++) {
+    b_obj *object = snapshot.externs.items[i].object;
+    if (pointer_map_get(&snapshot.extern_indexes, object) < 0 &&
+        !pointer_map_set(&snapshot.extern_indexes, object, i)) {
+      snapshot.externs.ok = false;
+    }
+  }
+  if (!snapshot.externs.ok) {
+    snapshot.error = "out of memory";
+  }
+
+  write_snapshot_table(&snapshot, &roots, &vm->globals);
+  write_snapshot_table(&snapshot, &roots, &vm->modules);
+  write_snapshot_table(&snapshot, &roots, &vm->methods_string);
+  write_snapshot_table(&snapshot, &roots, &vm->methods_list);
+  write_snapshot_table(&snapshot, &roots, &vm->methods_dict);
+  write_snapshot_table(&snapshot, &roots, &vm->methods_file);
+  write_snapshot_table(&snapshot, &roots, &vm->methods_bytes);
+  write_snapshot_table(&snapshot, &roots, &vm->methods_range);
+  write_snapshot_object(&snapshot, &roots, vm->exception_class);
+
+  // the arguments of the native function are not part of the stack it
+  // returns to.
+  int32_t stack_count = (int32_t) (vm->stack_top - vm->stack) - arg_count;
+  write_int(&roots, stack_count);
+  for (int i = 0; i < stack_count; i++) {
+    write_snapshot_value(&snapshot, &roots, vm->stack[i]);
+  }
+
+  write_int(&roots, vm->frame_count);
+  for (int i = 0; i < vm->frame_count; i++) {
+    b_call_frame *frame = &vm->frames[i];
+    write_snapshot_object(&snapshot, &roots, frame->closure);
+    write_int(&roots, (int32_t) (frame->ip - frame->closure->function->blob.code));
+    write_int(&roots, (int32_t) (frame->slots - vm->stack));
+  }
+
+  write_int(&roots, vm->error_count);
+  for (int i = 0; i < vm->error_count; i++) {
+    b_error_frame *frame = vm->errors[i];
+    write_int(&roots, (int32_t) (frame->frame - vm->frames));
+    write_int(&roots, frame->offset);
+    write_int(&roots, (int32_t) (frame->stack_head - vm->stack));
+    write_snapshot_value(&snapshot, &roots, frame->value);
+  }
+
+  int32_t up_value_count = 0;
+  for (b_obj_up_value *up_value = vm->open_up_values; up_value != NULL; up_value = up_value->next) {
+    up_value_count++;
+  }
+  write_int(&roots, up_value_count);
+  for (b_obj_up_value *up_value = vm->open_up_values; up_value != NULL; up_value = up_value->next) {
+    write_snapshot_object(&snapshot, &roots, up_value);
+  }
+
+  // writing an object adds the objects it references to the end of the list.
+  for (int i = 0; i < snapshot.count && snapshot.error == NULL; i++) {
+    write_snapshot_entry(&snapshot, &data, &refs, snapshot.objects[i]);
+  }
+
+  bool saved = false;
+  if (snapshot.error != NULL) {
+    snprintf(error, error_size, "%s", snapshot.error);
+  } else {
+    b_bytecode_writer writer = {NULL, 0, 0, true};
+    write_int(&writer, SNAPSHOT_MAGIC);
+    write_int(&writer, BYTECODE_FORMAT);
+    write_string(&writer, BVM_VERSION, (int) strlen(BVM_VERSION));
+    write_snapshot_c_string(&writer, vm->root_file);
+    size_t checksum_offset = write_checksum_slot(&writer);
+    write_int(&writer, snapshot.count);
+    write_bytes(&writer, data.bytes, data.length);
+    write_bytes(&writer, refs.bytes, refs.length);
+    write_bytes(&writer, roots.bytes, roots.length);
+
+    if (!write_checksum(&writer, checksum_offset) || !data.ok || !refs.ok || !roots.ok) {
+      snprintf(error, error_size, "out of memory");
+    } else if (!(saved = write_cache_file(file, &writer))) {
+      snprintf(error, error_size, "could not write %s", file);
+    }
+    free(writer.bytes);
+  }
+
+  free(data.bytes);
+  free(refs.bytes);
+  free(roots.bytes);
+  free(snapshot.objects);
+  free_pointer_map(&snapshot.indexes);
+  free_pointer_map(&snapshot.extern_indexes);
+  free_externs(&snapshot.externs);
+  return saved;
+}
+
+typedef struct {
+  b_bytecode_reader reader;
+  b_obj **objects;
+  int count;
+} b_snapshot_reader;
+
+static bool read_snapshot_value(b_snapshot_reader *snapshot, b_value *value) {
+  uint8_t tag;
+  if (!read_byte(&snapshot->reader, &tag)) {
+    return false;
+  }
+
+  switch (tag) {
+    case SNAPSHOT_NIL:
+      *value = NIL_VAL;
+      return true;
+    case SNAPSHOT_TRUE:
+      *value = TRUE_VAL;
+      return true;
+    case SNAPSHOT_FALSE:
+      *value = FALSE_VAL;
+      return true;
+    case SNAPSHOT_EMPTY:
+      *value = EMPTY_VAL;
+      return true;
+    case SNAPSHOT_NUMBER: {
+      double number;
+      if (!read_bytes(&snapshot->reader, &number, sizeof(number))) {
+        return false;
+      }
+      *value = NUMBER_VAL(number);
+      return true;
+    }
+    case SNAPSHOT_OBJECT: {
+      int32_t index;
+      if (!read_int(&snapshot->reader, &index) || index < 0 || index >= snapshot->count) {
+        return false;
+      }
+      *value = OBJ_VAL(snapshot->objects[index]);
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// reads a reference to an object of the given type or to nothing.
+static bool read_snapshot_object(b_snapshot_reader *snapshot, b_obj_type type, void **object) {
+  b_value value;
+  if (!read_snapshot_value(snapshot, &value)) {
+    return false;
+  }
+
+  if (IS_NIL(value)) {
+    *object = NULL;
+    return true;
+  }
+
+  if (!is_obj_type(value, type)) {
+    return false;
+  }
+
+  *object = AS_OBJ(value);
+  return true;
+}
+
+static bool read_snapshot_table(b_snapshot_reader *snapshot, b_vm *vm, b_table *table) {
+  int32_t count;
+  if (!read_count(&snapshot->reader, &count, 2)) {
+    return false;
+  }
+
+  for (int i = 0; i < count; i++) {
+    b_value key, value;
+    if (!read_snapshot_value(snapshot, &key) || !read_snapshot_value(snapshot, &value) || IS_EMPTY(key)) {
+      return false;
+    }
+    table_set(vm, table, key, value);
+  }
+
+  return true;
+}
+
+static bool read_snapshot_c_string(b_snapshot_reader *snapshot, char **string) {
+  uint8_t has_string;
+  if (!read_byte(&snapshot->reader, &has_string)) {
+    return false;
+  }
+
+  *string = has_string ? read_c_string(&snapshot->reader) : NULL;
+  return !has_string || *string != NULL;
+}
+
+static b_obj *bind_snapshot_extern(b_vm *vm, b_snapshot_reader *snapshot, b_extern_list *externs,
+                                   char *error, int error_size) {
+  int length;
+  uint8_t imported;
+  const char *path = read_chars(&snapshot->reader, &length);
+  if (path == NULL || !read_byte(&snapshot->reader, &imported)) {
+    return NULL;
+  }
+
+  char *key = (char *) malloc(length + 1);
+  if (key == NULL) {
+    return NULL;
+  }
+  memcpy(key, path, length);
+  key[length] = '\0';
+
+  b_extern search = {key, NULL};
+  b_extern *found = (b_extern *) bsearch(&search, externs->items, externs->count, sizeof(b_extern), compare_externs);
+  if (found == NULL) {
+    snprintf(error, error_size, "%s is not available", key);
+    free(key);
+    return NULL;
+  }
+  free(key);
+
+  // native modules are prepared again for the new vm the way importing
+  // them did for the one that saved the snapshot.
+  if (imported && found->object->type == OBJ_MODULE) {
+    b_obj_module *module = (b_obj_module *) found->object;
+    if (!module->imported && module->preloader != NULL) {
+      ((b_module_loader) module->preloader)(vm);
+    }
+    module->imported = true;
+  }
+
+  return found->object;
+}
+
+static b_obj *read_snapshot_entry(b_vm *vm, b_snapshot_reader *snapshot, b_extern_list *externs,
+                                  char *error, int error_size) {
+  b_bytecode_reader *reader = &snapshot->reader;
+  uint8_t type;
+  if (!read_byte(reader, &type)) {
+    return NULL;
+  }
+
+  switch (type) {
+    case SNAPSHOT_EXTERN:
+      return bind_snapshot_extern(vm, snapshot, externs, error, error_size);
+    case OBJ_STRING: {
+      int length;
+      const char *chars = read_chars(reader, &length);
+      return chars == NULL ? NULL : (b_obj *) copy_string(vm, chars, length);
+    }
+    case OBJ_RANGE: {
+      b_obj_range *range = new_range(vm, 0, 0);
+      if (!read_int(reader, &range->lower) || !read_int(reader, &range->upper) ||
+          !read_int(reader, &range->range) || !read_int(reader, &range->step)) {
+        return NULL;
+      }
+      return (b_obj *) range;
+    }
+    case OBJ_LIST:
+      return (b_obj *) new_list(vm);
+    case OBJ_DICT:
+      return (b_obj *) new_dict(vm);
+    case OBJ_FILE: {
+      uint8_t is_open, is_std, is_tty;
+      b_obj_file *file = new_file(vm, NULL, NULL);
+      if (!read_byte(reader, &is_open) || !read_byte(reader, &is_std) || !read_byte(reader, &is_tty) ||
+          !read_int(reader, &file->number)) {
+        return NULL;
+      }
+
+      file->is_open = is_open;
+      file->is_std = is_std;
+      file->is_tty = is_tty;
+      if (is_std) {
+        file->file = file->number == 0 ? stdin : file->number == 1 ? stdout : stderr;
+      }
+      return (b_obj *) file;
+    }
+    case OBJ_BYTES: {
+      int length;
+      const char *bytes = read_chars(reader, &length);
+      return bytes == NULL ? NULL : (b_obj *) copy_bytes(vm, (unsigned char *) bytes, length);
+    }
+    case OBJ_UP_VALUE:
+      return (b_obj *) new_up_value(vm, NULL);
+    case OBJ_BOUND_METHOD:
+      return (b_obj *) new_bound_method(vm, NIL_VAL, NULL);
+    case OBJ_CLOSURE: {
+      int32_t up_value_count;
+      if (!read_int(reader, &up_value_count) || up_value_count < 0 || up_value_count > UINT8_COUNT) {
+        return NULL;
+      }
+
+      // the function is set with the references of the closure.
+      b_obj_up_value **up_values = ALLOCATE(b_obj_up_value *, up_value_count);
+      for (int i = 0; i < up_value_count; i++) {
+        up_values[i] = NULL;
+      }
+
+      b_obj_closure *closure = ALLOCATE_OBJ(b_obj_closure, OBJ_CLOSURE);
+      closure->function = NULL;
+      closure->up_values = up_values;
+      closure->up_value_count = up_value_count;
+      return (b_obj *) closure;
+    }
+    case OBJ_FUNCTION: {
+      uint8_t function_type, is_variadic;
+      if (!read_byte(reader, &function_type) || function_type > TYPE_SCRIPT) {
+        return NULL;
+      }
+
+      b_obj_func *function = new_function(vm, NULL, (b_func_type) function_type);
+      if (!read_int(reader, &function->arity) || function->arity < 0 || function->arity > MAX_FUNCTION_PARAMETERS ||
+          !read_int(reader, &function->up_value_count) || function->up_value_count < 0 ||
+          function->up_value_count > UINT8_COUNT ||
+          !read_byte(reader, &is_variadic) || !read_blob(vm, reader, &function->blob)) {
+        return NULL;
+      }
+      function->is_variadic = is_variadic;
+      return (b_obj *) function;
+    }
+    case OBJ_INSTANCE: {
+      // the class and properties are set with the references of the
+      // instance.
+      b_obj_instance *instance = ALLOCATE_OBJ(b_obj_instance, OBJ_INSTANCE);
+      instance->klass = NULL;
+      init_table(&instance->properties);
+      return (b_obj *) instance;
+    }
+    case OBJ_CLASS:
+      return (b_obj *) new_class(vm, NULL);
+    case OBJ_MODULE: {
+      char *name, *file, *import_file = NULL;
+      uint8_t import_is_relative, imported, is_lazy;
+      if (!read_snapshot_c_string(snapshot, &name)) {
+        return NULL;
+      }
+      if (!read_snapshot_c_string(snapshot, &file) || !read_snapshot_c_string(snapshot, &import_file) ||
+          !read_byte(reader, &import_is_relative) || !read_byte(reader, &imported) ||
+          !read_byte(reader, &is_lazy) || name == NULL || file == NULL) {
+        free(name);
+        free(file);
+        free(import_file);
+        return NULL;
+      }
+
+      b_obj_module *module = new_module(vm, name, file, NULL);
+      module->import_file = import_file;
+      module->import_is_relative = import_is_relative;
+      module->imported = imported;
+      module->is_lazy = is_lazy;
+      return (b_obj *) module;
+    }
+    case OBJ_SWITCH: {
+      b_obj_switch *sw = new_switch(vm);
+      if (!read_int(reader, &sw->default_jump) || !read_int(reader, &sw->exit_jump)) {
+        return NULL;
+      }
+      return (b_obj *) sw;
+    }
+    default:
+      return NULL;
+  }
+}
+
+static bool read_snapshot_refs(b_vm *vm, b_snapshot_reader *snapshot, b_obj *object) {
+  b_bytecode_reader *reader = &snapshot->reader;
+
+  switch (object->type) {
+    case OBJ_LIST: {
+      int32_t count;
+      if (!read_count(reader, &count, 1)) {
+        return false;
+      }
+
+      b_obj_list *list = (b_obj_list *) object;
+      for (int i = 0; i < count; i++) {
+        b_value value;
+        if (!read_snapshot_value(snapshot, &value)) {
+          return false;
+        }
+        write_value_arr(vm, &list->items, value);
+      }
+      return true;
+    }
+    case OBJ_DICT: {
+      int32_t count;
+      if (!read_count(reader, &count, 1)) {
+        return false;
+      }
+
+      b_obj_dict *dict = (b_obj_dict *) object;
+      for (int i = 0; i < count; i++) {
+        b_value value;
+        if (!read_snapshot_value(snapshot, &value)) {
+          return false;
+        }
+        write_value_arr(vm, &dict->names, value);
+      }
+      return read_snapshot_table(snapshot, vm, &dict->items);
+    }
+    case OBJ_FILE: {
+      b_obj_file *file = (b_obj_file *) object;
+      return read_snapshot_object(snapshot, OBJ_STRING, (void **) &file->path) &&
+             read_snapshot_object(snapshot, OBJ_STRING, (void **) &file->mode);
+    }
+    case OBJ_UP_VALUE: {
+      b_obj_up_value *up_value = (b_obj_up_value *) object;
+      uint8_t is_open;
+      if (!read_byte(reader, &is_open)) {
+        return false;
+      }
+
+      if (is_open) {
+        int32_t index;
+        if (!read_int(reader, &index) || index < 0 || (size_t) index >= vm->stack_capacity) {
+          return false;
+        }
+        up_value->location = vm->stack + index;
+        return true;
+      }
+
+      up_value->location = &up_value->closed;
+      return read_snapshot_value(snapshot, &up_value->closed);
+    }
+    case OBJ_BOUND_METHOD: {
+      b_obj_bound *bound = (b_obj_bound *) object;
+      return read_snapshot_value(snapshot, &bound->receiver) &&
+             read_snapshot_object(snapshot, OBJ_CLOSURE, (void **) &bound->method) && bound->method != NULL;
+    }
+    case OBJ_CLOSURE: {
+      b_obj_closure *closure = (b_obj_closure *) object;
+      if (!read_snapshot_object(snapshot, OBJ_FUNCTION, (void **) &closure->function) ||
+          closure->function == NULL || closure->function->up_value_count != closure->up_value_count) {
+        return false;
+      }
+
+      for (int i = 0; i < closure->up_value_count; i++) {
+        if (!read_snapshot_object(snapshot, OBJ_UP_VALUE, (void **) &closure->up_values[i])) {
+          return false;
+        }
+      }
+      return true;
+    }
+    case OBJ_FUNCTION: {
+      b_obj_func *function = (b_obj_func *) object;
+      int32_t count;
+      if (!read_snapshot_object(snapshot, OBJ_STRING, (void **) &function->name) ||
+          !read_snapshot_object(snapshot, OBJ_MODULE, (void **) &function->module) ||
+          function->module == NULL || !read_count(reader, &count, 1)) {
+        return false;
+      }
+
+      for (int i = 0; i < count; i++) {
+        b_value value;
+        if (!read_snapshot_value(snapshot, &value)) {
+          return false;
+        }
+        write_value_arr(vm, &function->blob.constants, value);
+      }
+      return true;
+    }
+    case OBJ_INSTANCE: {
+      b_obj_instance *instance = (b_obj_instance *) object;
+      return read_snapshot_object(snapshot, OBJ_CLASS, (void **) &instance->klass) && instance->klass != NULL &&
+             read_snapshot_table(snapshot, vm, &instance->properties);
+    }
+    case OBJ_CLASS: {
+      b_obj_class *klass = (b_obj_class *) object;
+      return read_snapshot_object(snapshot, OBJ_STRING, (void **) &klass->name) && klass->name != NULL &&
+             read_snapshot_value(snapshot, &klass->initializer) &&
+             read_snapshot_object(snapshot, OBJ_CLASS, (void **) &klass->superclass) &&
+             read_snapshot_table(snapshot, vm, &klass->properties) &&
+             read_snapshot_table(snapshot, vm, &klass->static_properties) &&
+             read_snapshot_table(snapshot, vm, &klass->methods);
+    }
+    case OBJ_MODULE:
+      return read_snapshot_table(snapshot, vm, &((b_obj_module *) object)->values);
+    case OBJ_SWITCH:
+      return read_snapshot_table(snapshot, vm, &((b_obj_switch *) object)->table);
+    default:
+      return true;
+  }
+}
+
+static bool read_snapshot_roots(b_vm *vm, b_snapshot_reader *snapshot) {
+  b_bytecode_reader *reader = &snapshot->reader;
+
+  if (!read_snapshot_table(snapshot, vm, &vm->globals) ||
+      !read_snapshot_table(snapshot, vm, &vm->modules) ||
+      !read_snapshot_table(snapshot, vm, &vm->methods_string) ||
+      !read_snapshot_table(snapshot, vm, &vm->methods_list) ||
+      !read_snapshot_table(snapshot, vm, &vm->methods_dict) ||
+      !read_snapshot_table(snapshot, vm, &vm->methods_file) ||
+      !read_snapshot_table(snapshot, vm, &vm->methods_bytes) ||
+      !read_snapshot_table(snapshot, vm, &vm->methods_range) ||
+      !read_snapshot_object(snapshot, OBJ_CLASS, (void **) &vm->exception_class)) {
+    return false;
+  }
+
+  int32_t stack_count;
+  if (!read_int(reader, &stack_count) || stack_count <= 0 || (size_t) stack_count > vm->stack_capacity) {
+    return false;
+  }
+
+  for (int i = 0; i < stack_count; i++) {
+    if (!read_snapshot_value(snapshot, &vm->stack[i])) {
+      return false;
+    }
+  }
+  vm->stack_top = vm->stack + stack_count;
+
+  int32_t frame_count;
+  if (!read_int(reader, &frame_count) || frame_count <= 0 || frame_count > FRAMES_MAX) {
+    return false;
+  }
+
+  for (int i = 0; i < frame_count; i++) {
+    b_call_frame *frame = &vm->frames[i];
+    int32_t ip, slots;
+    if (!read_snapshot_object(snapshot, OBJ_CLOSURE, (void **) &frame->closure) || frame->closure == NULL ||
+        !read_int(reader, &ip) || ip < 0 || ip > frame->closure->function->blob.count ||
+        !read_int(reader, &slots) || slots < 0 || slots >= stack_count) {
+      return false;
+    }
+
+    frame->ip = frame->closure->function->blob.code + ip;
+    frame->slots = vm->stack + slots;
+    frame->gc_protected = 0;
+  }
+  vm->frame_count = frame_count;
+
+  int32_t error_count;
+  if (!read_int(reader, &error_count) || error_count < 0 || error_count > ERRORS_MAX) {
+    return false;
+  }
+
+  for (int i = 0; i < error_count; i++) {
+    int32_t frame, offset, stack_head;
+    b_value value;
+    if (!read_int(reader, &frame) || frame < 0 || frame >= frame_count ||
+        !read_int(reader, &offset) || offset < 0 || offset > UINT16_MAX ||
+        !read_int(reader, &stack_head) || stack_head < 0 || stack_head > stack_count ||
+        !read_snapshot_value(snapshot, &value)) {
+      return false;
+    }
+
+    b_error_frame *error = ALLOCATE(b_error_frame, 1);
+    error->frame = &vm->frames[frame];
+    error->offset = (uint16_t) offset;
+    error->stack_head = vm->stack + stack_head;
+    error->value = value;
+    push_error(vm, error);
+  }
+
+  int32_t up_value_count;
+  if (!read_count(reader, &up_value_count, 1)) {
+    return false;
+  }
+
+  b_obj_up_value **next = &vm->open_up_values;
+  for (int i = 0; i < up_value_count; i++) {
+    b_obj_up_value *up_value;
+    if (!read_snapshot_object(snapshot, OBJ_UP_VALUE, (void **) &up_value) || up_value == NULL ||
+        up_value->location == &up_value->closed) {
+      return false;
+    }
+
+    *next = up_value;
+    next = &up_value->next;
+  }
+  *next = NULL;
+
+  return true;
+}
+
+/**
+ * the vm has no frame until the snapshot is loaded so the gc cannot run
+ * and free the objects read so far.
+ */
+bool load_snapshot(b_vm *vm, const char *file, char *error, int error_size) {
+  if (vm->frame_count != 0) {
+    snprintf(error, error_size, "snapshots can only be loaded by a new vm");
+    return false;
+  }
+
+  b_snapshot_reader snapshot = {{NULL, 0, 0, NULL}, NULL, 0};
+  snapshot.reader.bytes = read_cache_file(file, &snapshot.reader.length);
+  if (snapshot.reader.bytes == NULL) {
+    snprintf(error, error_size, "could not read %s", file);
+    return false;
+  }
+
+  int32_t magic, format, count;
+  char *root_file = NULL;
+  if (!read_int(&snapshot.reader, &magic) || magic != SNAPSHOT_MAGIC ||
+      !read_int(&snapshot.reader, &format) || format != BYTECODE_FORMAT ||
+      !read_string_equals(&snapshot.reader, BVM_VERSION) ||
+      !read_snapshot_c_string(&snapshot, &root_file) ||
+      !read_checksum(&snapshot.reader) ||
+      !read_count(&snapshot.reader, &count, 1) ||
+      (snapshot.objects = (b_obj **) malloc(sizeof(b_obj *) * (count > 0 ? count : 1))) == NULL) {
+    snprintf(error, error_size, "%s is not a snapshot of this version of blade", file);
+    free(root_file);
+    free((void *) snapshot.reader.bytes);
+    return false;
+  }
+
+  b_extern_list externs = {NULL, 0, 0, true};
+  collect_externs(vm, &externs);
+  qsort(externs.items, externs.count, sizeof(b_extern), compare_externs);
+
+  error[0] = '\0';
+  bool *is_extern = (bool *) calloc(count > 0 ? count : 1, sizeof(bool));
+  bool loaded = externs.ok && is_extern != NULL;
+
+  for (int i = 0; i < count && loaded; i++) {
+    is_extern[i] = snapshot.reader.offset < snapshot.reader.length &&
+                   snapshot.reader.bytes[snapshot.reader.offset] == SNAPSHOT_EXTERN;
+    loaded = (snapshot.objects[i] = read_snapshot_entry(vm, &snapshot, &externs, error, error_size)) != NULL;
+  }
+
+  if (loaded) {
+    snapshot.count = count;
+
+    // objects of the new vm bound to externs keep their own references.
+    for (int i = 0; i < count && loaded; i++) {
+      loaded = is_extern[i] || read_snapshot_refs(vm, &snapshot, snapshot.objects[i]);
+    }
+
+    loaded = loaded && read_snapshot_roots(vm, &snapshot) && snapshot.reader.offset == snapshot.reader.length;
+  }
+
+  if (loaded) {
+    vm->root_file = root_file;
+    vm->current_frame = &vm->frames[vm->frame_count - 1];
+
+    // resume as the native function that saved the snapshot returning true.
+    vm->stack_top[-1] = TRUE_VAL;
+  } else {
+    if (error[0] == '\0') {
+      snprintf(error, error_size, "%s is not a valid snapshot", file);
+    }
+    free(root_file);
+  }
+
+  free(is_extern);
+  free_externs(&externs);
+  free(snapshot.objects);
+  free((void *) snapshot.reader.bytes);
+  return loaded;
+}
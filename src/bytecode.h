@@ -0,0 +1,43 @@
+#ifndef BLADE_BYTECODE_H
+#define BLADE_BYTECODE_H
+
+#include "common.h"
+#include "object.h"
+
+/**
+ * compiled modules are cached on disk so that imports can skip the scanner
+ * and the compiler when their source has not changed since the last run.
+ *
+ * cache files live in the directory named by the BLADE_CACHE_DIR
+ * environment variable or in the user's cache directory otherwise, and are
+ * only used when the source path, modification time, size and the BVM
+ * version recorded in them all match.
+ *
+ * the standard library is also compiled into a single image at build time
+ * (libs.bbi next to the executable) which is checked before the cache.
+ */
+
+// returns the function compiled for the module's file or NULL when the
+// cache has no fresh copy of it.
+b_obj_func *load_bytecode(b_vm *vm, b_obj_module *module);
+
+// caches the function compiled for its module's file.
+bool save_bytecode(b_vm *vm, b_obj_func *function);
+
+// compiles the file, or every module in the directory, at path and the
+// modules they import into the cache on the given number of threads.
+// returns the number of modules that could not be compiled.
+int compile_bytecode(b_vm *vm, const char *path, int jobs);
+
+// compiles the given files of a library directory into a single image.
+bool save_bytecode_image(b_vm *vm, const char *image_file, const char *directory, char **files, int count);
+
+// saves the vm as it will be when the native function called with
+// arg_count arguments returns to the script that called it.
+bool save_snapshot(b_vm *vm, const char *file, int arg_count, char *error, int error_size);
+
+// restores a snapshot into a new vm so that running the vm resumes the
+// script with the native function that saved it returning true.
+bool load_snapshot(b_vm *vm, const char *file, char *error, int error_size);
+
+#endif
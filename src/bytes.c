@@ -42,6 +42,7 @@ DECLARE_BYTES_METHOD(append) {
 
     // append here...
     b_obj_bytes *bytes = AS_BYTES(METHOD_OBJECT);
+    unshare_bytes(vm, bytes);
     int old_count = bytes->bytes.count;
     bytes->bytes.count++;
     bytes->bytes.bytes = GROW_ARRAY(unsigned char, bytes->bytes.bytes, old_count,
@@ -53,6 +54,7 @@ DECLARE_BYTES_METHOD(append) {
     if (list->items.count > 0) {
       // append here...
       b_obj_bytes *bytes = AS_BYTES(METHOD_OBJECT);
+      unshare_bytes(vm, bytes);
       bytes->bytes.bytes =
           GROW_ARRAY(unsigned char, bytes->bytes.bytes, bytes->bytes.count,
                      (size_t) bytes->bytes.count + (size_t) list->items.count);
@@ -97,6 +99,7 @@ DECLARE_BYTES_METHOD(extend) {
   b_obj_bytes *bytes = AS_BYTES(METHOD_OBJECT);
   b_obj_bytes *n_bytes = AS_BYTES(args[0]);
 
+  unshare_bytes(vm, bytes);
   bytes->bytes.bytes = GROW_ARRAY(unsigned char, bytes->bytes.bytes, bytes->bytes.count,
                                   bytes->bytes.count + n_bytes->bytes.count);
   if(bytes->bytes.bytes == NULL) {
@@ -164,6 +167,7 @@ DECLARE_BYTES_METHOD(remove) {
   }
 
   unsigned char val = bytes->bytes.bytes[index];
+  unshare_bytes(vm, bytes);
 
   for (int i = index; i < bytes->bytes.count; i++) {
     bytes->bytes.bytes[i] = bytes->bytes.bytes[i + 1];
@@ -190,7 +194,8 @@ DECLARE_BYTES_METHOD(split) {
   ENFORCE_ARG_COUNT(split, 1);
   ENFORCE_ARG_TYPE(split, 0, IS_BYTES);
 
-  b_byte_arr object = AS_BYTES(METHOD_OBJECT)->bytes;
+  b_obj_bytes *source = AS_BYTES(METHOD_OBJECT);
+  b_byte_arr object = source->bytes;
   b_byte_arr delimeter = AS_BYTES(args[0])->bytes;
 
   if (object.count == 0 || delimeter.count > object.count) RETURN_OBJ(new_list(vm));
@@ -202,9 +207,9 @@ DECLARE_BYTES_METHOD(split) {
     int start = 0;
     for(int i = 0; i <= object.count; i++) {
       // match found.
-      if(memcmp(object.bytes + i, delimeter.bytes, delimeter.count) == 0 || i == object.count) {
-        b_obj_bytes *bytes = (b_obj_bytes *)GC(new_bytes(vm, i - start));
-        memcpy(bytes->bytes.bytes, object.bytes + start, i - start);
+      if(i == object.count || (object.bytes[i] == delimeter.bytes[0] && i + delimeter.count <= object.count &&
+          memcmp(object.bytes + i, delimeter.bytes, delimeter.count) == 0)) {
+        b_obj_bytes *bytes = (b_obj_bytes *)GC(slice_bytes(vm, source, start, i - start));
         write_list(vm, list, OBJ_VAL(bytes));
         i += delimeter.count - 1;
         start = i + 1;
@@ -321,7 +326,13 @@ DECLARE_BYTES_METHOD(is_space) {
 DECLARE_BYTES_METHOD(dispose) {
   ENFORCE_ARG_COUNT(dispose, 0);
   b_obj_bytes *bytes = AS_BYTES(METHOD_OBJECT);
-  free_byte_arr(vm, &bytes->bytes);
+  if (bytes->owner == NULL) {
+    free_byte_arr(vm, &bytes->bytes);
+  } else {
+    // views only let go of the shared buffer.
+    init_byte_arr(&bytes->bytes, 0);
+    bytes->owner = NULL;
+  }
   RETURN;
 }
 
@@ -60,6 +60,11 @@
 #  define B_COMPUTED_GOTO_SUPPORTED 0
 #endif
 
+// Baseline JIT (see jit.h), configured with BLADE_JIT and only for x86-64 Linux
+#if defined(BLADE_JIT) && defined(__x86_64__) && defined(__linux__) && USE_NAN_BOXING
+#  define B_JIT 1
+#endif
+
 // --> debug mode options starts here...
 #if DEBUG_MODE == 1
 # define DEBUG_PRINT_CODE 1
@@ -1,4 +1,5 @@
 #include "compiler.h"
+#include "bytecode.h"
 #include "common.h"
 #include "config.h"
 #include "memory.h"
@@ -108,6 +109,12 @@ static bool check_number(b_parser* p) {
 
 static bool check(b_parser* p, b_tkn_type t) { return p->current.type == t; }
 
+// returns the token after the current one without consuming either.
+static b_token peek_token(b_parser* p) {
+  b_scanner scanner = *p->scanner;
+  return scan_token(&scanner);
+}
+
 static bool match(b_parser* p, b_tkn_type t) {
   if (!check(p, t))
     return false;
@@ -136,8 +143,8 @@ static void ignore_whitespace(b_parser* p) {
   while (match(p, NEWLINE_TOKEN));
 }
 
-static int get_code_args_count(const uint8_t* bytecode,
-                               const b_value* constants, int ip) {
+int get_code_args_count(const uint8_t* bytecode,
+                        const b_value* constants, int ip) {
   b_code code = (b_code)bytecode[ip];
 
   switch (code) {
@@ -185,6 +192,7 @@ static int get_code_args_count(const uint8_t* bytecode,
       return 0;
 
     case OP_CALL:
+    case OP_CONCAT:
     case OP_SUPER_INVOKE_SELF:
     case OP_GET_INDEX:
     case OP_GET_RANGED_INDEX:
@@ -210,6 +218,7 @@ static int get_code_args_count(const uint8_t* bytecode,
     case OP_LIST:
     case OP_DICT:
     case OP_CALL_IMPORT:
+    case OP_LAZY_IMPORT:
     case OP_NATIVE_MODULE:
     case OP_SELECT_NATIVE_IMPORT:
     case OP_SWITCH:
@@ -1025,7 +1034,7 @@ static b_value compile_number(b_parser* p) {
     long value = strtol(p->previous.start, NULL, 16);
     return NUMBER_VAL(value);
   } else {
-    double value = strtod(p->previous.start, NULL);
+    double value = parse_number(p->previous.start, p->previous.length);
     return NUMBER_VAL(value);
   }
 }
@@ -1173,36 +1182,38 @@ static void string(b_parser* p, bool can_assign) {
   emit_constant(p, OBJ_VAL(take_string(p->vm, str, length)));
 }
 
+// the parts of an interpolated string are joined by a single OP_CONCAT
+// unless there are more of them than its operand can count.
+static int interpolation_part(b_parser* p, int count) {
+  if (++count == UINT8_MAX) {
+    emit_bytes(p, OP_CONCAT, count);
+    count = 1;
+  }
+  return count;
+}
+
 static void string_interpolation(b_parser* p, bool can_assign) {
   int count = 0;
   do {
-    bool do_add = false;
-    bool string_matched = false;
-
     if (p->previous.length - 2 > 0) {
       string(p, can_assign);
-      do_add = true;
-      string_matched = true;
-
-      if (count > 0) {
-        emit_byte(p, OP_ADD);
-      }
+      count = interpolation_part(p, count);
     }
 
     expression(p);
     emit_byte(p, OP_STRINGIFY);
-
-    if (do_add || (count >= 1 && string_matched == false)) {
-      emit_byte(p, OP_ADD);
-    }
-    count++;
+    count = interpolation_part(p, count);
   } while (match(p, INTERPOLATION_TOKEN));
 
   consume(p, LITERAL_TOKEN, "unterminated string interpolation");
 
   if (p->previous.length - 2 > 0) {
     string(p, can_assign);
-    emit_byte(p, OP_ADD);
+    count = interpolation_part(p, count);
+  }
+
+  if (count > 1) {
+    emit_bytes(p, OP_CONCAT, count);
   }
 }
 
@@ -2231,6 +2242,18 @@ static void import_statement(b_parser* p) {
 
   int part_count = 0;
 
+  // `lazy` is only a modifier when another module path follows it so that
+  // modules named lazy can still be imported.
+  bool is_lazy = false;
+  if (check(p, IDENTIFIER_TOKEN) && p->current.length == 4 && memcmp(p->current.start, "lazy", 4) == 0) {
+    b_token next = peek_token(p);
+    if (next.type == IDENTIFIER_TOKEN ||
+        ((next.type == DOT_TOKEN || next.type == RANGE_TOKEN) && next.start > p->current.start + 4)) {
+      advance(p);
+      is_lazy = true;
+    }
+  }
+
   bool is_relative = match(p, DOT_TOKEN);
 
   // allow for import starting with ..
@@ -2300,7 +2323,7 @@ static void import_statement(b_parser* p) {
     was_renamed = true;
   }
 
-  char* module_path = resolve_import_path(module_file, p->module->file, p->vm->root_file, is_relative);
+  char* module_path = resolve_import_path(p->vm, module_file, p->module->file, p->vm->root_file, is_relative);
 
   if (module_path == NULL) {
     // check if there is one in the vm's registry
@@ -2325,16 +2348,13 @@ static void import_statement(b_parser* p) {
     return;
   }
 
-  if (!check(p, LBRACE_TOKEN)) {
-    consume_statement_end(p);
+  if (is_lazy && check(p, LBRACE_TOKEN)) {
+    error(p, "selective import on lazy module");
+    return;
   }
 
-  // do the import here...
-  char* source = read_file(module_path);
-  if (source == NULL) {
-    error(p, "could not read import file %s", module_path);
-    free(module_file);
-    return;
+  if (!check(p, LBRACE_TOKEN)) {
+    consume_statement_end(p);
   }
 
   // prevent cyclic imports
@@ -2352,16 +2372,46 @@ static void import_statement(b_parser* p) {
   }
 
   b_obj_module* module = new_module(p->vm, module_name, module_path, p->module);
+  module->import_file = module_file;
+  module->import_is_relative = is_relative;
+
+  // lazy modules are compiled and run by the vm when first used.
+  if (is_lazy) {
+    module->is_lazy = true;
+    push(p->vm, OBJ_VAL(module));
+    emit_byte_and_short(p, OP_LAZY_IMPORT, make_constant(p, OBJ_VAL(module)));
+    pop(p->vm);
+    return;
+  }
 
   push(p->vm, OBJ_VAL(module));
-  b_obj_func* function = compile(p->vm, module, source);
-  pop(p->vm);
 
-  free(source);
+  b_obj_func* function = NULL;
+  if (p->vm->use_bytecode_cache) {
+    function = load_bytecode(p->vm, module);
+  }
+
+  if (function == NULL) {
+    // do the import here...
+    char* source = read_file(module_path);
+    if (source == NULL) {
+      pop(p->vm);
+      error(p, "could not read import file %s", module_path);
+      return;
+    }
+
+    function = compile(p->vm, module, source);
+    free(source);
+
+    if (function != NULL && p->vm->use_bytecode_cache) {
+      save_bytecode(p->vm, function);
+    }
+  }
+
+  pop(p->vm);
 
   if (function == NULL) {
     error(p, "failed to import %s", module_name);
-    free(module_file);
     return;
   }
 
@@ -2383,7 +2433,6 @@ static void import_statement(b_parser* p) {
   register_module__FILE__(p->vm, module);
 
   parse_specific_import(p, module_name, import_constant, was_renamed, false);
-  free(module_file);
 
   if (p->vm->compiler->scope_depth > 0) {
     emit_byte(p, OP_POP);
@@ -88,6 +88,9 @@ typedef struct {
 
 b_obj_func *compile(b_vm *vm, b_obj_module *module, const char *source);
 
+// the number of operand bytes of the instruction at ip.
+int get_code_args_count(const uint8_t *bytecode, const b_value *constants, int ip);
+
 void mark_compiler_roots(b_vm *vm);
 
 #endif
\ No newline at end of file
@@ -4,11 +4,30 @@
 
 #include <stdio.h>
 
+static int disassemble_code(b_blob *blob, int offset);
+
+static void print_line(int offset, int line, bool same_line) {
+  printf("%08d ", offset);
+  if (same_line) {
+    printf(" |       ");
+  } else {
+    printf(" %-8d", line);
+  }
+}
+
 void disassemble_blob(b_blob *blob, const char *name) {
   printf("== %s ==\n", name);
 
+  // the line table is read once along with the code instead of from its
+  // start for every instruction.
+  b_blob_lines lines;
+  init_blob_lines(&lines);
+
   for (int offset = 0; offset < blob->count;) {
-    offset = disassemble_instruction(blob, offset);
+    int previous_line = offset > 0 ? next_blob_line(blob, &lines, offset - 1) : 0;
+    int line = next_blob_line(blob, &lines, offset);
+    print_line(offset, line, offset > 0 && line == previous_line);
+    offset = disassemble_code(blob, offset);
   }
 }
 
@@ -67,13 +86,12 @@ static int invoke_instruction(const char *name, b_blob *blob, int offset) {
 }
 
 int disassemble_instruction(b_blob *blob, int offset) {
-  printf("%08d ", offset);
-  if (offset > 0 && blob->lines[offset] == blob->lines[offset - 1]) {
-    printf(" |       ");
-  } else {
-    printf(" %-8d", blob->lines[offset]);
-  }
+  int line = get_blob_line(blob, offset);
+  print_line(offset, line, offset > 0 && line == get_blob_line(blob, offset - 1));
+  return disassemble_code(blob, offset);
+}
 
+static int disassemble_code(b_blob *blob, int offset) {
   uint8_t instruction = blob->code[offset];
   switch (instruction) {
     case OP_JUMP_IF_FALSE:
@@ -167,6 +185,8 @@ int disassemble_instruction(b_blob *blob, int offset) {
 
     case OP_CALL_IMPORT:
       return short_instruction("cimport", blob, offset);
+    case OP_LAZY_IMPORT:
+      return short_instruction("limport", blob, offset);
     case OP_NATIVE_MODULE:
       return short_instruction("nimport", blob, offset);
     case OP_SELECT_IMPORT:
@@ -186,6 +206,8 @@ int disassemble_instruction(b_blob *blob, int offset) {
       return simple_instruction("echo", offset);
     case OP_STRINGIFY:
       return simple_instruction("str", offset);
+    case OP_CONCAT:
+      return byte_instruction("concat", blob, offset);
     case OP_CHOICE:
       return simple_instruction("cho", offset);
     case OP_RAISE:
@@ -0,0 +1,700 @@
+#include "jit.h"
+
+#if defined(B_JIT)
+
+#include "compiler.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+/**
+ * a baseline JIT that translates the bytecode of hot functions to x86-64
+ * machine code, one template per instruction.
+ *
+ * the machine code works on the VM stack the way run() does, so that the
+ * VM is in the same state at every instruction boundary in both. while it
+ * runs, rbx holds the stack top, r12 the VM, r13 the slots of the frame,
+ * r14 the frame and r15 QNAN.
+ *
+ * simple instructions are written out in full for numbers and other
+ * common operands, and a few others call a helper below for their common
+ * case. anything else, including an instruction whose operands fail those
+ * checks, leaves the machine code with the frame's ip pointing at it so
+ * that run() carries on from there. that's also how calls, returns and
+ * exceptions are handled. run() goes back into the machine code at the
+ * next loop, call or return.
+ */
+
+typedef void (*b_jit_entry)(b_vm *vm, b_call_frame *frame, uint8_t *target);
+
+// the helpers take the top of the stack and the instruction and return
+// false to leave it to the interpreter.
+typedef bool (*b_jit_helper)(b_vm *vm, b_call_frame *frame, b_value *top, uint8_t *ip);
+
+struct s_jit_code {
+  uint8_t *code;
+  size_t size;
+  uint32_t *entries; // the machine code offset of every instruction or 0.
+};
+
+typedef enum {
+  RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI,
+  R8, R9, R10, R11, R12, R13, R14, R15,
+} b_jit_register;
+
+typedef enum {
+  CC_ALWAYS = 0,
+  CC_E = 0x84,
+  CC_NE = 0x85,
+} b_jit_condition;
+
+typedef enum {
+  PATCH_LABEL, // the start of the instruction at target
+  PATCH_EXIT, // an exit to the interpreter at the instruction at target
+  PATCH_LOCAL, // a jump within the instruction being written
+} b_jit_patch_kind;
+
+typedef struct {
+  size_t at;
+  int target;
+  b_jit_patch_kind kind;
+} b_jit_patch;
+
+typedef struct {
+  uint8_t *bytes;
+  size_t count;
+  size_t capacity;
+  b_jit_patch *patches;
+  int patch_count;
+  int patch_capacity;
+  bool failed;
+} b_jit_buffer;
+
+static void emit_bytes(b_jit_buffer *buffer, const void *bytes, size_t length) {
+  if (buffer->count + length > buffer->capacity) {
+    size_t capacity = buffer->capacity < 256 ? 256 : buffer->capacity * 2;
+    while (capacity < buffer->count + length) capacity *= 2;
+
+    uint8_t *grown = realloc(buffer->bytes, capacity);
+    if (grown == NULL) {
+      buffer->failed = true;
+      return;
+    }
+    buffer->bytes = grown;
+    buffer->capacity = capacity;
+  }
+
+  memcpy(buffer->bytes + buffer->count, bytes, length);
+  buffer->count += length;
+}
+
+static inline void emit_byte(b_jit_buffer *buffer, uint8_t byte) {
+  emit_bytes(buffer, &byte, 1);
+}
+
+static inline void emit_u32(b_jit_buffer *buffer, uint32_t value) {
+  emit_bytes(buffer, &value, 4);
+}
+
+static inline void emit_u64(b_jit_buffer *buffer, uint64_t value) {
+  emit_bytes(buffer, &value, 8);
+}
+
+static inline void emit_rex(b_jit_buffer *buffer, int reg, int rm) {
+  emit_byte(buffer, 0x48 | ((reg >> 3) << 2) | (rm >> 3));
+}
+
+static inline void emit_modrm(b_jit_buffer *buffer, int mod, int reg, int rm) {
+  emit_byte(buffer, (mod << 6) | ((reg & 7) << 3) | (rm & 7));
+}
+
+// mov reg, value
+static void emit_mov_imm(b_jit_buffer *buffer, int reg, uint64_t value) {
+  emit_byte(buffer, 0x48 | (reg >> 3));
+  emit_byte(buffer, 0xb8 + (reg & 7));
+  emit_u64(buffer, value);
+}
+
+// op rm, reg for the two register forms of add (0x01), and (0x21),
+// sub (0x29), xor (0x31), cmp (0x39) and mov (0x89).
+static void emit_op(b_jit_buffer *buffer, uint8_t op, int rm, int reg) {
+  emit_rex(buffer, reg, rm);
+  emit_byte(buffer, op);
+  emit_modrm(buffer, 3, reg, rm);
+}
+
+// mov (0x8b) reg, [base + disp] or mov (0x89) [base + disp], reg
+static void emit_memory(b_jit_buffer *buffer, uint8_t op, int reg, int base, int32_t disp) {
+  emit_rex(buffer, reg, base);
+  emit_byte(buffer, op);
+  emit_modrm(buffer, 2, reg, base);
+  if ((base & 7) == RSP) {
+    emit_byte(buffer, 0x24);
+  }
+  emit_u32(buffer, (uint32_t) disp);
+}
+
+static inline void emit_load(b_jit_buffer *buffer, int reg, int base, int32_t disp) {
+  emit_memory(buffer, 0x8b, reg, base, disp);
+}
+
+static inline void emit_store(b_jit_buffer *buffer, int base, int32_t disp, int reg) {
+  emit_memory(buffer, 0x89, reg, base, disp);
+}
+
+// add reg, value
+static void emit_add_imm(b_jit_buffer *buffer, int reg, int32_t value) {
+  emit_rex(buffer, 0, reg);
+  emit_byte(buffer, 0x81);
+  emit_modrm(buffer, 3, 0, reg);
+  emit_u32(buffer, (uint32_t) value);
+}
+
+static void emit_call(b_jit_buffer *buffer, void *function) {
+  emit_mov_imm(buffer, RAX, (uint64_t) (uintptr_t) function);
+  emit_bytes(buffer, "\xff\xd0", 2); // call rax
+}
+
+static void emit_jump(b_jit_buffer *buffer, b_jit_condition condition, b_jit_patch_kind kind, int target) {
+  if (condition == CC_ALWAYS) {
+    emit_byte(buffer, 0xe9);
+  } else {
+    emit_byte(buffer, 0x0f);
+    emit_byte(buffer, condition);
+  }
+
+  if (buffer->patch_count == buffer->patch_capacity) {
+    int capacity = buffer->patch_capacity < 16 ? 16 : buffer->patch_capacity * 2;
+    b_jit_patch *grown = realloc(buffer->patches, capacity * sizeof(b_jit_patch));
+    if (grown == NULL) {
+      buffer->failed = true;
+      return;
+    }
+    buffer->patches = grown;
+    buffer->patch_capacity = capacity;
+  }
+
+  b_jit_patch *patch = &buffer->patches[buffer->patch_count++];
+  patch->at = buffer->count;
+  patch->target = target;
+  patch->kind = kind;
+  emit_u32(buffer, 0);
+}
+
+// points the local jumps written since patch first at the end of the buffer.
+static void patch_local_jumps(b_jit_buffer *buffer, int first) {
+  for (int i = first; i < buffer->patch_count && !buffer->failed; i++) {
+    b_jit_patch *patch = &buffer->patches[i];
+    if (patch->kind == PATCH_LOCAL) {
+      uint32_t offset = (uint32_t) (buffer->count - (patch->at + 4));
+      memcpy(buffer->bytes + patch->at, &offset, 4);
+      patch->target = -1;
+    }
+  }
+}
+
+static inline void emit_push(b_jit_buffer *buffer, int reg) {
+  emit_store(buffer, RBX, 0, reg);
+  emit_add_imm(buffer, RBX, sizeof(b_value));
+}
+
+// leaves for the interpreter at ip unless reg holds a number.
+static void emit_number_check(b_jit_buffer *buffer, int reg, int ip) {
+  emit_op(buffer, 0x89, RDX, reg);
+  emit_op(buffer, 0x21, RDX, R15);
+  emit_op(buffer, 0x39, RDX, R15);
+  emit_jump(buffer, CC_E, PATCH_EXIT, ip);
+}
+
+// loads the two operands of a binary op into rax and rcx and their
+// numbers into xmm0 and xmm1.
+static void emit_number_operands(b_jit_buffer *buffer, int ip) {
+  emit_load(buffer, RAX, RBX, -16);
+  emit_load(buffer, RCX, RBX, -8);
+  emit_number_check(buffer, RAX, ip);
+  emit_number_check(buffer, RCX, ip);
+  emit_bytes(buffer, "\x66\x48\x0f\x6e\xc0", 5); // movq xmm0, rax
+  emit_bytes(buffer, "\x66\x48\x0f\x6e\xc9", 5); // movq xmm1, rcx
+}
+
+// replaces the two operands of a binary op with the number in xmm0.
+static void emit_number_result(b_jit_buffer *buffer) {
+  emit_bytes(buffer, "\x66\x48\x0f\x7e\xc0", 5); // movq rax, xmm0
+  emit_store(buffer, RBX, -16, RAX);
+  emit_add_imm(buffer, RBX, -(int32_t) sizeof(b_value));
+}
+
+// turns al into a boolean in rax.
+static void emit_bool_result(b_jit_buffer *buffer) {
+  emit_bytes(buffer, "\x0f\xb6\xc0", 3); // movzx eax, al
+  emit_mov_imm(buffer, RCX, FALSE_VAL);
+  emit_op(buffer, 0x01, RAX, RCX);
+}
+
+static void emit_helper(b_jit_buffer *buffer, b_jit_helper helper, uint8_t *code, int ip, int stack_effect) {
+  // the helper may allocate, so the GC needs to see the whole stack.
+  emit_store(buffer, R12, offsetof(b_vm, stack_top), RBX);
+  emit_op(buffer, 0x89, RDI, R12);
+  emit_op(buffer, 0x89, RSI, R14);
+  emit_op(buffer, 0x89, RDX, RBX);
+  emit_mov_imm(buffer, RCX, (uint64_t) (uintptr_t) (code + ip));
+  emit_call(buffer, (void *) helper);
+  emit_bytes(buffer, "\x84\xc0", 2); // test al, al
+  emit_jump(buffer, CC_E, PATCH_EXIT, ip);
+  if (stack_effect != 0) {
+    emit_add_imm(buffer, RBX, stack_effect * (int32_t) sizeof(b_value));
+  }
+}
+
+static inline uint16_t read_short(uint8_t *code, int ip) {
+  return (uint16_t) ((code[ip + 1] << 8) | code[ip + 2]);
+}
+
+static bool jit_get_global(b_vm *vm, b_call_frame *frame, b_value *top, uint8_t *ip) {
+  b_value name = frame->closure->function->blob.constants.values[read_short(ip, 0)];
+  return table_get(&frame->closure->function->module->values, name, top) ||
+         table_get(&vm->globals, name, top);
+}
+
+static bool jit_set_global(b_vm *vm, b_call_frame *frame, b_value *top, uint8_t *ip) {
+  b_value name = frame->closure->function->blob.constants.values[read_short(ip, 0)];
+  b_table *table = &frame->closure->function->module->values;
+  b_value value;
+
+  if (IS_EMPTY(top[-1]) || !table_get(table, name, &value)) {
+    return false;
+  }
+
+  table_set(vm, table, name, top[-1]);
+  return true;
+}
+
+static bool jit_get_property(b_vm *vm, b_call_frame *frame, b_value *top, uint8_t *ip) {
+  b_value name = frame->closure->function->blob.constants.values[read_short(ip, 0)];
+  if (!IS_INSTANCE(top[-1])) {
+    return false;
+  }
+
+  b_value value;
+  if (!table_get(&AS_INSTANCE(top[-1])->properties, name, &value) ||
+      (ip[0] == OP_GET_PROPERTY && AS_STRING(name)->length > 0 && AS_STRING(name)->chars[0] == '_')) {
+    return false;
+  }
+
+  top[-1] = value;
+  return true;
+}
+
+static bool jit_set_property(b_vm *vm, b_call_frame *frame, b_value *top, uint8_t *ip) {
+  b_value name = frame->closure->function->blob.constants.values[read_short(ip, 0)];
+  if (!IS_INSTANCE(top[-2]) || IS_EMPTY(top[-1])) {
+    return false;
+  }
+
+  table_set(vm, &AS_INSTANCE(top[-2])->properties, name, top[-1]);
+  top[-2] = top[-1];
+  return true;
+}
+
+static bool jit_get_index(b_vm *vm, b_call_frame *frame, b_value *top, uint8_t *ip) {
+  if (!IS_LIST(top[-2]) || !IS_NUMBER(top[-1])) {
+    return false;
+  }
+
+  b_obj_list *list = AS_LIST(top[-2]);
+  int index = AS_NUMBER(top[-1]);
+  if (index < 0) {
+    index += list->items.count;
+  }
+  if (index < 0 || index >= list->items.count) {
+    return false;
+  }
+
+  if (ip[1] == 1) { // will assign, keep the list and index
+    top[0] = list->items.values[index];
+  } else {
+    top[-2] = list->items.values[index];
+  }
+  return true;
+}
+
+static bool jit_set_index(b_vm *vm, b_call_frame *frame, b_value *top, uint8_t *ip) {
+  if (!IS_LIST(top[-3]) || !IS_NUMBER(top[-2]) || IS_EMPTY(top[-1])) {
+    return false;
+  }
+
+  b_obj_list *list = AS_LIST(top[-3]);
+  int index = AS_NUMBER(top[-2]);
+  if (index < 0) {
+    index += list->items.count;
+  }
+  if (index < 0 || index >= list->items.count) {
+    return false;
+  }
+
+  list->items.values[index] = top[-1];
+  top[-3] = top[-1];
+  return true;
+}
+
+static bool jit_equal(b_vm *vm, b_call_frame *frame, b_value *top, uint8_t *ip) {
+  // instances may overload =
+  if (IS_INSTANCE(top[-2])) {
+    return false;
+  }
+
+  top[-2] = BOOL_VAL(values_equal(top[-2], top[-1]));
+  return true;
+}
+
+static void emit_prologue(b_jit_buffer *buffer) {
+  emit_bytes(buffer, "\x55\x53\x41\x54\x41\x55\x41\x56\x41\x57", 10); // push rbp, rbx, r12-r15
+  emit_bytes(buffer, "\x48\x83\xec\x08", 4); // sub rsp, 8
+  emit_op(buffer, 0x89, R12, RDI);
+  emit_op(buffer, 0x89, R14, RSI);
+  emit_load(buffer, RBX, R12, offsetof(b_vm, stack_top));
+  emit_load(buffer, R13, R14, offsetof(b_call_frame, slots));
+  emit_mov_imm(buffer, R15, QNAN);
+  emit_bytes(buffer, "\xff\xe2", 2); // jmp rdx
+}
+
+// leaves the machine code for the instruction at code + eax.
+static void emit_exit(b_jit_buffer *buffer, uint8_t *code) {
+  emit_mov_imm(buffer, RCX, (uint64_t) (uintptr_t) code);
+  emit_op(buffer, 0x01, RAX, RCX);
+  emit_store(buffer, R14, offsetof(b_call_frame, ip), RAX);
+  emit_store(buffer, R12, offsetof(b_vm, stack_top), RBX);
+  emit_bytes(buffer, "\x48\x83\xc4\x08", 4); // add rsp, 8
+  emit_bytes(buffer, "\x41\x5f\x41\x5e\x41\x5d\x41\x5c\x5b\x5d\xc3", 11); // pop r15-r12, rbx, rbp; ret
+}
+
+/**
+ * writes the machine code of the instruction at ip and returns false if
+ * the instruction is left to the interpreter.
+ */
+static bool emit_instruction(b_jit_buffer *buffer, b_obj_func *function, int ip) {
+  uint8_t *code = function->blob.code;
+  b_value *constants = function->blob.constants.values;
+
+  switch (code[ip]) {
+    case OP_GET_LOCAL:
+      emit_load(buffer, RAX, R13, read_short(code, ip) * (int32_t) sizeof(b_value));
+      emit_push(buffer, RAX);
+      return true;
+    case OP_SET_LOCAL:
+      emit_load(buffer, RAX, RBX, -8);
+      emit_mov_imm(buffer, RCX, EMPTY_VAL);
+      emit_op(buffer, 0x39, RAX, RCX);
+      emit_jump(buffer, CC_E, PATCH_EXIT, ip);
+      emit_store(buffer, R13, read_short(code, ip) * (int32_t) sizeof(b_value), RAX);
+      return true;
+
+    case OP_GET_UP_VALUE:
+    case OP_SET_UP_VALUE:
+      emit_load(buffer, RDX, R14, offsetof(b_call_frame, closure));
+      emit_load(buffer, RDX, RDX, offsetof(b_obj_closure, up_values));
+      emit_load(buffer, RDX, RDX, read_short(code, ip) * (int32_t) sizeof(b_obj_up_value *));
+      emit_load(buffer, RDX, RDX, offsetof(b_obj_up_value, location));
+      if (code[ip] == OP_GET_UP_VALUE) {
+        emit_load(buffer, RAX, RDX, 0);
+        emit_push(buffer, RAX);
+      } else {
+        emit_load(buffer, RAX, RBX, -8);
+        emit_mov_imm(buffer, RCX, EMPTY_VAL);
+        emit_op(buffer, 0x39, RAX, RCX);
+        emit_jump(buffer, CC_E, PATCH_EXIT, ip);
+        emit_store(buffer, RDX, 0, RAX);
+      }
+      return true;
+
+    case OP_GET_GLOBAL:
+      emit_helper(buffer, jit_get_global, code, ip, 1);
+      return true;
+    case OP_SET_GLOBAL:
+      emit_helper(buffer, jit_set_global, code, ip, 0);
+      return true;
+    case OP_GET_PROPERTY:
+    case OP_GET_SELF_PROPERTY:
+      emit_helper(buffer, jit_get_property, code, ip, 0);
+      return true;
+    case OP_SET_PROPERTY:
+      emit_helper(buffer, jit_set_property, code, ip, -1);
+      return true;
+    case OP_GET_INDEX:
+      emit_helper(buffer, jit_get_index, code, ip, code[ip + 1] == 1 ? 1 : -1);
+      return true;
+    case OP_SET_INDEX:
+      emit_helper(buffer, jit_set_index, code, ip, -2);
+      return true;
+
+    case OP_CONSTANT:
+    case OP_NIL:
+    case OP_TRUE:
+    case OP_FALSE:
+    case OP_EMPTY:
+    case OP_ONE: {
+      b_value value = code[ip] == OP_CONSTANT ? constants[read_short(code, ip)]
+          : code[ip] == OP_NIL ? NIL_VAL
+          : code[ip] == OP_TRUE ? TRUE_VAL
+          : code[ip] == OP_FALSE ? FALSE_VAL
+          : code[ip] == OP_EMPTY ? EMPTY_VAL
+          : NUMBER_VAL(1);
+      emit_mov_imm(buffer, RAX, value);
+      emit_push(buffer, RAX);
+      return true;
+    }
+
+    case OP_POP:
+      emit_add_imm(buffer, RBX, -(int32_t) sizeof(b_value));
+      return true;
+    case OP_POP_N:
+      emit_add_imm(buffer, RBX, -read_short(code, ip) * (int32_t) sizeof(b_value));
+      return true;
+    case OP_DUP:
+      emit_load(buffer, RAX, RBX, -8);
+      emit_push(buffer, RAX);
+      return true;
+
+    case OP_JUMP:
+      emit_jump(buffer, CC_ALWAYS, PATCH_LABEL, ip + 3 + read_short(code, ip));
+      return true;
+    case OP_LOOP:
+      emit_jump(buffer, CC_ALWAYS, PATCH_LABEL, ip + 3 - read_short(code, ip));
+      return true;
+    case OP_JUMP_IF_FALSE: {
+      int target = ip + 3 + read_short(code, ip);
+      emit_load(buffer, RAX, RBX, -8);
+      emit_mov_imm(buffer, RCX, FALSE_VAL);
+      emit_op(buffer, 0x39, RAX, RCX);
+      emit_jump(buffer, CC_E, PATCH_LABEL, target);
+      emit_mov_imm(buffer, RCX, TRUE_VAL);
+      emit_op(buffer, 0x39, RAX, RCX);
+      emit_jump(buffer, CC_E, PATCH_LABEL, ip + 3);
+      emit_op(buffer, 0x89, RDI, RAX);
+      emit_call(buffer, (void *) is_false);
+      emit_bytes(buffer, "\x84\xc0", 2); // test al, al
+      emit_jump(buffer, CC_NE, PATCH_LABEL, target);
+      return true;
+    }
+    case OP_NOT:
+      emit_load(buffer, RDI, RBX, -8);
+      emit_call(buffer, (void *) is_false);
+      emit_bool_result(buffer);
+      emit_store(buffer, RBX, -8, RAX);
+      return true;
+
+    case OP_ADD:
+    case OP_SUBTRACT:
+    case OP_MULTIPLY:
+    case OP_DIVIDE:
+      emit_number_operands(buffer, ip);
+      switch (code[ip]) {
+        case OP_ADD: emit_bytes(buffer, "\xf2\x0f\x58\xc1", 4); break; // addsd xmm0, xmm1
+        case OP_SUBTRACT: emit_bytes(buffer, "\xf2\x0f\x5c\xc1", 4); break; // subsd xmm0, xmm1
+        case OP_MULTIPLY: emit_bytes(buffer, "\xf2\x0f\x59\xc1", 4); break; // mulsd xmm0, xmm1
+        default: emit_bytes(buffer, "\xf2\x0f\x5e\xc1", 4); break; // divsd xmm0, xmm1
+      }
+      emit_number_result(buffer);
+      return true;
+
+    case OP_F_DIVIDE:
+    case OP_REMINDER:
+    case OP_POW:
+    case OP_AND:
+    case OP_OR:
+    case OP_XOR:
+    case OP_LSHIFT:
+    case OP_RSHIFT:
+    case OP_URSHIFT:
+      emit_number_operands(buffer, ip);
+      emit_bytes(buffer, "\xbf", 1); // mov edi, op
+      emit_u32(buffer, code[ip]);
+      emit_call(buffer, (void *) jit_number_op);
+      emit_number_result(buffer);
+      return true;
+
+    case OP_NEGATE:
+      emit_load(buffer, RAX, RBX, -8);
+      emit_number_check(buffer, RAX, ip);
+      emit_mov_imm(buffer, RCX, SIGN_BIT);
+      emit_op(buffer, 0x31, RAX, RCX);
+      emit_store(buffer, RBX, -8, RAX);
+      return true;
+
+    case OP_GREATER:
+    case OP_LESS:
+      emit_number_operands(buffer, ip);
+      if (code[ip] == OP_GREATER) {
+        emit_bytes(buffer, "\x66\x0f\x2e\xc1", 4); // ucomisd xmm0, xmm1
+      } else {
+        emit_bytes(buffer, "\x66\x0f\x2e\xc8", 4); // ucomisd xmm1, xmm0
+      }
+      emit_bytes(buffer, "\x0f\x97\xc0", 3); // seta al
+      emit_bool_result(buffer);
+      emit_store(buffer, RBX, -16, RAX);
+      emit_add_imm(buffer, RBX, -(int32_t) sizeof(b_value));
+      return true;
+
+    case OP_EQUAL: {
+      int first = buffer->patch_count;
+      emit_load(buffer, RAX, RBX, -16);
+      emit_load(buffer, RCX, RBX, -8);
+      emit_op(buffer, 0x89, RDX, RAX);
+      emit_op(buffer, 0x21, RDX, R15);
+      emit_op(buffer, 0x39, RDX, R15);
+      emit_jump(buffer, CC_E, PATCH_LOCAL, 0);
+      emit_op(buffer, 0x89, RDX, RCX);
+      emit_op(buffer, 0x21, RDX, R15);
+      emit_op(buffer, 0x39, RDX, R15);
+      emit_jump(buffer, CC_E, PATCH_LOCAL, 0);
+      emit_bytes(buffer, "\x66\x48\x0f\x6e\xc0", 5); // movq xmm0, rax
+      emit_bytes(buffer, "\x66\x48\x0f\x6e\xc9", 5); // movq xmm1, rcx
+      emit_bytes(buffer, "\x66\x0f\x2e\xc1", 4); // ucomisd xmm0, xmm1
+      emit_bytes(buffer, "\x0f\x94\xc0", 3); // sete al
+      emit_bytes(buffer, "\x0f\x9b\xc1", 3); // setnp cl
+      emit_bytes(buffer, "\x20\xc8", 2); // and al, cl
+      emit_bool_result(buffer);
+      emit_store(buffer, RBX, -16, RAX);
+      emit_add_imm(buffer, RBX, -(int32_t) sizeof(b_value));
+      emit_jump(buffer, CC_ALWAYS, PATCH_LABEL, ip + 1);
+      patch_local_jumps(buffer, first);
+      emit_helper(buffer, jit_equal, code, ip, -1);
+      return true;
+    }
+
+    default:
+      return false;
+  }
+}
+
+static bool write_jit_code(b_jit_buffer *buffer, b_obj_func *function, uint32_t *entries) {
+  uint8_t *code = function->blob.code;
+  int count = function->blob.count;
+
+  emit_prologue(buffer);
+
+  size_t exit = buffer->count;
+  emit_exit(buffer, code);
+
+  for (int ip = 0; ip < count; ip += 1 + get_code_args_count(code, function->blob.constants.values, ip)) {
+    size_t start = buffer->count;
+    if (emit_instruction(buffer, function, ip)) {
+      entries[ip] = (uint32_t) start;
+    } else {
+      emit_byte(buffer, 0xb8); // mov eax, ip
+      emit_u32(buffer, (uint32_t) ip);
+      emit_jump(buffer, CC_ALWAYS, PATCH_EXIT, -1);
+    }
+  }
+
+  // the exits of the instructions, each setting eax to its ip.
+  size_t *exits = calloc(count, sizeof(size_t));
+  if (exits == NULL) {
+    return false;
+  }
+
+  for (int i = 0; i < buffer->patch_count && !buffer->failed; i++) {
+    b_jit_patch *patch = &buffer->patches[i];
+    size_t target;
+
+    if (patch->kind == PATCH_LOCAL) {
+      continue; // already pointed within its instruction
+    } else if (patch->target < 0) {
+      target = exit;
+    } else if (patch->target >= count) {
+      buffer->failed = true;
+      break;
+    } else if (patch->kind == PATCH_LABEL && entries[patch->target] != 0) {
+      target = entries[patch->target];
+    } else {
+      if (exits[patch->target] == 0) {
+        exits[patch->target] = buffer->count;
+        emit_byte(buffer, 0xb8); // mov eax, ip
+        emit_u32(buffer, (uint32_t) patch->target);
+        emit_byte(buffer, 0xe9); // jmp exit
+        emit_u32(buffer, (uint32_t) (exit - (buffer->count + 4)));
+      }
+      target = exits[patch->target];
+    }
+
+    uint32_t offset = (uint32_t) (target - (patch->at + 4));
+    memcpy(buffer->bytes + patch->at, &offset, 4);
+  }
+
+  free(exits);
+  return !buffer->failed;
+}
+
+void jit_compile(b_vm *vm, b_obj_func *function) {
+  int count = function->blob.count;
+  if (function->jit != NULL || count == 0) {
+    return;
+  }
+
+  uint32_t *entries = calloc(count, sizeof(uint32_t));
+  b_jit_buffer buffer = {0};
+
+  if (entries == NULL || !write_jit_code(&buffer, function, entries)) {
+    free(entries);
+    free(buffer.bytes);
+    free(buffer.patches);
+    return;
+  }
+  free(buffer.patches);
+
+  void *memory = mmap(NULL, buffer.count, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    free(entries);
+    free(buffer.bytes);
+    return;
+  }
+
+  memcpy(memory, buffer.bytes, buffer.count);
+  free(buffer.bytes);
+
+  b_jit_code *jit = malloc(sizeof(b_jit_code));
+  if (jit == NULL || mprotect(memory, buffer.count, PROT_READ | PROT_EXEC) != 0) {
+    munmap(memory, buffer.count);
+    free(entries);
+    free(jit);
+    return;
+  }
+
+  jit->code = memory;
+  jit->size = buffer.count;
+  jit->entries = entries;
+
+  // threads share functions, so only one of them installs its code.
+  b_jit_code *expected = NULL;
+  if (!__atomic_compare_exchange_n(&function->jit, &expected, jit, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    munmap(jit->code, jit->size);
+    free(jit->entries);
+    free(jit);
+  }
+}
+
+void jit_resume(b_vm *vm, b_call_frame *frame) {
+  b_obj_func *function = frame->closure->function;
+  b_jit_code *jit = __atomic_load_n(&function->jit, __ATOMIC_ACQUIRE);
+  uint32_t entry = jit->entries[frame->ip - function->blob.code];
+
+  // the machine code does not grow the stack, and it can push at most
+  // one value per byte of code.
+  if (entry == 0 || vm->stack_top - vm->stack + function->blob.count > (ptrdiff_t) vm->stack_capacity) {
+    return;
+  }
+
+  ((b_jit_entry) (void *) jit->code)(vm, frame, jit->code + entry);
+}
+
+void jit_free(b_obj_func *function) {
+  if (function->jit != NULL) {
+    munmap(function->jit->code, function->jit->size);
+    free(function->jit->entries);
+    free(function->jit);
+    function->jit = NULL;
+  }
+}
+
+#endif
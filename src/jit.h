@@ -0,0 +1,38 @@
+#ifndef BLADE_JIT_H
+#define BLADE_JIT_H
+
+#include "common.h"
+
+#if defined(B_JIT)
+
+#include "blob.h"
+#include "object.h"
+#include "vm.h"
+
+// the calls and loop iterations a function runs in the interpreter before
+// it is compiled to machine code.
+#define JIT_THRESHOLD 1000
+
+typedef struct s_jit_code b_jit_code;
+
+/**
+ * compiles function to machine code. functions that fail to compile are
+ * left to the interpreter.
+ */
+void jit_compile(b_vm *vm, b_obj_func *function);
+
+/**
+ * runs the machine code of the function of frame from the frame's ip until
+ * it reaches an instruction that only the interpreter runs, leaving the
+ * frame's ip and the stack for run() to carry on from there.
+ */
+void jit_resume(b_vm *vm, b_call_frame *frame);
+
+void jit_free(b_obj_func *function);
+
+// the result of a numeric op other than + - * / for the machine code.
+double jit_number_op(b_code op, double a, double b);
+
+#endif
+
+#endif
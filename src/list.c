@@ -1,6 +1,7 @@
 #include "list.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 inline void write_list(b_vm *vm, b_obj_list *list, b_value value) {
   push(vm, value);
@@ -131,21 +132,17 @@ DECLARE_LIST_METHOD(shift) {
   } else if (count >= list->items.count) {
     list->items.count = 0;
     RETURN_NIL;
+  } else if (count == 1) {
+    b_value value = list->items.values[0];
+    shift_value_arr(&list->items, 1);
+    RETURN_VALUE(value);
   } else if (count > 0) {
     b_obj_list *n_list = (b_obj_list *) GC(new_list(vm));
     for (int i = 0; i < count; i++) {
-      write_list(vm, n_list, list->items.values[0]);
-      for (int j = 0; j < list->items.count; j++) {
-        list->items.values[j] = list->items.values[j + 1];
-      }
-      list->items.count -= 1;
-    }
-
-    if (count == 1) {
-      RETURN_VALUE(n_list->items.values[0]);
-    } else {
-      RETURN_OBJ(n_list);
+      write_list(vm, n_list, list->items.values[i]);
     }
+    shift_value_arr(&list->items, count);
+    RETURN_OBJ(n_list);
   }
   RETURN_NIL;
 }
@@ -161,10 +158,13 @@ DECLARE_LIST_METHOD(remove_at) {
   }
 
   b_value value = list->items.values[index];
-  for (int i = index; i < list->items.count - 1; i++) {
-    list->items.values[i] = list->items.values[i + 1];
+  if (index == 0) {
+    shift_value_arr(&list->items, 1);
+  } else {
+    memmove(list->items.values + index, list->items.values + index + 1,
+            (list->items.count - index - 1) * sizeof(b_value));
+    list->items.count--;
   }
-  list->items.count--;
   RETURN_VALUE(value);
 }
 
@@ -202,11 +202,71 @@ DECLARE_LIST_METHOD(reverse) {
   RETURN_OBJ(nlist);
 }
 
+typedef struct {
+  b_vm *vm;
+  b_obj_closure *comparator;
+  b_obj_list *args;
+} b_list_comparator;
+
+static bool list_comparator_greater(void *data, b_value a, b_value b) {
+  b_list_comparator *cmp = (b_list_comparator *) data;
+  cmp->args->items.values[0] = a;
+  cmp->args->items.values[1] = b;
+
+  b_value result = call_closure(cmp->vm, cmp->comparator, cmp->args);
+
+  // comparators may either answer a > b or return an ordering number.
+  if (IS_NUMBER(result)) {
+    return AS_NUMBER(result) > 0;
+  }
+  return !is_false(result);
+}
+
 DECLARE_LIST_METHOD(sort) {
-  ENFORCE_ARG_COUNT(sort, 0);
+  ENFORCE_ARG_RANGE(sort, 0, 1);
 
   b_obj_list *list = AS_LIST(METHOD_OBJECT);
-  sort_values(list->items.values, list->items.count);
+
+  if (arg_count == 0 || IS_NIL(args[0])) {
+    sort_values(list->items.values, list->items.count);
+    RETURN_VALUE(METHOD_OBJECT);
+  }
+
+  ENFORCE_ARG_TYPE(sort, 0, IS_CLOSURE);
+
+  int count = list->items.count;
+  if (count < 2) {
+    RETURN_VALUE(METHOD_OBJECT);
+  }
+
+  // The comparator may allocate and trigger a collection, so the values
+  // being sorted and the merge scratch space must stay visible to the GC.
+  // The work list holds both: [values ... | buffer ...].
+  b_obj_list *work = (b_obj_list *) GC(new_list(vm));
+  int buffer_size = count / 2 + 1;
+  for (int i = 0; i < count; i++) {
+    write_value_arr(vm, &work->items, list->items.values[i]);
+  }
+  for (int i = 0; i < buffer_size; i++) {
+    write_value_arr(vm, &work->items, NIL_VAL);
+  }
+
+  b_list_comparator cmp = {
+      .vm = vm,
+      .comparator = AS_CLOSURE(args[0]),
+      .args = (b_obj_list *) GC(new_list(vm)),
+  };
+  write_value_arr(vm, &cmp.args->items, NIL_VAL);
+  write_value_arr(vm, &cmp.args->items, NIL_VAL);
+
+  sort_values_with(work->items.values, count, work->items.values + count,
+                   list_comparator_greater, &cmp);
+
+  if (list->items.count != count) {
+    RETURN_VALUE_ERROR("list modified during sort()");
+  }
+
+  memcpy(list->items.values, work->items.values, count * sizeof(b_value));
   RETURN_VALUE(METHOD_OBJECT);
 }
 
@@ -1,6 +1,7 @@
 #include "memory.h"
 #include "compiler.h"
 #include "config.h"
+#include "jit.h"
 #include "object.h"
 #include "module.h"
 
@@ -213,7 +214,20 @@ void blacken_object(b_vm *vm, b_obj *object) {
       break;
     }
 
-    case OBJ_BYTES:
+    case OBJ_BYTES: {
+      b_obj_bytes *bytes = (b_obj_bytes *) object;
+      if (bytes->owner != NULL) {
+        b_obj_bytes *owner = bytes->owner;
+        if (owner->live_mark != vm->mark_value) {
+          owner->live_mark = vm->mark_value;
+          owner->live_length = 0;
+        }
+        owner->live_length += bytes->bytes.count;
+        mark_object(vm, (b_obj *) owner);
+      }
+      break;
+    }
+
     case OBJ_RANGE:
     case OBJ_NATIVE:
     case OBJ_PTR:
@@ -239,7 +253,9 @@ void free_object(b_vm *vm, b_obj *object) {
     }
     case OBJ_BYTES: {
       b_obj_bytes *bytes = (b_obj_bytes *) object;
-      free_byte_arr(vm, &bytes->bytes);
+      if (bytes->owner == NULL) {
+        free_byte_arr(vm, &bytes->bytes);
+      }
       FREE(b_obj_bytes, object);
       break;
     }
@@ -290,6 +306,9 @@ void free_object(b_vm *vm, b_obj *object) {
     }
     case OBJ_FUNCTION: {
       b_obj_func *function = (b_obj_func *) object;
+#if defined(B_JIT)
+      jit_free(function);
+#endif
       free_blob(vm, &function->blob);
       FREE(b_obj_func, object);
       break;
@@ -314,8 +333,16 @@ void free_object(b_vm *vm, b_obj *object) {
     }
     case OBJ_STRING: {
       b_obj_string *string = (b_obj_string *) object;
-      FREE_ARRAY(char, string->chars, string->length + 1);
-      FREE(b_obj_string, object);
+      size_t size = sizeof(b_obj_string);
+      if (string->chars == string->inline_chars) {
+        size += string->length + 1;
+      } else {
+        FREE_ARRAY(char, string->chars, string->length + 1);
+      }
+      if (string->utf8_index != NULL) {
+        FREE_ARRAY(int, string->utf8_index, string_utf8_index_size(string));
+      }
+      reallocate(vm, object, size, 0);
       break;
     }
 
@@ -393,12 +420,40 @@ static void trace_references(b_vm *vm) {
   }
 }
 
+/**
+ * gives a bytes view its own copy of its buffer when the views reached by
+ * the gc use less than a quarter of the shared buffer so that the rest of
+ * it can be freed once the owner is no longer reachable. the old buffer
+ * stays valid until the next collection since the owner was marked in this
+ * one.
+ */
+static void sweep_bytes_view(b_vm *vm, b_obj_bytes *bytes) {
+  b_obj_bytes *owner = bytes->owner;
+  if (owner->live_length >= owner->bytes.count / 4) {
+    return;
+  }
+
+  // reallocate() could start a nested collection here.
+  unsigned char *data = (unsigned char *) malloc(bytes->bytes.count > 0 ? bytes->bytes.count : 1);
+  if (data == NULL) {
+    OUT_OF_MEMORY();
+  }
+
+  vm->bytes_allocated += bytes->bytes.count;
+  memcpy(data, bytes->bytes.bytes, bytes->bytes.count);
+  bytes->bytes.bytes = data;
+  bytes->owner = NULL;
+}
+
 static void sweep(b_vm *vm) {
   b_obj *previous = NULL;
   b_obj *object = vm->objects;
 
   while (object != NULL) {
     if (object->mark == vm->mark_value) {
+      if (object->type == OBJ_BYTES && object->vm_id == vm->id && ((b_obj_bytes *) object)->owner != NULL) {
+        sweep_bytes_view(vm, (b_obj_bytes *) object);
+      }
       previous = object;
       object = object->next;
     } else {
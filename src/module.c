@@ -41,6 +41,10 @@ b_module_init modules[] = {
     GET_MODULE_LOADER(reflect), //
     GET_MODULE_LOADER(process), //
     GET_MODULE_LOADER(struct), //
+    GET_MODULE_LOADER(set), //
+    GET_MODULE_LOADER(array), //
+    GET_MODULE_LOADER(heap), //
+    GET_MODULE_LOADER(stringbuilder), //
     GET_MODULE_LOADER(thread), //
     NULL,
 };
@@ -49,6 +53,7 @@ void free_module(b_vm *vm, b_obj_module *module) {
   free_table(vm, &module->values);
   free(module->name);
   free(module->file);
+  free(module->import_file);
   if (module->unloader != NULL && module->imported) {
     ((b_module_loader)module->unloader)(vm);
   }
@@ -58,6 +63,7 @@ void free_module(b_vm *vm, b_obj_module *module) {
 
   module->name = NULL;
   module->file = NULL;
+  module->import_file = NULL;
   module->unloader = NULL;
   module->handle = NULL;
 }
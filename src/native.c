@@ -432,7 +432,7 @@ DECLARE_NATIVE(to_number) {
     }
   }
 
-  RETURN_NUMBER(strtod(v, NULL));
+  RETURN_NUMBER(parse_number(v, length));
 }
 
 /**
@@ -484,7 +484,9 @@ DECLARE_NATIVE(to_list) {
     b_obj_string *str = AS_STRING(args[0]);
     for(int i = 0; i < str->utf8_length; i++) {
       int start = i, end = i + 1;
-      utf8slice(str->chars, &start, &end);
+      if(!str->is_ascii) {
+        string_utf8_slice(vm, str, &start, &end);
+      }
 
       write_list(vm, list, STRING_L_VAL(str->chars + start, (int) (end - start)));
     }
@@ -84,11 +84,14 @@ b_obj_module* new_module(b_vm* vm, char* name, char* file, b_obj_module* parent)
   init_table(&module->values);
   module->name = name;
   module->file = file;
+  module->import_file = NULL;
+  module->import_is_relative = false;
   module->parent = parent;
   module->unloader = NULL;
   module->preloader = NULL;
   module->handle = NULL;
   module->imported = false;
+  module->is_lazy = false;
   return module;
 }
 
@@ -106,6 +109,9 @@ b_obj_bytes* new_bytes(b_vm* vm, int length) {
   b_obj_bytes* bytes = ALLOCATE_OBJ(b_obj_bytes, OBJ_BYTES);
   init_byte_arr(&bytes->bytes, length);
   bytes->bytes.bytes = data;
+  bytes->owner = NULL;
+  bytes->live_length = 0;
+  bytes->live_mark = false;
   return bytes;
 }
 
@@ -170,6 +176,13 @@ b_obj_func* new_function(b_vm* vm, b_obj_module* module, b_func_type type) {
   function->arity = 0;
   function->up_value_count = 0;
   function->is_variadic = false;
+  function->inline_kind = INLINE_UNKNOWN;
+  function->inline_instances = 0;
+  function->inline_values = 0;
+#if defined(B_JIT)
+  function->hotness = 0;
+  function->jit = NULL;
+#endif
   function->name = NULL;
   function->type = type;
   function->module = module;
@@ -213,13 +226,11 @@ b_obj_closure* new_closure(b_vm* vm, b_obj_func* function) {
   return closure;
 }
 
-b_obj_string* allocate_string(b_vm* vm, char* chars, int length, uint32_t hash) {
-  b_obj_string* string = ALLOCATE_OBJ(b_obj_string, OBJ_STRING);
-  string->chars = chars;
+static b_obj_string* init_string(b_vm* vm, b_obj_string* string, int length, uint32_t hash) {
   string->length = length;
-  string->utf8_length = utf8length(chars);
-  string->is_ascii = false;
+  string->utf8_length = utf8_scan(string->chars, length, &string->is_ascii);
   string->hash = hash;
+  string->utf8_index = NULL;
 
   push(vm, OBJ_VAL(string)); // fixing gc corruption
   table_set(vm, &vm->strings, OBJ_VAL(string), NIL_VAL);
@@ -228,6 +239,84 @@ b_obj_string* allocate_string(b_vm* vm, char* chars, int length, uint32_t hash)
   return string;
 }
 
+b_obj_string* allocate_string(b_vm* vm, char* chars, int length, uint32_t hash) {
+  b_obj_string* string = ALLOCATE_OBJ(b_obj_string, OBJ_STRING);
+  string->chars = chars;
+  return init_string(vm, string, length, hash);
+}
+
+static b_obj_string* allocate_inline_string(b_vm* vm, const char* chars, int length, uint32_t hash) {
+  b_obj_string* string = (b_obj_string*)allocate_object(vm, sizeof(b_obj_string) + length + 1, OBJ_STRING);
+  memcpy(string->inline_chars, chars, length);
+  string->inline_chars[length] = '\0';
+  string->chars = string->inline_chars;
+  return init_string(vm, string, length, hash);
+}
+
+static inline bool is_utf8_continuation(char c) {
+  return (c & 0xC0) == 0x80;
+}
+
+/**
+ * the index starts with the number of codepoints in the text and the byte
+ * length of the text followed by the byte offsets of every
+ * STRING_INDEX_STRIDE-th codepoint.
+ */
+static int *build_utf8_index(b_vm *vm, b_obj_string *string) {
+  int *index = ALLOCATE(int, string_utf8_index_size(string));
+
+  int codepoint = 0, i = 0;
+  for (; string->chars[i]; i++) {
+    if (!is_utf8_continuation(string->chars[i])) {
+      if (codepoint % STRING_INDEX_STRIDE == 0 && codepoint <= string->utf8_length) {
+        index[2 + codepoint / STRING_INDEX_STRIDE] = i;
+      }
+      codepoint++;
+    }
+  }
+
+  index[0] = codepoint < string->utf8_length ? codepoint : string->utf8_length;
+  index[1] = i;
+  return index;
+}
+
+static int utf8_index_offset(b_obj_string *string, int position) {
+  int offset = string->utf8_index[2 + position / STRING_INDEX_STRIDE];
+  for (int remaining = position % STRING_INDEX_STRIDE; remaining > 0;) {
+    if (!is_utf8_continuation(string->chars[++offset])) {
+      remaining--;
+    }
+  }
+  return offset;
+}
+
+/**
+ * converts the codepoint indexes start and end to byte offsets the same way
+ * utf8slice() does, but without scanning the string from the start for
+ * strings longer than STRING_INDEX_STRIDE codepoints.
+ */
+void string_utf8_slice(b_vm *vm, b_obj_string *string, int *start, int *end) {
+  if (string->utf8_length == string->length) {
+    // every codepoint is a single byte.
+    *start = *start >= 0 && *start < string->length ? *start : -1;
+    *end = *end >= 0 && *end < string->length ? *end : string->length;
+    return;
+  }
+
+  if (string->utf8_length <= STRING_INDEX_STRIDE) {
+    utf8slice(string->chars, start, end);
+    return;
+  }
+
+  if (string->utf8_index == NULL) {
+    string->utf8_index = build_utf8_index(vm, string);
+  }
+
+  int count = string->utf8_index[0];
+  *start = *start >= 0 && *start < count ? utf8_index_offset(string, *start) : -1;
+  *end = *end >= 0 && *end < count ? utf8_index_offset(string, *end) : string->utf8_index[1];
+}
+
 b_obj_string* take_string(b_vm* vm, char* chars, int length) {
   uint32_t hash = hash_string(chars, length);
 
@@ -237,6 +326,12 @@ b_obj_string* take_string(b_vm* vm, char* chars, int length) {
     return interned;
   }
 
+  if (length >= 0 && length <= STRING_INLINE_LENGTH) {
+    b_obj_string* string = allocate_inline_string(vm, chars, length, hash);
+    FREE_ARRAY(char, chars, (size_t) length + 1);
+    return string;
+  }
+
   return allocate_string(vm, chars, length, hash);
 }
 
@@ -247,6 +342,10 @@ b_obj_string* copy_string(b_vm* vm, const char* chars, int length) {
   if (interned != NULL)
     return interned;
 
+  if (length >= 0 && length <= STRING_INLINE_LENGTH) {
+    return allocate_inline_string(vm, chars, length, hash);
+  }
+
   char* heap_chars = ALLOCATE(char, (size_t) length + 1);
   memcpy(heap_chars, chars, length);
   heap_chars[length] = '\0';
@@ -413,9 +512,49 @@ b_obj_bytes* take_bytes(b_vm* vm, unsigned char* b, int length) {
   b_obj_bytes* bytes = ALLOCATE_OBJ(b_obj_bytes, OBJ_BYTES);
   bytes->bytes.count = length;
   bytes->bytes.bytes = b;
+  bytes->owner = NULL;
+  bytes->live_length = 0;
+  bytes->live_mark = false;
   return bytes;
 }
 
+b_obj_bytes* slice_bytes(b_vm* vm, b_obj_bytes* bytes, int offset, int length) {
+  // short slices are cheaper to copy than to keep their parent alive for and
+  // bytes owned by another vm (e.g. a parent thread) cannot be shared.
+  if (length < BYTES_VIEW_MIN_LENGTH || ((b_obj*)bytes)->vm_id != vm->id) {
+    return copy_bytes(vm, bytes->bytes.bytes + offset, length);
+  }
+
+  if (bytes->owner == NULL) {
+    // move the buffer into a hidden owner so the parent becomes a view too.
+    bytes->owner = take_bytes(vm, bytes->bytes.bytes, bytes->bytes.count);
+  }
+
+  b_obj_bytes* slice = ALLOCATE_OBJ(b_obj_bytes, OBJ_BYTES);
+  slice->bytes.count = length;
+  slice->bytes.bytes = bytes->bytes.bytes + offset;
+  slice->owner = bytes->owner;
+  return slice;
+}
+
+void unshare_bytes(b_vm* vm, b_obj_bytes* bytes) {
+  if (bytes->owner == NULL) {
+    return;
+  }
+
+  // C_ALLOCATE() could start a collection that unshares these same bytes
+  // in sweep_bytes_view().
+  unsigned char* data = (unsigned char*) malloc(bytes->bytes.count > 0 ? bytes->bytes.count : 1);
+  if (data == NULL) {
+    OUT_OF_MEMORY();
+  }
+
+  vm->bytes_allocated += bytes->bytes.count;
+  memcpy(data, bytes->bytes.bytes, bytes->bytes.count);
+  bytes->bytes.bytes = data;
+  bytes->owner = NULL;
+}
+
 static inline b_obj_string* function_to_string(b_vm* vm, b_obj_func* func) {
   if (func->name == NULL) {
     return copy_string(vm, "<script 0x00>", 13);
@@ -18,6 +18,14 @@ typedef enum {
   TYPE_SCRIPT,
 } b_func_type;
 
+// how calls to a function may skip pushing a frame for it (see call_inline).
+typedef enum {
+  INLINE_UNKNOWN, // not looked at yet.
+  INLINE_NEVER,
+  INLINE_PURE, // reads and computes only, so it can give up at any point.
+  INLINE_STORE, // stores properties after checking its locals on entry.
+} b_inline_kind;
+
 #define OBJ_TYPE(v) (AS_OBJ(v)->type)
 
 // object type checks
@@ -103,6 +111,14 @@ struct s_obj {
   struct s_obj *next;
 };
 
+// non-ASCII strings record the byte offset of every STRING_INDEX_STRIDE-th
+// codepoint the first time they are indexed.
+#define STRING_INDEX_STRIDE 64
+
+// strings of up to STRING_INLINE_LENGTH bytes keep their chars in the same
+// allocation as the string object.
+#define STRING_INLINE_LENGTH 31
+
 struct s_obj_string {
   b_obj obj;
   int length;
@@ -110,6 +126,8 @@ struct s_obj_string {
   bool is_ascii;
   uint32_t hash;
   char *chars;
+  int *utf8_index;
+  char inline_chars[];
 };
 
 typedef struct b_obj_up_value {
@@ -125,6 +143,9 @@ struct s_obj_module {
   b_table values;
   char *name;
   char *file;
+  char *import_file; // the module file as written in the import statement.
+  bool import_is_relative;
+  bool is_lazy; // imported lazily and not run yet.
   void *preloader;
   void *unloader;
   void *handle;
@@ -137,6 +158,13 @@ typedef struct {
   int arity;
   int up_value_count;
   bool is_variadic;
+  b_inline_kind inline_kind;
+  uint32_t inline_instances; // locals an INLINE_STORE stores properties on.
+  uint32_t inline_values; // locals an INLINE_STORE stores into properties.
+#if defined(B_JIT)
+  uint32_t hotness; // calls and loop iterations until JIT_THRESHOLD.
+  struct s_jit_code *jit;
+#endif
   b_blob blob;
   b_obj_string *name;
   b_obj_module *module;
@@ -194,9 +222,20 @@ typedef struct {
   int step;
 } b_obj_range;
 
-typedef struct {
+/**
+ * bytes created by slicing may share the buffer of the bytes they were
+ * sliced from. such bytes point into the buffer of their owner, a hidden
+ * bytes object that holds the whole buffer and is kept alive by its views.
+ * bytes with an owner must call unshare_bytes() before they are modified.
+ */
+#define BYTES_VIEW_MIN_LENGTH 64
+
+typedef struct b_obj_bytes {
   b_obj obj;
   b_byte_arr bytes;
+  struct b_obj_bytes *owner;
+  int live_length; // bytes of the buffer used by views reached in the last gc.
+  bool live_mark;
 } b_obj_bytes;
 
 typedef struct {
@@ -269,6 +308,25 @@ b_obj_string *copy_string(b_vm *vm, const char *chars, int length);
 
 b_obj_string *take_string(b_vm *vm, char *chars, int length);
 
+/**
+ * declares a buffer for building a string of the given length. short
+ * strings are built on the stack since they are copied into the string
+ * object anyway. the buffer must be turned into a string with
+ * TAKE_STRING_BUFFER().
+ */
+#define STRING_BUFFER(name, length) \
+  char name##_inline[STRING_INLINE_LENGTH + 1]; \
+  char *name = (length) <= STRING_INLINE_LENGTH ? name##_inline : ALLOCATE(char, (size_t) (length) + 1)
+
+#define TAKE_STRING_BUFFER(name, length) \
+  (name == name##_inline ? copy_string(vm, name, length) : take_string(vm, name, length))
+
+void string_utf8_slice(b_vm *vm, b_obj_string *string, int *start, int *end);
+
+static inline int string_utf8_index_size(b_obj_string *string) {
+  return 2 + string->utf8_length / STRING_INDEX_STRIDE + 1;
+}
+
 void print_object(b_value value, bool fix_string);
 
 const char *object_type(b_obj *object);
@@ -279,6 +337,10 @@ b_obj_bytes *copy_bytes(b_vm *vm, unsigned char *b, int length);
 
 b_obj_bytes *take_bytes(b_vm *vm, unsigned char *b, int length);
 
+b_obj_bytes *slice_bytes(b_vm *vm, b_obj_bytes *bytes, int offset, int length);
+
+void unshare_bytes(b_vm *vm, b_obj_bytes *bytes);
+
 static inline bool is_obj_type(b_value v, b_obj_type t) {
   return IS_OBJ(v) && AS_OBJ(v)->type == t;
 }
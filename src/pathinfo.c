@@ -4,6 +4,7 @@
 
 #include "pathinfo.h"
 #include "common.h"
+#include "vm.h"
 
 #ifdef _WIN32
 
@@ -141,7 +142,8 @@ char *get_core_library_file_path(char *module_name) {
   return NULL;
 }
 
-char *resolve_import_path(char *module_name, const char *current_file, const char *root_file, bool is_relative) {
+static char *find_import_path(char *module_name, const char *current_file, const char *root_file, bool is_relative,
+                              bool *skipped_self) {
   char *blade_file_name = get_blade_filename(module_name);
 
   // search system library if we are not looking for a relative module.
@@ -183,6 +185,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
     free(vendor_file);
@@ -207,6 +210,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
     free(vendor_index_file);
@@ -228,6 +232,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
     free(current_vendor_file);
@@ -252,6 +257,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
     free(current_vendor_index_file);
@@ -276,6 +282,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
     free(library_file);
@@ -297,6 +304,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
     free(library_index_file);
@@ -315,6 +323,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
     free(package_file);
@@ -337,6 +346,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
 
@@ -369,6 +379,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
     free(relative_file);
@@ -389,6 +400,7 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
           free(blade_file_name);
           return path1;
         }
+        *skipped_self = true;
       }
     }
     free(relative_index_file);
@@ -398,4 +410,231 @@ char *resolve_import_path(char *module_name, const char *current_file, const cha
   return NULL;
 }
 
+/**
+ * resolved imports are cached per vm so that every import of a module after
+ * the first one costs a hash lookup instead of building and probing each
+ * candidate path. entries are keyed by the module name for package imports
+ * and by the importing directory and the module name for relative imports,
+ * and modules that could not be found are cached as well.
+ *
+ * a project may also list where its packages live in a manifest file
+ * (.blade/imports in the root directory) of lines like
+ *
+ *   name = path/to/module.b
+ *
+ * where paths are relative to the root directory. packages named in the
+ * manifest are resolved without searching any of the default locations.
+ */
+typedef struct {
+  char *key;
+  uint32_t hash;
+  char *path; // NULL when the module was not found.
+} b_import_entry;
+
+struct s_import_cache {
+  char *root_file; // the root file the cache was created for.
+  b_import_entry *entries;
+  int count;
+  int capacity;
+};
+
+static b_import_entry *find_import_entry(b_import_entry *entries, int capacity, const char *key, uint32_t hash) {
+  uint32_t index = hash & (capacity - 1);
+  for (;;) {
+    b_import_entry *entry = &entries[index];
+    if (entry->key == NULL || (entry->hash == hash && strcmp(entry->key, key) == 0)) {
+      return entry;
+    }
+    index = (index + 1) & (capacity - 1);
+  }
+}
+
+static void set_import_entry(b_import_cache *cache, char *key, char *path) {
+  if (cache->count + 1 > cache->capacity * 3 / 4) {
+    int capacity = cache->capacity < 16 ? 16 : cache->capacity * 2;
+    b_import_entry *entries = (b_import_entry *) calloc(capacity, sizeof(b_import_entry));
+    if (entries == NULL) {
+      free(key);
+      free(path);
+      return;
+    }
+
+    for (int i = 0; i < cache->capacity; i++) {
+      if (cache->entries[i].key != NULL) {
+        *find_import_entry(entries, capacity, cache->entries[i].key, cache->entries[i].hash) = cache->entries[i];
+      }
+    }
+
+    free(cache->entries);
+    cache->entries = entries;
+    cache->capacity = capacity;
+  }
+
+  uint32_t hash = hash_string(key, (int) strlen(key));
+  b_import_entry *entry = find_import_entry(cache->entries, cache->capacity, key, hash);
+  if (entry->key == NULL) {
+    cache->count++;
+  } else {
+    free(entry->key);
+    free(entry->path);
+  }
+
+  entry->key = key;
+  entry->hash = hash;
+  entry->path = path;
+}
+
+static b_import_entry *get_import_entry(b_import_cache *cache, const char *key) {
+  if (cache->count == 0) return NULL;
+
+  b_import_entry *entry = find_import_entry(cache->entries, cache->capacity, key,
+                                            hash_string(key, (int) strlen(key)));
+  return entry->key == NULL ? NULL : entry;
+}
+
+static char *get_root_dir(const char *root_file) {
+  char *root_dir;
+  if (root_file == NULL) {
+    root_dir = getcwd(NULL, 0);
+  } else {
+    char *tmp_str = strdup(root_file);
+    root_dir = strdup(dirname(tmp_str));
+    free(tmp_str);
+  }
+
+  // fixing last path / if exists (looking at windows)...
+  int root_dir_length = (int) strlen(root_dir);
+  if (root_dir_length > 1 && root_dir[root_dir_length - 1] == '\\') {
+    root_dir[root_dir_length - 1] = '\0';
+  }
+  return root_dir;
+}
+
+static char *trim_manifest_text(char *text) {
+  while (*text == ' ' || *text == '\t') text++;
+
+  char *end = text + strlen(text);
+  while (end > text && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r')) end--;
+  *end = '\0';
+  return text;
+}
+
+/**
+ * adds the packages listed in the root directory's manifest (if any) to the
+ * cache as manifest entries. their paths are resolved when first imported.
+ */
+static void load_import_manifest(b_import_cache *cache, const char *root_file) {
+  char *root_dir = get_root_dir(root_file);
+  char *manifest_file = merge_paths(root_dir, LOCAL_PACKAGES_DIRECTORY LOCAL_IMPORTS_MANIFEST);
+  char *source = read_file(manifest_file);
+  free(manifest_file);
+
+  if (source != NULL) {
+    char *line = source;
+    while (line != NULL && *line != '\0') {
+      char *next = strchr(line, '\n');
+      if (next != NULL) *next++ = '\0';
+
+      char *separator = strchr(line, '=');
+      line = trim_manifest_text(line);
+
+      if (*line != '#' && separator != NULL) {
+        *separator = '\0';
+        char *name = trim_manifest_text(line);
+        char *path = trim_manifest_text(separator + 1);
+
+        if (*name != '\0' && *path != '\0') {
+          set_import_entry(cache, append_strings(strdup("m"), name), merge_paths(root_dir, path));
+        }
+      }
+
+      line = next;
+    }
+    free(source);
+  }
+
+  free(root_dir);
+}
+
+void free_import_cache(b_vm *vm) {
+  b_import_cache *cache = vm->import_cache;
+  if (cache == NULL) return;
+
+  for (int i = 0; i < cache->capacity; i++) {
+    free(cache->entries[i].key);
+    free(cache->entries[i].path);
+  }
+  free(cache->entries);
+  free(cache->root_file);
+  free(cache);
+  vm->import_cache = NULL;
+}
+
+char *resolve_import_path(b_vm *vm, char *module_name, const char *current_file, const char *root_file,
+                          bool is_relative) {
+  b_import_cache *cache = vm->import_cache;
+  if (cache != NULL && (root_file == NULL ? cache->root_file != NULL
+                                          : cache->root_file == NULL || strcmp(cache->root_file, root_file) != 0)) {
+    free_import_cache(vm);
+    cache = NULL;
+  }
+
+  if (cache == NULL) {
+    cache = vm->import_cache = (b_import_cache *) calloc(1, sizeof(b_import_cache));
+    if (cache == NULL) {
+      bool skipped_self = false;
+      return find_import_path(module_name, current_file, root_file, is_relative, &skipped_self);
+    }
+    cache->root_file = root_file == NULL ? NULL : strdup(root_file);
+    load_import_manifest(cache, root_file);
+  }
+
+  char *key = strdup(is_relative ? "r" : "p");
+  if (is_relative) {
+    char *tmp_str = strdup(current_file);
+    char *module_file = merge_paths(dirname(tmp_str), module_name);
+    key = append_strings(key, module_file);
+    free(module_file);
+    free(tmp_str);
+  } else {
+    key = append_strings(key, module_name);
+  }
+
+  b_import_entry *entry = get_import_entry(cache, key);
+
+  // a module never resolves to the file importing it, so cached paths
+  // leading back to the current file must be looked up again.
+  if (entry != NULL && (entry->path == NULL || strcmp(entry->path, current_file) != 0)) {
+    free(key);
+    return entry->path == NULL ? NULL : strdup(entry->path);
+  }
+
+  char *path = NULL;
+  if (!is_relative) {
+    key[0] = 'm';
+    if ((entry = get_import_entry(cache, key)) != NULL) {
+      path = realpath(entry->path, NULL);
+      if (path != NULL && strcmp(path, current_file) == 0) {
+        free(path);
+        path = NULL;
+      }
+    }
+    key[0] = 'p';
+  }
+
+  bool skipped_self = false;
+  if (path == NULL) {
+    path = find_import_path(module_name, current_file, root_file, is_relative, &skipped_self);
+  }
+
+  if (skipped_self) {
+    // the result only holds for the current file.
+    free(key);
+  } else {
+    set_import_entry(cache, key, path == NULL ? NULL : strdup(path));
+  }
+
+  return path;
+}
+
 char *get_real_file_name(char *path) { return basename(path); }
@@ -2,6 +2,7 @@
 #define BLADE_PATHINFO_H
 
 #include "common.h"
+#include "value.h"
 
 #ifdef _WIN32
 #define BLADE_PATH_SEPARATOR "\\"
@@ -20,7 +21,10 @@ bool file_exists(char *filepath);
 
 char *get_blade_filename(char *filename);
 
-char *resolve_import_path(char *module_name, const char *current_file, const char *root_file, bool is_relative);
+char *resolve_import_path(b_vm *vm, char *module_name, const char *current_file, const char *root_file,
+                          bool is_relative);
+
+void free_import_cache(b_vm *vm);
 
 char *get_core_library_file_path(char *module_name);
 
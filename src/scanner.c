@@ -9,9 +9,71 @@
 #include <asprintf.h>
 #endif
 
+#if defined(__GNUC__) || defined(__clang__)
+#  if defined(__AVX2__)
+#    include <immintrin.h>
+#    define SCANNER_SIMD_AVX2 1
+#  elif defined(__SSE2__)
+#    include <emmintrin.h>
+#    define SCANNER_SIMD_SSE2 1
+#  endif
+#endif
+
+typedef struct {
+  const char *name;
+  int length;
+  b_tkn_type type;
+} b_keyword;
+
+#define MAX_KEYWORD_LENGTH 8
+
+/**
+ * a perfect hash of the keywords on their first and last characters and
+ * their length. no two keywords share a slot so that an identifier is only
+ * ever compared against the one keyword in its slot.
+ *
+ * the hash must be checked for collisions again whenever a keyword is
+ * added.
+ */
+#define KEYWORD_HASH(first, last, length) ((((first) * 9) + (last) + ((length) * 5)) & 63)
+
+static const b_keyword keywords[64] = {
+    [KEYWORD_HASH('a', 'd', 3)] = {"and", 3, AND_TOKEN},
+    [KEYWORD_HASH('a', 's', 2)] = {"as", 2, AS_TOKEN},
+    [KEYWORD_HASH('a', 't', 6)] = {"assert", 6, ASSERT_TOKEN},
+    [KEYWORD_HASH('b', 'k', 5)] = {"break", 5, BREAK_TOKEN},
+    [KEYWORD_HASH('c', 'h', 5)] = {"catch", 5, CATCH_TOKEN},
+    [KEYWORD_HASH('c', 's', 5)] = {"class", 5, CLASS_TOKEN},
+    [KEYWORD_HASH('c', 'e', 8)] = {"continue", 8, CONTINUE_TOKEN},
+    [KEYWORD_HASH('d', 'f', 3)] = {"def", 3, DEF_TOKEN},
+    [KEYWORD_HASH('d', 't', 7)] = {"default", 7, DEFAULT_TOKEN},
+    [KEYWORD_HASH('d', 'o', 2)] = {"do", 2, DO_TOKEN},
+    [KEYWORD_HASH('e', 'o', 4)] = {"echo", 4, ECHO_TOKEN},
+    [KEYWORD_HASH('e', 'e', 4)] = {"else", 4, ELSE_TOKEN},
+    [KEYWORD_HASH('f', 'e', 5)] = {"false", 5, FALSE_TOKEN},
+    [KEYWORD_HASH('f', 'r', 3)] = {"for", 3, FOR_TOKEN},
+    [KEYWORD_HASH('i', 'f', 2)] = {"if", 2, IF_TOKEN},
+    [KEYWORD_HASH('i', 't', 6)] = {"import", 6, IMPORT_TOKEN},
+    [KEYWORD_HASH('i', 'n', 2)] = {"in", 2, IN_TOKEN},
+    [KEYWORD_HASH('i', 'r', 4)] = {"iter", 4, ITER_TOKEN},
+    [KEYWORD_HASH('n', 'l', 3)] = {"nil", 3, NIL_TOKEN},
+    [KEYWORD_HASH('o', 'r', 2)] = {"or", 2, OR_TOKEN},
+    [KEYWORD_HASH('p', 't', 6)] = {"parent", 6, PARENT_TOKEN},
+    [KEYWORD_HASH('r', 'e', 5)] = {"raise", 5, RAISE_TOKEN},
+    [KEYWORD_HASH('r', 'n', 6)] = {"return", 6, RETURN_TOKEN},
+    [KEYWORD_HASH('s', 'f', 4)] = {"self", 4, SELF_TOKEN},
+    [KEYWORD_HASH('s', 'c', 6)] = {"static", 6, STATIC_TOKEN},
+    [KEYWORD_HASH('t', 'e', 4)] = {"true", 4, TRUE_TOKEN},
+    [KEYWORD_HASH('u', 'g', 5)] = {"using", 5, USING_TOKEN},
+    [KEYWORD_HASH('v', 'r', 3)] = {"var", 3, VAR_TOKEN},
+    [KEYWORD_HASH('w', 'n', 4)] = {"when", 4, WHEN_TOKEN},
+    [KEYWORD_HASH('w', 'e', 5)] = {"while", 5, WHILE_TOKEN},
+};
+
 void init_scanner(b_scanner *s, const char *source) {
   s->current = source;
   s->start = source;
+  s->end = source + strlen(source);
   s->line = 1;
   s->interpolating_count = -1;
 }
@@ -91,6 +153,97 @@ static char next(b_scanner *s) {
   return s->current[1];
 }
 
+/**
+ * returns the first of the given characters at or after p or end if there
+ * is none. pass the same character more than once to look for fewer.
+ *
+ * the runs skipped this way (comment and string bodies) are where most of
+ * a source file's bytes are so they are checked a block at a time.
+ */
+static const char *find_any(const char *p, const char *end, char a, char b, char c, char d) {
+#if defined(SCANNER_SIMD_AVX2)
+  const __m256i va = _mm256_set1_epi8(a), vb = _mm256_set1_epi8(b);
+  const __m256i vc = _mm256_set1_epi8(c), vd = _mm256_set1_epi8(d);
+
+  for (; p + 32 <= end; p += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *) p);
+    __m256i found = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, va), _mm256_cmpeq_epi8(block, vb)),
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, vc), _mm256_cmpeq_epi8(block, vd)));
+    uint32_t mask = (uint32_t) _mm256_movemask_epi8(found);
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#elif defined(SCANNER_SIMD_SSE2)
+  const __m128i va = _mm_set1_epi8(a), vb = _mm_set1_epi8(b);
+  const __m128i vc = _mm_set1_epi8(c), vd = _mm_set1_epi8(d);
+
+  for (; p + 16 <= end; p += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *) p);
+    __m128i found = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, va), _mm_cmpeq_epi8(block, vb)),
+        _mm_or_si128(_mm_cmpeq_epi8(block, vc), _mm_cmpeq_epi8(block, vd)));
+    uint32_t mask = (uint32_t) _mm_movemask_epi8(found);
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  for (; p < end; p++) {
+    if (*p == a || *p == b || *p == c || *p == d) {
+      return p;
+    }
+  }
+
+  return end;
+}
+
+// returns the first character at or after p that is not a space, a tab or
+// a carriage return.
+static const char *skip_blanks(const char *p, const char *end) {
+#if defined(SCANNER_SIMD_AVX2)
+  const __m256i space = _mm256_set1_epi8(' '), tab = _mm256_set1_epi8('\t');
+  const __m256i carriage_return = _mm256_set1_epi8('\r');
+
+  // indentation is rarely this long, so only runs that fill a block are
+  // worth checking a block at a time.
+  for (; p + 32 <= end && p[0] == ' ' && p[31] == ' '; p += 32) {
+    __m256i block = _mm256_loadu_si256((const __m256i *) p);
+    __m256i blank = _mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(block, space), _mm256_cmpeq_epi8(block, tab)),
+        _mm256_cmpeq_epi8(block, carriage_return));
+    uint32_t mask = ~(uint32_t) _mm256_movemask_epi8(blank);
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#elif defined(SCANNER_SIMD_SSE2)
+  const __m128i space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+  const __m128i carriage_return = _mm_set1_epi8('\r');
+
+  // indentation is rarely this long, so only runs that fill a block are
+  // worth checking a block at a time.
+  for (; p + 16 <= end && p[0] == ' ' && p[15] == ' '; p += 16) {
+    __m128i block = _mm_loadu_si128((const __m128i *) p);
+    __m128i blank = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, space), _mm_cmpeq_epi8(block, tab)),
+        _mm_cmpeq_epi8(block, carriage_return));
+    uint32_t mask = ~(uint32_t) _mm_movemask_epi8(blank) & 0xFFFF;
+    if (mask != 0) {
+      return p + __builtin_ctz(mask);
+    }
+  }
+#endif
+
+  while (*p == ' ' || *p == '\t' || *p == '\r') {
+    p++;
+  }
+
+  return p;
+}
+
 b_token skip_block_comments(b_scanner *s) {
   int nesting = 1;
   while (nesting > 0) {
@@ -114,7 +267,11 @@ b_token skip_block_comments(b_scanner *s) {
     }
 
     // regular comment body
-    advance(s);
+    if (current(s) == '\n' || current(s) == '*' || current(s) == '/') {
+      advance(s);
+    } else {
+      s->current = find_any(s->current, s->end, '\n', '*', '/', '/');
+    }
   }
 
 #ifdef _WIN32
@@ -132,12 +289,11 @@ b_token skip_whitespace(b_scanner *s) {
       case ' ':
       case '\r':
       case '\t':
-        advance(s);
+        s->current = skip_blanks(s->current, s->end);
         break;
 
       case '#': { // single line comment
-        while (current(s) != '\n' && !is_at_end(s))
-          advance(s);
+        s->current = find_any(s->current, s->end, '\n', '\n', '\n', '\n');
         break;
       }
 
@@ -162,7 +318,13 @@ b_token skip_whitespace(b_scanner *s) {
 }
 
 static b_token string(b_scanner *s, char quote) {
-  while (current(s) != quote && !is_at_end(s)) {
+  for (;;) {
+    // nothing but quotes, interpolations, escapes and new lines needs a
+    // closer look.
+    s->current = find_any(s->current, s->end, quote, '$', '\\', '\n');
+    if (current(s) == quote || is_at_end(s)) {
+      break;
+    }
 
     if (current(s) == '$' && next(s) == '{' &&
         previous(s) != '\\') { // interpolation started
@@ -239,153 +401,25 @@ static b_token number(b_scanner *s) {
   return make_token(s, REG_NUMBER_TOKEN);
 }
 
-static b_tkn_type check_keyword(b_scanner *s, int start, int length,
-                                const char *rest, b_tkn_type type) {
-  if ((int) (s->current - s->start) == start + length &&
-      memcmp(s->start + start, rest, length) == 0) {
-    return type;
+static b_tkn_type identifier_type(b_scanner *s) {
+  int length = (int) (s->current - s->start);
+  if (length < 2 || length > MAX_KEYWORD_LENGTH) {
+    return IDENTIFIER_TOKEN;
   }
-  return IDENTIFIER_TOKEN;
-}
 
-static b_tkn_type identifier_type(b_scanner *s) {
-  switch (s->start[0]) {
-    case 'a':
-      if (s->current - s->start > 1) {
-        switch (s->start[1]) {
-          case 'n':
-            return check_keyword(s, 2, 1, "d", AND_TOKEN);
-          case 's':
-            if (s->current - s->start > 2) {
-              return check_keyword(s, 2, 4, "sert", ASSERT_TOKEN);
-            } else {
-              return check_keyword(s, 2, 0, "", AS_TOKEN);
-            }
-        }
-      }
-      break;
-    case 'b':
-      return check_keyword(s, 1, 4, "reak", BREAK_TOKEN);
-    case 'c':
-      if (s->current - s->start > 1) {
-        switch (s->start[1]) {
-          case 'a':
-            return check_keyword(s, 2, 3, "tch", CATCH_TOKEN);
-          case 'l':
-            return check_keyword(s, 2, 3, "ass", CLASS_TOKEN);
-          case 'o':
-            return check_keyword(s, 2, 6, "ntinue", CONTINUE_TOKEN);
-        }
-      }
-      break;
-    case 'd':
-      if (s->current - s->start > 1) {
-        switch (s->start[1]) {
-          case 'e':
-            if (s->current - s->start > 2) {
-              switch (s->start[2]) {
-                case 'f':
-                  if (s->current - s->start > 3)
-                    return check_keyword(s, 3, 4, "ault", DEFAULT_TOKEN);
-                  else
-                    return check_keyword(s, 3, 0, "", DEF_TOKEN);
-              }
-            }
-            break;
-          case 'o':
-            return check_keyword(s, 2, 0, "", DO_TOKEN);
-        }
-      }
-      break;
-    case 'e':
-      if (s->current - s->start > 1) {
-        switch (s->start[1]) {
-          case 'c':
-            return check_keyword(s, 2, 2, "ho", ECHO_TOKEN);
-          case 'l':
-            return check_keyword(s, 2, 2, "se", ELSE_TOKEN);
-        }
-      }
-      break;
-    case 'f':
-      if (s->current - s->start > 1) {
-        switch (s->start[1]) {
-          case 'a':
-            return check_keyword(s, 2, 3, "lse", FALSE_TOKEN);
-          case 'o':
-            return check_keyword(s, 2, 1, "r", FOR_TOKEN);
-        }
-      }
-      break;
-    case 'i':
-      if (s->current - s->start > 1) {
-        switch (s->start[1]) {
-          case 'f':
-            return check_keyword(s, 2, 0, "", IF_TOKEN);
-          case 'm':
-            return check_keyword(s, 2, 4, "port", IMPORT_TOKEN);
-          case 'n':
-            return check_keyword(s, 2, 0, "", IN_TOKEN);
-          case 't':
-            return check_keyword(s, 2, 2, "er", ITER_TOKEN);
-        }
-      }
-      break;
-    case 'n':
-      return check_keyword(s, 1, 2, "il", NIL_TOKEN);
-    case 'o':
-      return check_keyword(s, 1, 1, "r", OR_TOKEN);
-    case 'p':
-      return check_keyword(s, 1, 5, "arent", PARENT_TOKEN);
-    case 'r':
-      if (s->current - s->start > 1) {
-        switch (s->start[1]) {
-          case 'e':
-            return check_keyword(s, 2, 4, "turn", RETURN_TOKEN);
-          case 'a':
-            return check_keyword(s, 2, 3, "ise", RAISE_TOKEN);
-        }
-      }
-    case 's':
-      if (s->current - s->start > 1) {
-        switch (s->start[1]) {
-          case 'e':
-            return check_keyword(s, 2, 2, "lf", SELF_TOKEN);
-          case 't':
-            return check_keyword(s, 2, 4, "atic", STATIC_TOKEN);
-        }
-      }
-      break;
-    case 't':
-      if (s->current - s->start > 2 && s->start[1] == 'r') {
-        switch (s->start[2]) {
-          case 'u':
-            return check_keyword(s, 3, 1, "e", TRUE_TOKEN);
-        }
-      }
-      break;
-    case 'u': {
-      return check_keyword(s, 1, 4, "sing", USING_TOKEN);
-    }
-    case 'v':
-      return check_keyword(s, 1, 2, "ar", VAR_TOKEN);
-    case 'w':
-      if (s->current - s->start > 2 && s->start[1] == 'h') {
-        switch (s->start[2]) {
-          case 'i':
-            return check_keyword(s, 3, 2, "le", WHILE_TOKEN);
-          case 'e':
-            return check_keyword(s, 3, 1, "n", WHEN_TOKEN);
-        }
-      }
-      break;
+  const b_keyword *keyword = &keywords[KEYWORD_HASH(s->start[0], s->start[length - 1], length)];
+  if (keyword->length == length && memcmp(keyword->name, s->start, length) == 0) {
+    return keyword->type;
   }
+
   return IDENTIFIER_TOKEN;
 }
 
 static b_token identifier(b_scanner *s) {
-  while (is_alpha(current(s)) || is_digit(current(s)))
-    advance(s);
+  const char *p = s->current;
+  while (is_alpha(*p) || is_digit(*p))
+    p++;
+  s->current = p;
   return make_token(s, identifier_type(s));
 }
 
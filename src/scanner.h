@@ -120,6 +120,7 @@ typedef struct {
 typedef struct {
   const char *start;
   const char *current;
+  const char *end;
   int line;
   int interpolating_count;
   int interpolating[MAX_INTERPOLATION_NESTING];
@@ -0,0 +1,493 @@
+#include "module.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/**
+ * Typed arrays keep their items packed in a bytes object in the platform
+ * byte order. The item type is given by the same format codes used by the
+ * struct module:
+ *
+ * s/S - signed/unsigned 16-bit integers
+ * l/L - signed/unsigned 32-bit integers
+ * q/Q - signed/unsigned 64-bit integers
+ * f/d - 32-bit and 64-bit floats
+ */
+
+#define ARRAY_DISPATCH(type, CASE) \
+  switch (type) { \
+    case 's': CASE(int16_t); break; \
+    case 'S': CASE(uint16_t); break; \
+    case 'l': CASE(int32_t); break; \
+    case 'L': CASE(uint32_t); break; \
+    case 'q': CASE(int64_t); break; \
+    case 'Q': CASE(uint64_t); break; \
+    case 'f': CASE(float); break; \
+    case 'd': CASE(double); break; \
+    default: break; \
+  }
+
+#define ENFORCE_ARRAY_VALUE(value) \
+  if (!array_value_fits(type, (value))) { \
+    RETURN_VALUE_ERROR("value out of range for array type '%c'", type); \
+  }
+
+#define ENFORCE_ARRAY_TYPE(name, i) \
+  ENFORCE_ARG_TYPE(name, i, IS_STRING); \
+  char type = AS_STRING(args[i])->chars[0]; \
+  int item_size = array_item_size(type); \
+  if (item_size == 0 || AS_STRING(args[i])->length != 1) { \
+    RETURN_ARGUMENT_ERROR("invalid array type '%s'", AS_C_STRING(args[i])); \
+  }
+
+static inline int array_item_size(char type) {
+  switch (type) {
+    case 's':
+    case 'S':
+      return 2;
+    case 'l':
+    case 'L':
+    case 'f':
+      return 4;
+    case 'q':
+    case 'Q':
+    case 'd':
+      return 8;
+    default:
+      return 0;
+  }
+}
+
+static inline double array_get_item(const unsigned char *data, char type, int index) {
+#define GET_ITEM(t) return (double) ((const t *) data)[index]
+  ARRAY_DISPATCH(type, GET_ITEM)
+#undef GET_ITEM
+  return 0;
+}
+
+/**
+ * returns true if value can be stored as an item of the given type. the
+ * conversion of a value outside the range of the type is undefined.
+ */
+static inline bool array_value_fits(char type, double value) {
+  switch (type) {
+    case 's': return value > INT16_MIN - 1.0 && value < INT16_MAX + 1.0;
+    case 'S': return value > -1.0 && value < UINT16_MAX + 1.0;
+    case 'l': return value > INT32_MIN - 1.0 && value < INT32_MAX + 1.0;
+    case 'L': return value > -1.0 && value < UINT32_MAX + 1.0;
+    case 'q': return value >= -0x1p63 && value < 0x1p63;
+    case 'Q': return value > -1.0 && value < 0x1p64;
+    case 'f': return isnan(value) || isinf(value) || fabs(value) <= FLT_MAX;
+    default: return true;
+  }
+}
+
+static inline void array_set_item(unsigned char *data, char type, int index, double value) {
+#define SET_ITEM(t) ((t *) data)[index] = (t) value
+  ARRAY_DISPATCH(type, SET_ITEM)
+#undef SET_ITEM
+}
+
+/**
+ * grows the bytes so that it holds at least count items. new items are zero.
+ */
+static bool array_ensure_length(b_vm *vm, b_obj_bytes *bytes, int item_size, int count) {
+  // every caller writes into the array afterwards.
+  unshare_bytes(vm, bytes);
+
+  int length = count * item_size;
+  if (bytes->bytes.count >= length) {
+    return true;
+  }
+
+  unsigned char *data = GROW_ARRAY(unsigned char, bytes->bytes.bytes, bytes->bytes.count, length);
+  if (data == NULL) {
+    return false;
+  }
+
+  memset(data + bytes->bytes.count, 0, length - bytes->bytes.count);
+  bytes->bytes.bytes = data;
+  bytes->bytes.count = length;
+  return true;
+}
+
+static inline void array_bounds(int count, b_value *args, int arg_count, int first, int *start, int *end) {
+  *start = 0;
+  *end = count;
+
+  if (arg_count > first && IS_NUMBER(args[first])) {
+    *start = (int) AS_NUMBER(args[first]);
+    if (*start < 0) *start += count;
+  }
+  if (arg_count > first + 1 && IS_NUMBER(args[first + 1])) {
+    *end = (int) AS_NUMBER(args[first + 1]);
+    if (*end < 0) *end += count;
+  }
+
+  if (*start < 0) *start = 0;
+  if (*end > count) *end = count;
+  if (*start > *end) *start = *end;
+}
+
+/**
+ * fromlist(type: string, items: list)
+ */
+DECLARE_MODULE_METHOD(array__fromlist) {
+  ENFORCE_ARG_COUNT(fromlist, 2);
+  ENFORCE_ARRAY_TYPE(fromlist, 0);
+  ENFORCE_ARG_TYPE(fromlist, 1, IS_LIST);
+
+  b_obj_list *list = AS_LIST(args[1]);
+  for (int i = 0; i < list->items.count; i++) {
+    if (!IS_NUMBER(list->items.values[i])) {
+      RETURN_VALUE_ERROR("invalid array value");
+    }
+    ENFORCE_ARRAY_VALUE(AS_NUMBER(list->items.values[i]));
+  }
+
+  b_obj_bytes *bytes = (b_obj_bytes *) GC(new_bytes(vm, list->items.count * item_size));
+  for (int i = 0; i < list->items.count; i++) {
+    array_set_item(bytes->bytes.bytes, type, i, AS_NUMBER(list->items.values[i]));
+  }
+
+  RETURN_OBJ(bytes);
+}
+
+/**
+ * tolist(data: bytes, type: string)
+ */
+DECLARE_MODULE_METHOD(array__tolist) {
+  ENFORCE_ARG_COUNT(tolist, 2);
+  ENFORCE_ARG_TYPE(tolist, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(tolist, 1);
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int count = bytes->bytes.count / item_size;
+
+  b_obj_list *list = (b_obj_list *) GC(new_list(vm));
+  for (int i = 0; i < count; i++) {
+    write_value_arr(vm, &list->items, NUMBER_VAL(array_get_item(bytes->bytes.bytes, type, i)));
+  }
+
+  RETURN_OBJ(list);
+}
+
+/**
+ * get(data: bytes, type: string, index: number)
+ */
+DECLARE_MODULE_METHOD(array__get) {
+  ENFORCE_ARG_COUNT(get, 3);
+  ENFORCE_ARG_TYPE(get, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(get, 1);
+  ENFORCE_ARG_TYPE(get, 2, IS_NUMBER);
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int index = (int) AS_NUMBER(args[2]);
+  if (index < 0 || index >= bytes->bytes.count / item_size) {
+    RETURN_NIL;
+  }
+
+  RETURN_NUMBER(array_get_item(bytes->bytes.bytes, type, index));
+}
+
+/**
+ * set(data: bytes, type: string, index: number, value: number)
+ *
+ * grows the array with zeros if index is past its end.
+ */
+DECLARE_MODULE_METHOD(array__set) {
+  ENFORCE_ARG_COUNT(set, 4);
+  ENFORCE_ARG_TYPE(set, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(set, 1);
+  ENFORCE_ARG_TYPE(set, 2, IS_NUMBER);
+  ENFORCE_ARG_TYPE(set, 3, IS_NUMBER);
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int index = (int) AS_NUMBER(args[2]);
+  if (index < 0) {
+    RETURN_RANGE_ERROR("array index %d out of range", index);
+  }
+  ENFORCE_ARRAY_VALUE(AS_NUMBER(args[3]));
+
+  if (!array_ensure_length(vm, bytes, item_size, index + 1)) {
+    RETURN_ERROR("out of memory");
+  }
+
+  array_set_item(bytes->bytes.bytes, type, index, AS_NUMBER(args[3]));
+  RETURN_VALUE(args[3]);
+}
+
+/**
+ * append(data: bytes, type: string, value: number)
+ */
+DECLARE_MODULE_METHOD(array__append) {
+  ENFORCE_ARG_COUNT(append, 3);
+  ENFORCE_ARG_TYPE(append, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(append, 1);
+  ENFORCE_ARG_TYPE(append, 2, IS_NUMBER);
+  ENFORCE_ARRAY_VALUE(AS_NUMBER(args[2]));
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int index = bytes->bytes.count / item_size;
+  if (!array_ensure_length(vm, bytes, item_size, index + 1)) {
+    RETURN_ERROR("out of memory");
+  }
+
+  array_set_item(bytes->bytes.bytes, type, index, AS_NUMBER(args[2]));
+  RETURN;
+}
+
+/**
+ * pop(data: bytes, type: string)
+ *
+ * removes the last item of the array and returns it or nil if the array is
+ * empty.
+ */
+DECLARE_MODULE_METHOD(array__pop) {
+  ENFORCE_ARG_COUNT(pop, 2);
+  ENFORCE_ARG_TYPE(pop, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(pop, 1);
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int count = bytes->bytes.count / item_size;
+  if (count == 0) {
+    RETURN_NIL;
+  }
+
+  double value = array_get_item(bytes->bytes.bytes, type, count - 1);
+  bytes->bytes.count = (count - 1) * item_size;
+  RETURN_NUMBER(value);
+}
+
+/**
+ * fill(data: bytes, type: string, value: number [, start: number [, end: number]])
+ */
+DECLARE_MODULE_METHOD(array__fill) {
+  ENFORCE_ARG_RANGE(fill, 3, 5);
+  ENFORCE_ARG_TYPE(fill, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(fill, 1);
+  ENFORCE_ARG_TYPE(fill, 2, IS_NUMBER);
+  ENFORCE_ARRAY_VALUE(AS_NUMBER(args[2]));
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int start, end;
+  array_bounds(bytes->bytes.count / item_size, args, arg_count, 3, &start, &end);
+
+  // write the first item and let the typed loop replicate it.
+  if (start < end) {
+    unshare_bytes(vm, bytes);
+    array_set_item(bytes->bytes.bytes, type, start, AS_NUMBER(args[2]));
+
+#define FILL_ITEMS(t) do { \
+    t *items = (t *) bytes->bytes.bytes; \
+    t value = items[start]; \
+    for (int i = start + 1; i < end; i++) items[i] = value; \
+  } while (0)
+    ARRAY_DISPATCH(type, FILL_ITEMS)
+#undef FILL_ITEMS
+  }
+
+  RETURN;
+}
+
+/**
+ * slice(data: bytes, type: string [, start: number [, end: number]])
+ *
+ * returns the bytes for the items between start and end.
+ */
+DECLARE_MODULE_METHOD(array__slice) {
+  ENFORCE_ARG_RANGE(slice, 2, 4);
+  ENFORCE_ARG_TYPE(slice, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(slice, 1);
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int start, end;
+  array_bounds(bytes->bytes.count / item_size, args, arg_count, 2, &start, &end);
+
+  RETURN_OBJ(copy_bytes(vm, bytes->bytes.bytes + start * item_size, (end - start) * item_size));
+}
+
+/**
+ * copy(dest: bytes, type: string, at: number, source: bytes)
+ *
+ * copies the items of source into dest starting at item index at, growing
+ * dest when required.
+ */
+DECLARE_MODULE_METHOD(array__copy) {
+  ENFORCE_ARG_COUNT(copy, 4);
+  ENFORCE_ARG_TYPE(copy, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(copy, 1);
+  ENFORCE_ARG_TYPE(copy, 2, IS_NUMBER);
+  ENFORCE_ARG_TYPE(copy, 3, IS_BYTES);
+
+  b_obj_bytes *dest = AS_BYTES(args[0]);
+  b_obj_bytes *source = AS_BYTES(args[3]);
+  int at = (int) AS_NUMBER(args[2]);
+  int count = source->bytes.count / item_size;
+
+  if (at < 0) {
+    RETURN_RANGE_ERROR("array index %d out of range", at);
+  }
+
+  if (!array_ensure_length(vm, dest, item_size, at + count)) {
+    RETURN_ERROR("out of memory");
+  }
+
+  memmove(dest->bytes.bytes + at * item_size, source->bytes.bytes, count * item_size);
+  RETURN;
+}
+
+/**
+ * reverse(data: bytes, type: string)
+ *
+ * returns the bytes for the items in reverse order.
+ */
+DECLARE_MODULE_METHOD(array__reverse) {
+  ENFORCE_ARG_COUNT(reverse, 2);
+  ENFORCE_ARG_TYPE(reverse, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(reverse, 1);
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int count = bytes->bytes.count / item_size;
+  b_obj_bytes *result = (b_obj_bytes *) GC(new_bytes(vm, count * item_size));
+
+#define REVERSE_ITEMS(t) do { \
+    const t *from = (const t *) bytes->bytes.bytes; \
+    t *to = (t *) result->bytes.bytes; \
+    for (int i = 0; i < count; i++) to[i] = from[count - i - 1]; \
+  } while (0)
+  ARRAY_DISPATCH(type, REVERSE_ITEMS)
+#undef REVERSE_ITEMS
+
+  RETURN_OBJ(result);
+}
+
+/**
+ * sum(data: bytes, type: string)
+ */
+DECLARE_MODULE_METHOD(array__sum) {
+  ENFORCE_ARG_COUNT(sum, 2);
+  ENFORCE_ARG_TYPE(sum, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(sum, 1);
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int count = bytes->bytes.count / item_size;
+  double sum = 0;
+
+  // integers are summed in 64-bit so that the loop can be vectorized.
+#define SUM_INTEGERS(t) do { \
+    const t *items = (const t *) bytes->bytes.bytes; \
+    int64_t total = 0; \
+    for (int i = 0; i < count; i++) total += items[i]; \
+    sum = (double) total; \
+  } while (0)
+#define SUM_FLOATS(t) do { \
+    const t *items = (const t *) bytes->bytes.bytes; \
+    for (int i = 0; i < count; i++) sum += items[i]; \
+  } while (0)
+
+  switch (type) {
+    case 's': SUM_INTEGERS(int16_t); break;
+    case 'S': SUM_INTEGERS(uint16_t); break;
+    case 'l': SUM_INTEGERS(int32_t); break;
+    case 'L': SUM_INTEGERS(uint32_t); break;
+    case 'q': SUM_FLOATS(int64_t); break;
+    case 'Q': SUM_FLOATS(uint64_t); break;
+    case 'f': SUM_FLOATS(float); break;
+    case 'd': SUM_FLOATS(double); break;
+    default: break;
+  }
+
+#undef SUM_INTEGERS
+#undef SUM_FLOATS
+
+  RETURN_NUMBER(sum);
+}
+
+static double array_extreme(const b_obj_bytes *bytes, char type, int count, bool max) {
+  double result = 0;
+
+#define EXTREME(t) do { \
+    const t *items = (const t *) bytes->bytes.bytes; \
+    t value = items[0]; \
+    if (max) { \
+      for (int i = 1; i < count; i++) value = items[i] > value ? items[i] : value; \
+    } else { \
+      for (int i = 1; i < count; i++) value = items[i] < value ? items[i] : value; \
+    } \
+    result = (double) value; \
+  } while (0)
+  ARRAY_DISPATCH(type, EXTREME)
+#undef EXTREME
+
+  return result;
+}
+
+/**
+ * min(data: bytes, type: string)
+ */
+DECLARE_MODULE_METHOD(array__min) {
+  ENFORCE_ARG_COUNT(min, 2);
+  ENFORCE_ARG_TYPE(min, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(min, 1);
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int count = bytes->bytes.count / item_size;
+  if (count == 0) {
+    RETURN_NIL;
+  }
+
+  RETURN_NUMBER(array_extreme(bytes, type, count, false));
+}
+
+/**
+ * max(data: bytes, type: string)
+ */
+DECLARE_MODULE_METHOD(array__max) {
+  ENFORCE_ARG_COUNT(max, 2);
+  ENFORCE_ARG_TYPE(max, 0, IS_BYTES);
+  ENFORCE_ARRAY_TYPE(max, 1);
+
+  b_obj_bytes *bytes = AS_BYTES(args[0]);
+  int count = bytes->bytes.count / item_size;
+  if (count == 0) {
+    RETURN_NIL;
+  }
+
+  RETURN_NUMBER(array_extreme(bytes, type, count, true));
+}
+
+CREATE_MODULE_LOADER(array) {
+  static b_func_reg module_functions[] = {
+      {"fromlist", true,  GET_MODULE_METHOD(array__fromlist)},
+      {"tolist",   true,  GET_MODULE_METHOD(array__tolist)},
+      {"get",      true,  GET_MODULE_METHOD(array__get)},
+      {"set",      true,  GET_MODULE_METHOD(array__set)},
+      {"append",   true,  GET_MODULE_METHOD(array__append)},
+      {"pop",      true,  GET_MODULE_METHOD(array__pop)},
+      {"fill",     true,  GET_MODULE_METHOD(array__fill)},
+      {"slice",    true,  GET_MODULE_METHOD(array__slice)},
+      {"copy",     true,  GET_MODULE_METHOD(array__copy)},
+      {"reverse",  true,  GET_MODULE_METHOD(array__reverse)},
+      {"sum",      true,  GET_MODULE_METHOD(array__sum)},
+      {"min",      true,  GET_MODULE_METHOD(array__min)},
+      {"max",      true,  GET_MODULE_METHOD(array__max)},
+      {NULL,       false, NULL},
+  };
+
+  static b_module_reg module = {
+      .name = "_array",
+      .fields = NULL,
+      .functions = module_functions,
+      .classes = NULL,
+      .preloader = NULL,
+      .unloader = NULL
+  };
+
+  return &module;
+}
+
+#undef ARRAY_DISPATCH
+#undef ENFORCE_ARRAY_TYPE
@@ -0,0 +1,266 @@
+#include "module.h"
+
+/**
+ * Heaps are stored in lists as implicit binary min-heaps: the children of
+ * the item at index i live at 2i + 1 and 2i + 2. Items are ordered with
+ * compare_values() unless a comparator function is given, in which case
+ * comparator(a, b) answers whether a sorts after b, the same way it does
+ * for list.sort(). The comparator may be a closure, a bound method or a
+ * native function, the same functions is_function() accepts.
+ *
+ * Items are only ever swapped so that every value stays inside the list
+ * (and visible to the GC) while a comparator runs.
+ */
+
+typedef struct {
+  b_vm *vm;
+  b_obj_list *items;
+  b_value comparator;
+  b_obj_list *args;
+  int count;
+} b_heap;
+
+static b_value heap_call(b_heap *heap) {
+  b_vm *vm = heap->vm;
+  b_value *stack_top = vm->stack_top;
+  b_value result;
+
+  if (IS_BOUND(heap->comparator)) {
+    // the receiver takes the place of the method as self.
+    b_obj_bound *bound = AS_BOUND(heap->comparator);
+    push(vm, bound->receiver);
+    result = raw_closure_call(vm, bound->method, heap->args, false);
+  } else if (IS_NATIVE(heap->comparator)) {
+    // the native clears its own GC protection, not the one of this call.
+    b_call_frame *frame = &vm->frames[vm->frame_count > 0 ? vm->frame_count - 1 : 0];
+    int gc_protected = frame->gc_protected;
+    frame->gc_protected = 0;
+
+    push(vm, heap->comparator);
+    push(vm, heap->args->items.values[0]);
+    push(vm, heap->args->items.values[1]);
+
+    // errors end the program the same way they do for closures.
+    if (!AS_NATIVE(heap->comparator)->function(vm, 2, stack_top + 1)) {
+      exit(EXIT_RUNTIME);
+    }
+    CLEAR_GC();
+
+    result = stack_top[0];
+    frame->gc_protected = gc_protected;
+  } else {
+    result = call_closure(vm, AS_CLOSURE(heap->comparator), heap->args);
+  }
+
+  vm->stack_top = stack_top;
+  return result;
+}
+
+static bool heap_greater(b_heap *heap, b_value a, b_value b) {
+  if (IS_NIL(heap->comparator)) {
+    return compare_values(a, b) > 0;
+  }
+
+  heap->args->items.values[0] = a;
+  heap->args->items.values[1] = b;
+
+  b_value result = heap_call(heap);
+  if (IS_NUMBER(result)) {
+    return AS_NUMBER(result) > 0;
+  }
+  return !is_false(result);
+}
+
+static inline void heap_swap(b_value *values, int a, int b) {
+  b_value tmp = values[a];
+  values[a] = values[b];
+  values[b] = tmp;
+}
+
+/**
+ * returns false if the list was resized by the comparator.
+ */
+static bool heap_sift_up(b_heap *heap, int index) {
+  while (index > 0) {
+    int parent = (index - 1) / 2;
+    bool greater = heap_greater(heap, heap->items->items.values[parent], heap->items->items.values[index]);
+    if (heap->items->items.count != heap->count) return false;
+    if (!greater) break;
+
+    heap_swap(heap->items->items.values, parent, index);
+    index = parent;
+  }
+  return true;
+}
+
+/**
+ * restores the heap below index considering only the first count items.
+ */
+static bool heap_sift_down(b_heap *heap, int index, int count) {
+  for (;;) {
+    int smallest = index;
+    int left = 2 * index + 1, right = left + 1;
+
+    if (left < count) {
+      bool greater = heap_greater(heap, heap->items->items.values[smallest], heap->items->items.values[left]);
+      if (heap->items->items.count != heap->count) return false;
+      if (greater) smallest = left;
+    }
+
+    if (right < count) {
+      bool greater = heap_greater(heap, heap->items->items.values[smallest], heap->items->items.values[right]);
+      if (heap->items->items.count != heap->count) return false;
+      if (greater) smallest = right;
+    }
+
+    if (smallest == index) return true;
+
+    heap_swap(heap->items->items.values, index, smallest);
+    index = smallest;
+  }
+}
+
+#define ENFORCE_HEAP_ARGS(name, min, max) \
+  ENFORCE_ARG_RANGE(name, min, max); \
+  ENFORCE_ARG_TYPE(name, 0, IS_LIST); \
+  b_heap heap = {vm, AS_LIST(args[0]), NIL_VAL, NULL, AS_LIST(args[0])->items.count}; \
+  if (arg_count == max && !IS_NIL(args[max - 1])) { \
+    b_value _comparator = args[max - 1]; \
+    if (!IS_CLOSURE(_comparator) && !IS_BOUND(_comparator) && !IS_NATIVE(_comparator)) { \
+      RETURN_TYPE_ERROR(#name "() expects argument %d as function, %s given", \
+                        max, value_type(_comparator)); \
+    } \
+    heap.comparator = _comparator; \
+    heap.args = (b_obj_list *) GC(new_list(vm)); \
+    write_value_arr(vm, &heap.args->items, NIL_VAL); \
+    write_value_arr(vm, &heap.args->items, NIL_VAL); \
+  }
+
+#define HEAP_MODIFIED_ERROR(name) \
+  RETURN_VALUE_ERROR("heap modified during " #name "()")
+
+/**
+ * push(items: list, value: any [, comparator: function])
+ */
+DECLARE_MODULE_METHOD(heap__push) {
+  ENFORCE_HEAP_ARGS(push, 2, 3);
+
+  write_value_arr(vm, &heap.items->items, args[1]);
+  heap.count++;
+
+  if (!heap_sift_up(&heap, heap.count - 1)) {
+    HEAP_MODIFIED_ERROR(push);
+  }
+  RETURN;
+}
+
+/**
+ * pop(items: list [, comparator: function])
+ *
+ * removes and returns the smallest item or nil if the heap is empty.
+ */
+DECLARE_MODULE_METHOD(heap__pop) {
+  ENFORCE_HEAP_ARGS(pop, 1, 2);
+
+  if (heap.count == 0) {
+    RETURN_NIL;
+  }
+
+  // the smallest item waits at the end of the list until the heap is fixed.
+  heap_swap(heap.items->items.values, 0, heap.count - 1);
+  if (!heap_sift_down(&heap, 0, heap.count - 1)) {
+    HEAP_MODIFIED_ERROR(pop);
+  }
+
+  RETURN_VALUE(heap.items->items.values[--heap.items->items.count]);
+}
+
+/**
+ * pushpop(items: list, value: any [, comparator: function])
+ *
+ * pushes value and then pops the smallest item in one pass.
+ */
+DECLARE_MODULE_METHOD(heap__pushpop) {
+  ENFORCE_HEAP_ARGS(pushpop, 2, 3);
+
+  if (heap.count == 0) {
+    RETURN_VALUE(args[1]);
+  }
+
+  // when value sorts before the root, it would be popped right away.
+  bool greater = heap_greater(&heap, args[1], heap.items->items.values[0]);
+  if (heap.items->items.count != heap.count) {
+    HEAP_MODIFIED_ERROR(pushpop);
+  }
+  if (!greater) {
+    RETURN_VALUE(args[1]);
+  }
+
+  // keep the old root on the list while the heap is fixed.
+  write_value_arr(vm, &heap.items->items, heap.items->items.values[0]);
+  heap.count++;
+  heap.items->items.values[0] = args[1];
+
+  if (!heap_sift_down(&heap, 0, heap.count - 1)) {
+    HEAP_MODIFIED_ERROR(pushpop);
+  }
+
+  RETURN_VALUE(heap.items->items.values[--heap.items->items.count]);
+}
+
+/**
+ * peek(items: list)
+ */
+DECLARE_MODULE_METHOD(heap__peek) {
+  ENFORCE_ARG_COUNT(peek, 1);
+  ENFORCE_ARG_TYPE(peek, 0, IS_LIST);
+
+  b_obj_list *items = AS_LIST(args[0]);
+  if (items->items.count == 0) {
+    RETURN_NIL;
+  }
+
+  RETURN_VALUE(items->items.values[0]);
+}
+
+/**
+ * heapify(items: list [, comparator: function])
+ *
+ * rearranges the list into a heap in O(n).
+ */
+DECLARE_MODULE_METHOD(heap__heapify) {
+  ENFORCE_HEAP_ARGS(heapify, 1, 2);
+
+  for (int i = heap.count / 2 - 1; i >= 0; i--) {
+    if (!heap_sift_down(&heap, i, heap.count)) {
+      HEAP_MODIFIED_ERROR(heapify);
+    }
+  }
+
+  RETURN_VALUE(args[0]);
+}
+
+CREATE_MODULE_LOADER(heap) {
+  static b_func_reg module_functions[] = {
+      {"push",    true,  GET_MODULE_METHOD(heap__push)},
+      {"pop",     true,  GET_MODULE_METHOD(heap__pop)},
+      {"pushpop", true,  GET_MODULE_METHOD(heap__pushpop)},
+      {"peek",    true,  GET_MODULE_METHOD(heap__peek)},
+      {"heapify", true,  GET_MODULE_METHOD(heap__heapify)},
+      {NULL,      false, NULL},
+  };
+
+  static b_module_reg module = {
+      .name = "_heap",
+      .fields = NULL,
+      .functions = module_functions,
+      .classes = NULL,
+      .preloader = NULL,
+      .unloader = NULL
+  };
+
+  return &module;
+}
+
+#undef ENFORCE_HEAP_ARGS
+#undef HEAP_MODIFIED_ERROR
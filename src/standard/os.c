@@ -317,8 +317,7 @@ static int remove_directory(char *path, int path_length, bool recursive) {
     while((ent = readdir(dir)) != NULL) {
 
       // skip . and .. in path
-      if (memcmp(ent->d_name, ".", (int)strlen(ent->d_name)) == 0
-      || memcmp(ent->d_name, "..", (int)strlen(ent->d_name)) == 0) {
+      if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0) {
         continue;
       }
 
@@ -423,7 +422,13 @@ DECLARE_MODULE_METHOD(os__realpath) {
 DECLARE_MODULE_METHOD(os__chdir) {
   ENFORCE_ARG_COUNT(chdir, 1);
   ENFORCE_ARG_TYPE(chdir, 0, IS_STRING);
-  RETURN_BOOL(chdir(AS_STRING(args[0])->chars) == 0);
+  if (chdir(AS_STRING(args[0])->chars) != 0) {
+    RETURN_FALSE;
+  }
+
+  // imports are resolved against the working directory.
+  free_import_cache(vm);
+  RETURN_TRUE;
 }
 
 DECLARE_MODULE_METHOD(os__exists) {
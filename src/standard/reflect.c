@@ -1,5 +1,6 @@
 #include "module.h"
 #include "compiler.h"
+#include "bytecode.h"
 
 /**
  * hasprop(object: instance | module, name: string)
@@ -319,6 +320,8 @@ DECLARE_MODULE_METHOD(reflect__getptr) {
         RETURN_PTR(AS_STRING(args[0])->chars);
       }
       case OBJ_BYTES: {
+        // the pointer may be written through.
+        unshare_bytes(vm, AS_BYTES(args[0]));
         RETURN_PTR(AS_BYTES(args[0])->bytes.bytes);
       }
       case OBJ_FILE: {
@@ -357,6 +360,7 @@ DECLARE_MODULE_METHOD(reflect__getaddress) {
         RETURN_NUMBER((uintptr_t)AS_STRING(args[0])->chars);
       }
       case OBJ_BYTES: {
+        unshare_bytes(vm, AS_BYTES(args[0]));
         RETURN_NUMBER((uintptr_t)AS_BYTES(args[0])->bytes.bytes);
       }
       case OBJ_LIST: {
@@ -416,6 +420,7 @@ DECLARE_MODULE_METHOD(reflect__set_ptr_value) {
         AS_PTR(args[0])->pointer = AS_STRING(args[1])->chars;
       }
       case OBJ_BYTES: {
+        unshare_bytes(vm, AS_BYTES(args[1]));
         AS_PTR(args[0])->pointer = AS_BYTES(args[1])->bytes.bytes;
       }
       case OBJ_FILE: {
@@ -450,6 +455,54 @@ DECLARE_MODULE_METHOD(reflect__set_ptr_value) {
   RETURN;
 }
 
+/**
+ * makeimage(image: string, directory: string, files: list)
+ *
+ * compiles the files of the library directory into a bytecode image and
+ * returns true if the image was written or false otherwise.
+ */
+DECLARE_MODULE_METHOD(reflect__makeimage) {
+  ENFORCE_ARG_COUNT(makeimage, 3);
+  ENFORCE_ARG_TYPE(makeimage, 0, IS_STRING);
+  ENFORCE_ARG_TYPE(makeimage, 1, IS_STRING);
+  ENFORCE_ARG_TYPE(makeimage, 2, IS_LIST);
+
+  b_obj_list *list = AS_LIST(args[2]);
+  char **files = (char **) malloc(sizeof(char *) * (list->items.count + 1));
+  if (files == NULL) {
+    RETURN_ERROR("out of memory");
+  }
+
+  int count = 0;
+  for (int i = 0; i < list->items.count; i++) {
+    if (IS_STRING(list->items.values[i])) {
+      files[count++] = AS_C_STRING(list->items.values[i]);
+    }
+  }
+
+  bool saved = save_bytecode_image(vm, AS_C_STRING(args[0]), AS_C_STRING(args[1]), files, count);
+  free(files);
+  RETURN_BOOL(saved);
+}
+
+/**
+ * snapshot(path: string)
+ *
+ * saves the state of the program to the file and returns false or returns
+ * true when the program is resumed from the file.
+ */
+DECLARE_MODULE_METHOD(reflect__snapshot) {
+  ENFORCE_ARG_COUNT(snapshot, 1);
+  ENFORCE_ARG_TYPE(snapshot, 0, IS_STRING);
+
+  char error[256];
+  if (!save_snapshot(vm, AS_C_STRING(args[0]), arg_count, error, sizeof(error))) {
+    RETURN_ERROR("cannot save snapshot: %s", error);
+  }
+
+  RETURN_FALSE;
+}
+
 CREATE_MODULE_LOADER(reflect) {
   static b_func_reg module_functions[] = {
       {"hasprop",   true,  GET_MODULE_METHOD(reflect__hasprop)},
@@ -471,6 +524,8 @@ CREATE_MODULE_LOADER(reflect) {
       {"getclass", true,  GET_MODULE_METHOD(reflect__getclass)},
       {"setglobal", true,  GET_MODULE_METHOD(reflect__setglobal)},
       {"runscript", true,  GET_MODULE_METHOD(reflect__runscript)},
+      {"makeimage", true,  GET_MODULE_METHOD(reflect__makeimage)},
+      {"snapshot", true,  GET_MODULE_METHOD(reflect__snapshot)},
       {"valueatdistance", true,  GET_MODULE_METHOD(reflect__valueatdistance)},
       {"getaddress", true,  GET_MODULE_METHOD(reflect__getaddress)},
       {"ptrfromaddress", true,  GET_MODULE_METHOD(reflect__ptr_from_address)},
@@ -0,0 +1,318 @@
+#include "module.h"
+
+/**
+ * Sets are stored in dictionaries whose keys are the members of the set in
+ * insertion order. This gives O(1) membership tests through the dictionary's
+ * hash table while the names list keeps iteration order stable.
+ */
+
+static inline bool set_contains(b_obj_dict *set, b_value value) {
+  b_value dummy;
+  return table_get(&set->items, value, &dummy);
+}
+
+static inline bool set_add(b_vm *vm, b_obj_dict *set, b_value value) {
+  if (set_contains(set, value)) {
+    return false;
+  }
+
+  write_value_arr(vm, &set->names, value);
+  table_set(vm, &set->items, value, TRUE_VAL);
+  return true;
+}
+
+static inline void set_add_all(b_vm *vm, b_obj_dict *set, b_value_arr *values) {
+  for (int i = 0; i < values->count; i++) {
+    set_add(vm, set, values->values[i]);
+  }
+}
+
+static inline b_obj_dict *smaller_set(b_obj_dict *a, b_obj_dict *b) {
+  return a->names.count <= b->names.count ? a : b;
+}
+
+/**
+ * create([items: list | dict])
+ *
+ * returns a new set storage containing the unique items of the list or the
+ * keys of the dictionary.
+ */
+DECLARE_MODULE_METHOD(set__create) {
+  ENFORCE_ARG_RANGE(create, 0, 1);
+
+  b_obj_dict *set = (b_obj_dict *) GC(new_dict(vm));
+
+  if (arg_count == 1 && !IS_NIL(args[0])) {
+    ENFORCE_ARG_TYPES(create, 0, IS_LIST, IS_DICT);
+
+    if (IS_LIST(args[0])) {
+      set_add_all(vm, set, &AS_LIST(args[0])->items);
+    } else {
+      set_add_all(vm, set, &AS_DICT(args[0])->names);
+    }
+  }
+
+  RETURN_OBJ(set);
+}
+
+/**
+ * add(set: dict, value: any)
+ *
+ * adds value to the set and returns true if it was not already a member.
+ */
+DECLARE_MODULE_METHOD(set__add) {
+  ENFORCE_ARG_COUNT(add, 2);
+  ENFORCE_ARG_TYPE(add, 0, IS_DICT);
+  RETURN_BOOL(set_add(vm, AS_DICT(args[0]), args[1]));
+}
+
+/**
+ * addall(set: dict, values: list)
+ *
+ * adds every item in values to the set and returns the number of new members.
+ */
+DECLARE_MODULE_METHOD(set__addall) {
+  ENFORCE_ARG_COUNT(addall, 2);
+  ENFORCE_ARG_TYPE(addall, 0, IS_DICT);
+  ENFORCE_ARG_TYPE(addall, 1, IS_LIST);
+
+  b_obj_dict *set = AS_DICT(args[0]);
+  int count = set->names.count;
+  set_add_all(vm, set, &AS_LIST(args[1])->items);
+  RETURN_NUMBER(set->names.count - count);
+}
+
+/**
+ * contains(set: dict, value: any)
+ */
+DECLARE_MODULE_METHOD(set__contains) {
+  ENFORCE_ARG_COUNT(contains, 2);
+  ENFORCE_ARG_TYPE(contains, 0, IS_DICT);
+  RETURN_BOOL(set_contains(AS_DICT(args[0]), args[1]));
+}
+
+/**
+ * remove(set: dict, value: any)
+ *
+ * removes value from the set and returns true if it was a member.
+ */
+DECLARE_MODULE_METHOD(set__remove) {
+  ENFORCE_ARG_COUNT(remove, 2);
+  ENFORCE_ARG_TYPE(remove, 0, IS_DICT);
+
+  b_obj_dict *set = AS_DICT(args[0]);
+  if (!table_delete(&set->items, args[1])) {
+    RETURN_FALSE;
+  }
+
+  b_value_arr *names = &set->names;
+  for (int i = 0; i < names->count; i++) {
+    if (values_equal(names->values[i], args[1])) {
+      if (i == 0) {
+        shift_value_arr(names, 1);
+      } else {
+        memmove(names->values + i, names->values + i + 1,
+                (names->count - i - 1) * sizeof(b_value));
+        names->count--;
+      }
+      break;
+    }
+  }
+
+  RETURN_TRUE;
+}
+
+/**
+ * at(set: dict, index: number)
+ *
+ * returns the member at the given insertion index or nil.
+ */
+DECLARE_MODULE_METHOD(set__at) {
+  ENFORCE_ARG_COUNT(at, 2);
+  ENFORCE_ARG_TYPE(at, 0, IS_DICT);
+  ENFORCE_ARG_TYPE(at, 1, IS_NUMBER);
+
+  b_obj_dict *set = AS_DICT(args[0]);
+  int index = AS_NUMBER(args[1]);
+  if (index < 0 || index >= set->names.count) {
+    RETURN_NIL;
+  }
+
+  RETURN_VALUE(set->names.values[index]);
+}
+
+/**
+ * union(a: dict, b: dict)
+ */
+DECLARE_MODULE_METHOD(set__union) {
+  ENFORCE_ARG_COUNT(union, 2);
+  ENFORCE_ARG_TYPE(union, 0, IS_DICT);
+  ENFORCE_ARG_TYPE(union, 1, IS_DICT);
+
+  b_obj_dict *set = (b_obj_dict *) GC(new_dict(vm));
+  set_add_all(vm, set, &AS_DICT(args[0])->names);
+  set_add_all(vm, set, &AS_DICT(args[1])->names);
+  RETURN_OBJ(set);
+}
+
+/**
+ * intersect(a: dict, b: dict)
+ */
+DECLARE_MODULE_METHOD(set__intersect) {
+  ENFORCE_ARG_COUNT(intersect, 2);
+  ENFORCE_ARG_TYPE(intersect, 0, IS_DICT);
+  ENFORCE_ARG_TYPE(intersect, 1, IS_DICT);
+
+  b_obj_dict *a = AS_DICT(args[0]), *b = AS_DICT(args[1]);
+  b_obj_dict *set = (b_obj_dict *) GC(new_dict(vm));
+
+  for (int i = 0; i < a->names.count; i++) {
+    if (set_contains(b, a->names.values[i])) {
+      set_add(vm, set, a->names.values[i]);
+    }
+  }
+
+  RETURN_OBJ(set);
+}
+
+/**
+ * difference(a: dict, b: dict)
+ */
+DECLARE_MODULE_METHOD(set__difference) {
+  ENFORCE_ARG_COUNT(difference, 2);
+  ENFORCE_ARG_TYPE(difference, 0, IS_DICT);
+  ENFORCE_ARG_TYPE(difference, 1, IS_DICT);
+
+  b_obj_dict *a = AS_DICT(args[0]), *b = AS_DICT(args[1]);
+  b_obj_dict *set = (b_obj_dict *) GC(new_dict(vm));
+
+  for (int i = 0; i < a->names.count; i++) {
+    if (!set_contains(b, a->names.values[i])) {
+      set_add(vm, set, a->names.values[i]);
+    }
+  }
+
+  RETURN_OBJ(set);
+}
+
+/**
+ * symmetricdifference(a: dict, b: dict)
+ */
+DECLARE_MODULE_METHOD(set__symmetric_difference) {
+  ENFORCE_ARG_COUNT(symmetricdifference, 2);
+  ENFORCE_ARG_TYPE(symmetricdifference, 0, IS_DICT);
+  ENFORCE_ARG_TYPE(symmetricdifference, 1, IS_DICT);
+
+  b_obj_dict *a = AS_DICT(args[0]), *b = AS_DICT(args[1]);
+  b_obj_dict *set = (b_obj_dict *) GC(new_dict(vm));
+
+  for (int i = 0; i < a->names.count; i++) {
+    if (!set_contains(b, a->names.values[i])) {
+      set_add(vm, set, a->names.values[i]);
+    }
+  }
+
+  for (int i = 0; i < b->names.count; i++) {
+    if (!set_contains(a, b->names.values[i])) {
+      set_add(vm, set, b->names.values[i]);
+    }
+  }
+
+  RETURN_OBJ(set);
+}
+
+/**
+ * isdisjoint(a: dict, b: dict)
+ */
+DECLARE_MODULE_METHOD(set__is_disjoint) {
+  ENFORCE_ARG_COUNT(isdisjoint, 2);
+  ENFORCE_ARG_TYPE(isdisjoint, 0, IS_DICT);
+  ENFORCE_ARG_TYPE(isdisjoint, 1, IS_DICT);
+
+  b_obj_dict *a = AS_DICT(args[0]), *b = AS_DICT(args[1]);
+  b_obj_dict *small = smaller_set(a, b), *large = small == a ? b : a;
+
+  for (int i = 0; i < small->names.count; i++) {
+    if (set_contains(large, small->names.values[i])) {
+      RETURN_FALSE;
+    }
+  }
+
+  RETURN_TRUE;
+}
+
+/**
+ * issubset(a: dict, b: dict)
+ *
+ * returns true if every member of a is also a member of b.
+ */
+DECLARE_MODULE_METHOD(set__is_subset) {
+  ENFORCE_ARG_COUNT(issubset, 2);
+  ENFORCE_ARG_TYPE(issubset, 0, IS_DICT);
+  ENFORCE_ARG_TYPE(issubset, 1, IS_DICT);
+
+  b_obj_dict *a = AS_DICT(args[0]), *b = AS_DICT(args[1]);
+  if (a->names.count > b->names.count) {
+    RETURN_FALSE;
+  }
+
+  for (int i = 0; i < a->names.count; i++) {
+    if (!set_contains(b, a->names.values[i])) {
+      RETURN_FALSE;
+    }
+  }
+
+  RETURN_TRUE;
+}
+
+/**
+ * equals(a: dict, b: dict)
+ */
+DECLARE_MODULE_METHOD(set__equals) {
+  ENFORCE_ARG_COUNT(equals, 2);
+  ENFORCE_ARG_TYPE(equals, 0, IS_DICT);
+  ENFORCE_ARG_TYPE(equals, 1, IS_DICT);
+
+  b_obj_dict *a = AS_DICT(args[0]), *b = AS_DICT(args[1]);
+  if (a->names.count != b->names.count) {
+    RETURN_FALSE;
+  }
+
+  for (int i = 0; i < a->names.count; i++) {
+    if (!set_contains(b, a->names.values[i])) {
+      RETURN_FALSE;
+    }
+  }
+
+  RETURN_TRUE;
+}
+
+CREATE_MODULE_LOADER(set) {
+  static b_func_reg module_functions[] = {
+      {"create",   true,  GET_MODULE_METHOD(set__create)},
+      {"add",   true,  GET_MODULE_METHOD(set__add)},
+      {"addall",   true,  GET_MODULE_METHOD(set__addall)},
+      {"contains",   true,  GET_MODULE_METHOD(set__contains)},
+      {"remove",   true,  GET_MODULE_METHOD(set__remove)},
+      {"at",   true,  GET_MODULE_METHOD(set__at)},
+      {"union",   true,  GET_MODULE_METHOD(set__union)},
+      {"intersect",   true,  GET_MODULE_METHOD(set__intersect)},
+      {"difference",   true,  GET_MODULE_METHOD(set__difference)},
+      {"symmetricdifference",   true,  GET_MODULE_METHOD(set__symmetric_difference)},
+      {"isdisjoint",   true,  GET_MODULE_METHOD(set__is_disjoint)},
+      {"issubset",   true,  GET_MODULE_METHOD(set__is_subset)},
+      {"equals",   true,  GET_MODULE_METHOD(set__equals)},
+      {NULL,    false, NULL},
+  };
+
+  static b_module_reg module = {
+      .name = "_set",
+      .fields = NULL,
+      .functions = module_functions,
+      .classes = NULL,
+      .preloader = NULL,
+      .unloader = NULL
+  };
+
+  return &module;
+}
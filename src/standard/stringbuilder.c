@@ -0,0 +1,197 @@
+#include "module.h"
+
+/**
+ * String builders keep their text in a growable buffer behind a pointer so
+ * that appending is amortized O(1). The buffer is handed over to the string
+ * or bytes created by tostring() and tobytes() without being copied, which
+ * leaves the builder empty.
+ *
+ * Builders may outlive the vm that created them (e.g. when a thread returns
+ * one) so the buffer is allocated outside the vm heap until it is handed
+ * over.
+ */
+
+typedef struct {
+  char *chars;
+  int length;
+  int capacity;
+  int utf8_length;
+} b_string_builder;
+
+static void free_string_builder(void *pointer) {
+  b_string_builder *builder = (b_string_builder *) pointer;
+  free(builder->chars);
+  free(builder);
+}
+
+static void string_builder_reserve(b_string_builder *builder, int size) {
+  if (builder->capacity - builder->length > size) {
+    return;
+  }
+
+  int capacity = GROW_CAPACITY(builder->capacity);
+  while (capacity - builder->length <= size) {
+    capacity = GROW_CAPACITY(capacity);
+  }
+
+  char *chars = (char *) realloc(builder->chars, capacity);
+  if (chars == NULL) {
+    OUT_OF_MEMORY();
+  }
+
+  builder->chars = chars;
+  builder->capacity = capacity;
+}
+
+static void string_builder_append(b_string_builder *builder, const char *chars, int length) {
+  string_builder_reserve(builder, length);
+  memcpy(builder->chars + builder->length, chars, length);
+  builder->length += length;
+}
+
+/**
+ * returns the text of the builder as a vm allocation of exactly length + 1
+ * bytes and empties the builder.
+ */
+static char *string_builder_release(b_vm *vm, b_string_builder *builder) {
+  // shrinking in place moves the buffer into the vm heap accounting.
+  char *chars = GROW_ARRAY(char, builder->chars, 0, builder->length + 1);
+  chars[builder->length] = '\0';
+
+  builder->chars = NULL;
+  builder->length = builder->capacity = builder->utf8_length = 0;
+  return chars;
+}
+
+#define AS_STRING_BUILDER(v) ((b_string_builder *) AS_PTR(v)->pointer)
+
+#define ENFORCE_STRING_BUILDER(name, count) \
+  ENFORCE_ARG_COUNT(name, count); \
+  ENFORCE_ARG_TYPE(name, 0, IS_PTR); \
+  b_string_builder *builder = AS_STRING_BUILDER(args[0])
+
+/**
+ * create([capacity: number])
+ */
+DECLARE_MODULE_METHOD(stringbuilder__create) {
+  ENFORCE_ARG_RANGE(create, 0, 1);
+
+  if (arg_count == 1) {
+    ENFORCE_ARG_TYPE(create, 0, IS_NUMBER);
+  }
+
+  b_string_builder *builder = (b_string_builder *) calloc(1, sizeof(b_string_builder));
+  if (builder == NULL) {
+    OUT_OF_MEMORY();
+  }
+
+  if (arg_count == 1 && AS_NUMBER(args[0]) > 0) {
+    string_builder_reserve(builder, (int) AS_NUMBER(args[0]));
+  }
+
+  RETURN_OBJ(new_closable_named_ptr(vm, builder, "<*StringBuilder>", free_string_builder));
+}
+
+/**
+ * append(builder: ptr, value: string | number | bytes | nil)
+ *
+ * appends the value and returns the new length of the text.
+ */
+DECLARE_MODULE_METHOD(stringbuilder__append) {
+  ENFORCE_STRING_BUILDER(append, 2);
+
+  if (IS_STRING(args[1])) {
+    b_obj_string *string = AS_STRING(args[1]);
+    string_builder_append(builder, string->chars, string->length);
+    builder->utf8_length += string->utf8_length;
+  } else if (IS_NUMBER(args[1])) {
+    char buffer[NUMBER_BUFFER_SIZE];
+    int length = format_number(AS_NUMBER(args[1]), buffer);
+    string_builder_append(builder, buffer, length);
+    builder->utf8_length += length;
+  } else if (IS_BYTES(args[1])) {
+    b_byte_arr *bytes = &AS_BYTES(args[1])->bytes;
+    string_builder_append(builder, (char *) bytes->bytes, bytes->count);
+    for (int i = 0; i < bytes->count; i++) {
+      if ((bytes->bytes[i] & 0xC0) != 0x80) builder->utf8_length++;
+    }
+  } else if (!IS_NIL(args[1])) {
+    ENFORCE_ARG_TYPES(append, 1, IS_STRING, IS_BYTES);
+  }
+
+  RETURN_NUMBER(builder->utf8_length);
+}
+
+/**
+ * length(builder: ptr)
+ */
+DECLARE_MODULE_METHOD(stringbuilder__length) {
+  ENFORCE_STRING_BUILDER(length, 1);
+  RETURN_NUMBER(builder->utf8_length);
+}
+
+/**
+ * clear(builder: ptr)
+ *
+ * empties the builder but keeps its buffer for reuse.
+ */
+DECLARE_MODULE_METHOD(stringbuilder__clear) {
+  ENFORCE_STRING_BUILDER(clear, 1);
+  builder->length = builder->utf8_length = 0;
+  RETURN;
+}
+
+/**
+ * tostring(builder: ptr)
+ *
+ * returns the text as a string and empties the builder.
+ */
+DECLARE_MODULE_METHOD(stringbuilder__tostring) {
+  ENFORCE_STRING_BUILDER(tostring, 1);
+
+  int length = builder->length;
+  char *chars = string_builder_release(vm, builder);
+  RETURN_T_STRING(chars, length);
+}
+
+/**
+ * tobytes(builder: ptr)
+ *
+ * returns the text as bytes and empties the builder.
+ */
+DECLARE_MODULE_METHOD(stringbuilder__tobytes) {
+  ENFORCE_STRING_BUILDER(tobytes, 1);
+
+  int length = builder->length;
+  char *chars = string_builder_release(vm, builder);
+
+  // bytes do not keep the string terminator.
+  chars = GROW_ARRAY(char, chars, length + 1, length);
+  RETURN_OBJ(take_bytes(vm, (unsigned char *) chars, length));
+}
+
+CREATE_MODULE_LOADER(stringbuilder) {
+  static b_func_reg module_functions[] = {
+      {"create",   true,  GET_MODULE_METHOD(stringbuilder__create)},
+      {"append",   true,  GET_MODULE_METHOD(stringbuilder__append)},
+      {"length",   true,  GET_MODULE_METHOD(stringbuilder__length)},
+      {"clear",    true,  GET_MODULE_METHOD(stringbuilder__clear)},
+      {"tostring", true,  GET_MODULE_METHOD(stringbuilder__tostring)},
+      {"tobytes",  true,  GET_MODULE_METHOD(stringbuilder__tobytes)},
+      {NULL,       false, NULL},
+  };
+
+  static b_module_reg module = {
+      .name = "_stringbuilder",
+      .fields = NULL,
+      .functions = module_functions,
+      .classes = NULL,
+      .preloader = NULL,
+      .unloader = NULL
+  };
+
+  return &module;
+}
+
+#undef AS_STRING_BUILDER
+#undef ENFORCE_STRING_BUILDER
@@ -240,6 +240,7 @@ b_vm *copy_vm(b_vm *src, uint64_t id) {
   vm->is_repl = src->is_repl;
   vm->show_warnings = src->show_warnings;
   vm->should_print_bytecode = src->should_print_bytecode;
+  vm->use_bytecode_cache = src->use_bytecode_cache;
   vm->should_exit_after_bytecode = src->should_exit_after_bytecode;
   vm->std_args = src->std_args;
   vm->std_args_count = src->std_args_count;
@@ -1,5 +1,15 @@
 #include "utf8.h"
 
+#if defined(__GNUC__) || defined(__clang__)
+#  if defined(__AVX2__)
+#    include <immintrin.h>
+#    define UTF8_SCAN_AVX2 1
+#  elif defined(__SSE2__)
+#    include <emmintrin.h>
+#    define UTF8_SCAN_SSE2 1
+#  endif
+#endif
+
 typedef struct {
   int val;
 } b_uf8_rule;
@@ -2918,6 +2928,65 @@ int utf8length(char *s) {
   return len;
 }
 
+/**
+ * returns the number of codepoints in the first length bytes of s and sets
+ * is_ascii when none of them is above 0x7F in the same pass. continuation
+ * bytes (0x80 to 0xBF) are exactly the bytes below -64 when read as signed,
+ * so the vector loops count them with a single signed compare per block.
+ */
+int utf8_scan(const char *s, int length, bool *is_ascii) {
+  int continuations = 0, i = 0;
+  unsigned char high = 0;
+
+#if defined(UTF8_SCAN_AVX2)
+  const __m256i threshold = _mm256_set1_epi8(-64);
+  __m256i any = _mm256_setzero_si256();
+
+  while (i + 32 <= length) {
+    // the per-byte counters must be summed before they can overflow.
+    __m256i counts = _mm256_setzero_si256();
+    for (int blocks = 0; blocks < 255 && i + 32 <= length; blocks++, i += 32) {
+      __m256i block = _mm256_loadu_si256((const __m256i *) (s + i));
+      any = _mm256_or_si256(any, block);
+      counts = _mm256_sub_epi8(counts, _mm256_cmpgt_epi8(threshold, block));
+    }
+
+    __m256i sums = _mm256_sad_epu8(counts, _mm256_setzero_si256());
+    continuations += _mm256_extract_epi16(sums, 0) + _mm256_extract_epi16(sums, 4) +
+                     _mm256_extract_epi16(sums, 8) + _mm256_extract_epi16(sums, 12);
+  }
+
+  if (_mm256_movemask_epi8(any) != 0) high = 0x80;
+#elif defined(UTF8_SCAN_SSE2)
+  const __m128i threshold = _mm_set1_epi8(-64);
+  __m128i any = _mm_setzero_si128();
+
+  while (i + 16 <= length) {
+    // the per-byte counters must be summed before they can overflow.
+    __m128i counts = _mm_setzero_si128();
+    for (int blocks = 0; blocks < 255 && i + 16 <= length; blocks++, i += 16) {
+      __m128i block = _mm_loadu_si128((const __m128i *) (s + i));
+      any = _mm_or_si128(any, block);
+      counts = _mm_sub_epi8(counts, _mm_cmpgt_epi8(threshold, block));
+    }
+
+    __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+    continuations += _mm_extract_epi16(sums, 0) + _mm_extract_epi16(sums, 4);
+  }
+
+  if (_mm_movemask_epi8(any) != 0) high = 0x80;
+#endif
+
+  for (; i < length; i++) {
+    unsigned char c = (unsigned char) s[i];
+    high |= c;
+    continuations += (c & 0xC0) == 0x80;
+  }
+
+  *is_ascii = (high & 0x80) == 0;
+  return length - continuations;
+}
+
 // returns a pointer to the beginning of the pos'th utf8 codepoint
 // in the buffer at s
 char *utf8index(char *s, int pos) {
@@ -28,6 +28,7 @@ char *utf8_encode(unsigned int code);
 int utf8_number_bytes(int value);
 int utf8_decode(const uint8_t *bytes, uint32_t length);
 int utf8length(char *s);
+int utf8_scan(const char *s, int length, bool *is_ascii);
 char *utf8index(char *s, int pos);
 void utf8slice(char *s, int *start, int *end);
 char *utf8_toupper(char *s, int length);
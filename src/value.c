@@ -3,6 +3,8 @@
 #include "memory.h"
 #include "object.h"
 
+#include <float.h>
+#include <math.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -11,6 +13,7 @@
 void init_value_arr(b_value_arr *array) {
   array->capacity = 0;
   array->count = 0;
+  array->head = 0;
   array->values = NULL;
 }
 
@@ -19,19 +22,71 @@ void init_byte_arr(b_byte_arr *array, int length) {
   array->bytes = NULL;
 }
 
+/**
+ * makes room for at least size values starting at array->values.
+ * space released at the front by shift_value_arr() is only reclaimed once
+ * it is at least as large as the live values so that moving them stays
+ * amortized O(1).
+ */
+static bool ensure_value_arr(b_vm *vm, b_value_arr *array, int size) {
+  if (array->capacity >= size) {
+    return true;
+  }
+
+  if (array->head > 0 && array->head >= array->count) {
+    b_value *base = array->values - array->head;
+    memmove(base, array->values, array->count * sizeof(b_value));
+    array->values = base;
+    array->capacity += array->head;
+    array->head = 0;
+
+    if (array->capacity >= size) {
+      return true;
+    }
+  }
+
+  int capacity = GROW_CAPACITY(array->capacity);
+  while (capacity < size) {
+    capacity = GROW_CAPACITY(capacity);
+  }
+
+  b_value *base = GROW_ARRAY(b_value, array->values - array->head,
+                             array->head + array->capacity, array->head + capacity);
+  if (base == NULL) {
+    return false;
+  }
+
+  array->values = base + array->head;
+  array->capacity = capacity;
+  return true;
+}
+
+/**
+ * moves the values of the array into a new allocation with free slots in
+ * front of them so that repeated inserts at index 0 are amortized O(1).
+ */
+static void reserve_value_arr_head(b_vm *vm, b_value_arr *array) {
+  int head = GROW_CAPACITY(array->count) - array->count;
+
+  b_value *base = ALLOCATE(b_value, head + array->capacity);
+  if (base == NULL) {
+    return;
+  }
+
+  memcpy(base + head, array->values, array->count * sizeof(b_value));
+  FREE_ARRAY(b_value, array->values, array->capacity);
+
+  array->values = base + head;
+  array->head = head;
+}
+
 void write_value_arr(b_vm *vm, b_value_arr *array, b_value value) {
   if (array == NULL) {
     return;
   }
 
-  if (array->capacity < array->count + 1) {
-    int old_capacity = array->capacity;
-    array->capacity = GROW_CAPACITY(old_capacity);
-    array->values =
-        GROW_ARRAY(b_value, array->values, old_capacity, array->capacity);
-    if (array->values == NULL) {
-      return;
-    }
+  if (!ensure_value_arr(vm, array, array->count + 1)) {
+    return;
   }
 
   array->values[array->count] = value;
@@ -43,25 +98,28 @@ void insert_value_arr(b_vm *vm, b_value_arr *array, b_value value, int index) {
     return;
   }
 
-  if (array->capacity <= index) {
-    array->capacity = GROW_CAPACITY(index);
-    array->values =
-        GROW_ARRAY(b_value, array->values, array->count, array->capacity);
-  } else if (array->capacity < array->count + 2) {
-    int capacity = array->capacity;
-    array->capacity = GROW_CAPACITY(capacity);
-    array->values =
-        GROW_ARRAY(b_value, array->values, capacity, array->capacity);
+  if (index == 0 && array->count > 0) {
+    if (array->head == 0) {
+      reserve_value_arr_head(vm, array);
+    }
+
+    if (array->head > 0) {
+      array->values--;
+      array->head--;
+      array->capacity++;
+      array->values[0] = value;
+      array->count++;
+      return;
+    }
   }
 
-  if (array->values == NULL) {
+  if (!ensure_value_arr(vm, array, (index > array->count ? index : array->count) + 1)) {
     return;
   }
 
   if (index <= array->count) {
-    for (int i = array->count - 1; i >= index; i--) {
-      array->values[i + 1] = array->values[i];
-    }
+    memmove(array->values + index + 1, array->values + index,
+            (array->count - index) * sizeof(b_value));
   } else {
     for (int i = array->count; i < index; i++) {
       array->values[i] = NIL_VAL; // nil out overflow indices
@@ -73,8 +131,31 @@ void insert_value_arr(b_vm *vm, b_value_arr *array, b_value value, int index) {
   array->count++;
 }
 
+/**
+ * removes the first count values of the array in O(1) by moving the start
+ * of the array forward.
+ */
+void shift_value_arr(b_value_arr *array, int count) {
+  if (count <= 0) {
+    return;
+  } else if (count > array->count) {
+    count = array->count;
+  }
+
+  array->values += count;
+  array->head += count;
+  array->capacity -= count;
+  array->count -= count;
+
+  if (array->count == 0) {
+    array->values -= array->head;
+    array->capacity += array->head;
+    array->head = 0;
+  }
+}
+
 void free_value_arr(b_vm *vm, b_value_arr *array) {
-  FREE_ARRAY(b_value, array->values, array->capacity);
+  FREE_ARRAY(b_value, array->values - array->head, array->head + array->capacity);
   init_value_arr(array);
 }
 
@@ -83,12 +164,305 @@ void free_byte_arr(b_vm *vm, b_byte_arr *array) {
   init_byte_arr(array, 0);
 }
 
-static void print_number(const double x) {
-  if (x >= INT64_MIN && x <= INT64_MAX && x == (int64_t)x) {
-    printf(INTEGER_PRINT_FORMAT, (long long)(int64_t)x);
+static const char number_digit_pairs[201] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+/**
+ * writes the decimal digits of value ending just before end and returns a
+ * pointer to the first digit.
+ */
+static inline char *format_digits(char *end, uint64_t value) {
+  while (value >= 100) {
+    const char *pair = number_digit_pairs + (value % 100) * 2;
+    value /= 100;
+    *--end = pair[1];
+    *--end = pair[0];
+  }
+
+  if (value >= 10) {
+    const char *pair = number_digit_pairs + value * 2;
+    *--end = pair[1];
+    *--end = pair[0];
   } else {
-    printf(DOUBLE_PRINT_FORMAT, x);
+    *--end = (char) ('0' + value);
+  }
+  return end;
+}
+
+static int format_integer(int64_t value, char *buffer) {
+  char digits[NUMBER_BUFFER_SIZE];
+  char *end = digits + sizeof(digits);
+  char *start = format_digits(end, value < 0 ? 0 - (uint64_t) value : (uint64_t) value);
+
+  int length = 0;
+  if (value < 0) buffer[length++] = '-';
+  memcpy(buffer + length, start, end - start);
+  length += (int) (end - start);
+  buffer[length] = '\0';
+  return length;
+}
+
+#ifdef __SIZEOF_INT128__
+/**
+ * formats x exactly the way "%.17g" would for the values most programs
+ * print: finite non-integers between 1e-6 and 2^53 whose 17 significant
+ * digits can be computed with one 128-bit multiplication. The digits are
+ * rounded half to even like printf() does.
+ *
+ * returns -1 when x is outside that range.
+ */
+static int format_double(double x, char *buffer) {
+  static const uint64_t powers[20] = {
+      1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+      10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+      100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+      100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+      100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL,
+  };
+
+  double magnitude = x < 0 ? -x : x;
+  if (!(magnitude >= 1e-6 && magnitude < 9007199254740992.0)) {
+    return -1;
+  }
+
+  uint64_t bits;
+  memcpy(&bits, &magnitude, sizeof(bits));
+  int exponent = (int) (bits >> 52);
+  uint64_t mantissa = bits & ((1ULL << 52) - 1);
+  if (exponent == 0) return -1;
+  mantissa |= 1ULL << 52;
+  int shift = 1075 - exponent; // magnitude == mantissa / 2^shift
+
+  // exponent of the leading decimal digit, fixed up below when the guess is
+  // off by one.
+  int x10 = 0;
+  if (magnitude >= 1) {
+    while (x10 < 15 && magnitude >= (double) powers[x10 + 1]) x10++;
+  } else {
+    while (x10 > -6 && magnitude * (double) powers[-x10] < 1) x10--;
+  }
+
+  unsigned __int128 product, remainder, half;
+  uint64_t digits = 0;
+  for (int attempt = 0;; attempt++) {
+    int scale = 16 - x10;
+    if (attempt == 3 || scale < 1 || scale > 22 || shift <= 0 || shift > 127) return -1;
+
+    product = (unsigned __int128) mantissa * powers[scale > 19 ? 19 : scale];
+    if (scale > 19) product *= powers[scale - 19];
+
+    digits = (uint64_t) (product >> shift);
+    if (digits >= 100000000000000000ULL) {
+      x10++;
+    } else if (digits < 10000000000000000ULL) {
+      x10--;
+    } else {
+      break;
+    }
+  }
+
+  remainder = product & (((unsigned __int128) 1 << shift) - 1);
+  half = (unsigned __int128) 1 << (shift - 1);
+  if (remainder > half || (remainder == half && (digits & 1))) {
+    // rounding up to the next power of ten moves the exponent like printf.
+    if (++digits == 100000000000000000ULL) {
+      digits /= 10;
+      x10++;
+    }
+  }
+
+  char text[17];
+  format_digits(text + 17, digits);
+
+  int significant = 17;
+  while (significant > 1 && text[significant - 1] == '0') significant--;
+
+  int length = 0;
+  if (x < 0) buffer[length++] = '-';
+
+  if (x10 < -4) {
+    buffer[length++] = text[0];
+    if (significant > 1) {
+      buffer[length++] = '.';
+      memcpy(buffer + length, text + 1, significant - 1);
+      length += significant - 1;
+    }
+    buffer[length++] = 'e';
+    buffer[length++] = '-';
+    buffer[length++] = '0';
+    buffer[length++] = (char) ('0' - x10);
+  } else if (x10 < 0) {
+    buffer[length++] = '0';
+    buffer[length++] = '.';
+    memset(buffer + length, '0', -x10 - 1);
+    length += -x10 - 1;
+    memcpy(buffer + length, text, significant);
+    length += significant;
+  } else {
+    memcpy(buffer + length, text, x10 + 1);
+    length += x10 + 1;
+    if (significant > x10 + 1) {
+      buffer[length++] = '.';
+      memcpy(buffer + length, text + x10 + 1, significant - x10 - 1);
+      length += significant - x10 - 1;
+    }
+  }
+
+  buffer[length] = '\0';
+  return length;
+}
+#endif
+
+int format_number(double x, char *buffer) {
+  if (x >= INT64_MIN && x <= INT64_MAX && x == (int64_t)x) {
+    return format_integer((int64_t)x, buffer);
+  }
+
+#ifdef __SIZEOF_INT128__
+  int length = format_double(x, buffer);
+  if (length >= 0) {
+    return length;
+  }
+#endif
+
+  return snprintf(buffer, NUMBER_BUFFER_SIZE, DOUBLE_PRINT_FORMAT, x);
+}
+
+static double parse_number_slow(const char *chars, size_t length) {
+  char stack_buffer[64];
+  char *buffer = length < sizeof(stack_buffer) ? stack_buffer : (char *) malloc(length + 1);
+  if (buffer == NULL) {
+    return 0;
+  }
+
+  memcpy(buffer, chars, length);
+  buffer[length] = '\0';
+
+  double value = strtod(buffer, NULL);
+  if (buffer != stack_buffer) {
+    free(buffer);
+  }
+  return value;
+}
+
+static inline bool is_number_space(char c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+/**
+ * parses the decimal number at the start of the first length bytes of chars
+ * the same way strtod() does, including its leading whitespace and trailing
+ * garbage handling.
+ *
+ * numbers with at most 19 significant digits and a small decimal exponent are
+ * computed exactly without strtod(). everything else (hexadecimal floats,
+ * inf, nan and very large or small exponents) is handed to strtod().
+ */
+double parse_number(const char *chars, size_t length) {
+  static const double exact_powers[23] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+  };
+
+  const char *p = chars, *end = chars + length;
+  while (p < end && is_number_space(*p)) p++;
+
+  bool negative = false;
+  if (p < end && (*p == '-' || *p == '+')) {
+    negative = *p++ == '-';
+  }
+
+  // strtod() also reads hexadecimal numbers.
+  if (p + 1 < end && p[0] == '0' && (p[1] == 'x' || p[1] == 'X')) {
+    return parse_number_slow(chars, length);
   }
+
+  uint64_t mantissa = 0;
+  int significant = 0, digits = 0, exponent = 0;
+
+  for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+    if (mantissa == 0 && *p == '0') continue;
+    if (++significant > 19) return parse_number_slow(chars, length);
+    mantissa = mantissa * 10 + (*p - '0');
+  }
+
+  if (p < end && *p == '.') {
+    for (p++; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+      exponent--;
+      if (mantissa == 0 && *p == '0') continue;
+      if (++significant > 19) return parse_number_slow(chars, length);
+      mantissa = mantissa * 10 + (*p - '0');
+    }
+  }
+
+  // no digits at all, e.g. inf, nan or garbage.
+  if (digits == 0) {
+    return parse_number_slow(chars, length);
+  }
+
+  // the exponent only counts when at least one digit follows it.
+  if (p < end && (*p == 'e' || *p == 'E')) {
+    const char *e = p + 1;
+    bool negative_exponent = false;
+    if (e < end && (*e == '-' || *e == '+')) {
+      negative_exponent = *e++ == '-';
+    }
+
+    if (e < end && *e >= '0' && *e <= '9') {
+      int value = 0;
+      for (; e < end && *e >= '0' && *e <= '9'; e++) {
+        if (value > 9999) return parse_number_slow(chars, length);
+        value = value * 10 + (*e - '0');
+      }
+      exponent += negative_exponent ? -value : value;
+    }
+  }
+
+  double value;
+  if (mantissa == 0) {
+    value = 0;
+  } else if (exponent == 0) {
+    // integers convert exactly (or round like strtod() above 2^53).
+    value = (double) mantissa;
+  }
+#if defined(FLT_EVAL_METHOD) && FLT_EVAL_METHOD == 0
+  // both operands are exact, so one correctly rounded operation is enough.
+  else if (mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+    value = exponent < 0
+            ? (double) mantissa / exact_powers[-exponent]
+            : (double) mantissa * exact_powers[exponent];
+  }
+#endif
+#ifdef __SIZEOF_INT128__
+  else if (exponent > 0 && exponent <= 19) {
+    value = (double) ((unsigned __int128) mantissa * (uint64_t) exact_powers[exponent]);
+  } else if (exponent < 0 && exponent >= -19) {
+    // divide with the mantissa moved to the top of 128 bits. the quotient keeps
+    // more than 60 bits and any remainder is folded into its lowest bit so that
+    // the conversion to double still rounds correctly.
+    int shift = 127 - (63 - __builtin_clzll(mantissa));
+    unsigned __int128 numerator = (unsigned __int128) mantissa << shift;
+    uint64_t divisor = (uint64_t) exact_powers[-exponent];
+
+    unsigned __int128 quotient = numerator / divisor;
+    if (numerator % divisor != 0) quotient |= 1;
+
+    value = ldexp((double) quotient, -shift);
+  }
+#endif
+  else {
+    return parse_number_slow(chars, length);
+  }
+
+  return negative ? -value : value;
+}
+
+static void print_number(const double x) {
+  char buffer[NUMBER_BUFFER_SIZE];
+  int length = format_number(x, buffer);
+  fwrite(buffer, sizeof(char), length, stdout);
 }
 
 static inline void do_print_value(b_value value, bool fix_string) {
@@ -132,25 +506,12 @@ void print_value(b_value value) { do_print_value(value, false); }
 void echo_value(b_value value) { do_print_value(value, true); }
 
 char *number_to_string(b_vm *vm, double x, int *length) {
-  if (x >= INT64_MIN && x <= INT64_MAX && x == (int64_t)x) {
-    *length = snprintf(NULL, 0, INTEGER_PRINT_FORMAT, (long long)(int64_t)x);
-    char *num_str = ALLOCATE(char, *length + 1);
-    if (num_str != NULL) {
-      sprintf(num_str, INTEGER_PRINT_FORMAT, (long long)(int64_t)x);
-      num_str[*length] = '\0';
-      return num_str;
-    }
-  } else {
-    *length = snprintf(NULL, 0, DOUBLE_PRINT_FORMAT, x);
-    char *num_str = ALLOCATE(char, *length + 1);
-    if (num_str != NULL) {
-      sprintf(num_str, DOUBLE_PRINT_FORMAT, x);
-      num_str[*length] = '\0';
-      return num_str;
-    }
-  }
+  char buffer[NUMBER_BUFFER_SIZE];
+  *length = format_number(x, buffer);
 
-  return strdup("");
+  char *num_str = ALLOCATE(char, *length + 1);
+  memcpy(num_str, buffer, *length + 1);
+  return num_str;
 }
 
 b_obj_string *value_to_string(b_vm *vm, b_value value) {
@@ -162,9 +523,9 @@ b_obj_string *value_to_string(b_vm *vm, b_value value) {
   else if (IS_BOOL(value))
     return copy_string(vm, AS_BOOL(value) ? "true" : "false", AS_BOOL(value) ? 4 : 5);
   else if (IS_NUMBER(value)) {
-    int length = 0;
-    char *num_str = number_to_string(vm, AS_NUMBER(value), &length);
-    return take_string(vm, num_str, length);
+    char buffer[NUMBER_BUFFER_SIZE];
+    int length = format_number(AS_NUMBER(value), buffer);
+    return copy_string(vm, buffer, length);
   } else
     return object_to_string(vm, value);
 #else
@@ -389,79 +750,288 @@ uint32_t hash_value(b_value value) {
 #endif
 }
 
+static inline int compare_strings(b_obj_string *a, b_obj_string *b) {
+  int length = a->length < b->length ? a->length : b->length;
+  int result = memcmp(a->chars, b->chars, length);
+  if (result != 0) return result;
+  return a->length - b->length;
+}
+
+#define COMPARE_NUMBERS(a, b) ((a) > (b) ? 1 : ((a) < (b) ? -1 : 0))
+
 /**
- * returns the greater of the two values.
+ * compares two values and returns a negative number, zero or a positive
+ * number if a is less than, equal to or greater than b respectively.
  * this function encapsulates Blade's object hierarchy
  */
-static b_value find_max_value(b_value a, b_value b) {
+int compare_values(b_value a, b_value b) {
   if (IS_NIL(a)) {
-    return b;
+    return IS_NIL(b) ? 0 : -1;
   } else if (IS_BOOL(a)) {
-    if (IS_NIL(b) || (IS_BOOL(b) && AS_BOOL(b) == false))
-      return a; // only nil, false and false are lower than numbers
-    else
-      return b;
+    if (IS_NIL(b)) return 1;
+    else if (IS_BOOL(b)) return (int) AS_BOOL(a) - (int) AS_BOOL(b);
+    else return -1; // only nil, false and true are lower than numbers
   } else if (IS_NUMBER(a)) {
     if (IS_NIL(b) || IS_BOOL(b))
-      return a;
+      return 1;
     else if (IS_NUMBER(b))
-      return AS_NUMBER(a) >= AS_NUMBER(b) ? a : b;
+      return COMPARE_NUMBERS(AS_NUMBER(a), AS_NUMBER(b));
     else
-      return b; // every other thing is greater than a number
+      return -1; // every other thing is greater than a number
   } else if (IS_OBJ(a)) {
-    if (IS_STRING(a) && IS_STRING(b)) {
-      return strcmp(AS_C_STRING(a), AS_C_STRING(b)) >= 0 ? a : b;
+    if (!IS_OBJ(b)) {
+      return 1;
+    } else if (IS_STRING(a) && IS_STRING(b)) {
+      return compare_strings(AS_STRING(a), AS_STRING(b));
     } else if (IS_FUNCTION(a) && IS_FUNCTION(b)) {
-      return AS_FUNCTION(a)->arity >= AS_FUNCTION(b)->arity
-             ? a
-             : b;
+      return AS_FUNCTION(a)->arity - AS_FUNCTION(b)->arity;
     } else if (IS_CLOSURE(a) && IS_CLOSURE(b)) {
-      return AS_CLOSURE(a)->function->arity >= AS_CLOSURE(b)->function->arity
-             ? a
-             : b;
+      return AS_CLOSURE(a)->function->arity - AS_CLOSURE(b)->function->arity;
     } else if (IS_RANGE(a) && IS_RANGE(b)) {
-      return AS_RANGE(a)->lower >= AS_RANGE(b)->lower ? a : b;
+      return COMPARE_NUMBERS(AS_RANGE(a)->lower, AS_RANGE(b)->lower);
     } else if (IS_CLASS(a) && IS_CLASS(b)) {
-      return AS_CLASS(a)->methods.count >= AS_CLASS(b)->methods.count ? a : b;
+      return AS_CLASS(a)->methods.count - AS_CLASS(b)->methods.count;
     } else if (IS_LIST(a) && IS_LIST(b)) {
-      return AS_LIST(a)->items.count >= AS_LIST(b)->items.count ? a : b;
+      return AS_LIST(a)->items.count - AS_LIST(b)->items.count;
     } else if (IS_DICT(a) && IS_DICT(b)) {
-      return AS_DICT(a)->names.count >= AS_DICT(b)->names.count ? a : b;
+      return AS_DICT(a)->names.count - AS_DICT(b)->names.count;
     } else if (IS_BYTES(a) && IS_BYTES(b)) {
-      return AS_BYTES(a)->bytes.count >= AS_BYTES(b)->bytes.count ? a : b;
+      return AS_BYTES(a)->bytes.count - AS_BYTES(b)->bytes.count;
     } else if (IS_FILE(a) && IS_FILE(b)) {
-      return strcmp(AS_FILE(a)->path->chars, AS_FILE(b)->path->chars) >= 0 ? a : b;
-    } else if (IS_OBJ(b)) {
-      return AS_OBJ(a)->type >= AS_OBJ(b)->type ? a : b;
+      return compare_strings(AS_FILE(a)->path, AS_FILE(b)->path);
     } else {
-      return a;
+      return (int) AS_OBJ(a)->type - (int) AS_OBJ(b)->type;
+    }
+  }
+
+  return 0;
+}
+
+#undef COMPARE_NUMBERS
+
+static bool number_greater(void *data, b_value a, b_value b) {
+  return AS_NUMBER(a) > AS_NUMBER(b);
+}
+
+static bool string_greater(void *data, b_value a, b_value b) {
+  return compare_strings(AS_STRING(a), AS_STRING(b)) > 0;
+}
+
+static bool value_greater(void *data, b_value a, b_value b) {
+  return compare_values(a, b) > 0;
+}
+
+// Runs shorter than this are extended with a binary insertion sort
+// before merging (see Python's listsort.txt).
+#define SORT_MIN_MERGE 32
+#define SORT_MAX_RUNS 85
+
+static inline int sort_min_run(int n) {
+  int r = 0;
+  while (n >= SORT_MIN_MERGE) {
+    r |= n & 1;
+    n >>= 1;
+  }
+  return n + r;
+}
+
+/**
+ * sorts values[lo..hi) given that values[lo..start) is already sorted.
+ */
+static void sort_binary_insertion(b_value *values, int lo, int hi, int start,
+                                  b_value_greater greater, void *data) {
+  if (start == lo) start++;
+
+  for (; start < hi; start++) {
+    b_value pivot = values[start];
+    int left = lo, right = start;
+
+    while (left < right) {
+      int mid = (left + right) >> 1;
+      if (greater(data, values[mid], pivot)) {
+        right = mid;
+      } else {
+        left = mid + 1;
+      }
+    }
+
+    memmove(values + left + 1, values + left, (start - left) * sizeof(b_value));
+    values[left] = pivot;
+  }
+}
+
+/**
+ * returns the length of the run beginning at lo, reversing it in place
+ * first if it is strictly descending so that stability is preserved.
+ */
+static int sort_count_run(b_value *values, int lo, int hi,
+                          b_value_greater greater, void *data) {
+  int run_hi = lo + 1;
+  if (run_hi == hi) return 1;
+
+  if (greater(data, values[lo], values[run_hi++])) {
+    while (run_hi < hi && greater(data, values[run_hi - 1], values[run_hi])) run_hi++;
+
+    for (int i = lo, j = run_hi - 1; i < j; i++, j--) {
+      b_value temp = values[i];
+      values[i] = values[j];
+      values[j] = temp;
     }
   } else {
-    return a;
+    while (run_hi < hi && !greater(data, values[run_hi - 1], values[run_hi])) run_hi++;
   }
+
+  return run_hi - lo;
 }
 
 /**
- * sorts values in an array using the bubble-sort algorithm
+ * merges the adjacent sorted runs values[lo..mid) and values[mid..hi).
+ * the buffer must be able to hold the shorter of the two runs.
+ */
+static void sort_merge(b_value *values, int lo, int mid, int hi, b_value *buffer,
+                       b_value_greater greater, void *data) {
+  // elements of either run that are already in place need not move.
+  while (lo < mid && !greater(data, values[lo], values[mid])) lo++;
+  if (lo == mid) return;
+  while (hi > mid && !greater(data, values[mid - 1], values[hi - 1])) hi--;
+
+  if (mid - lo <= hi - mid) {
+    int length = mid - lo;
+    for (int i = 0; i < length; i++) buffer[i] = values[lo + i];
+
+    int i = 0, j = mid, k = lo;
+    while (i < length && j < hi) {
+      if (greater(data, buffer[i], values[j])) {
+        values[k++] = values[j++];
+      } else {
+        values[k++] = buffer[i++];
+      }
+    }
+
+    while (i < length) {
+      values[k++] = buffer[i++];
+    }
+  } else {
+    int length = hi - mid;
+    for (int i = 0; i < length; i++) buffer[i] = values[mid + i];
+
+    int i = mid - 1, j = length - 1, k = hi - 1;
+    while (i >= lo && j >= 0) {
+      if (greater(data, values[i], buffer[j])) {
+        values[k--] = values[i--];
+      } else {
+        values[k--] = buffer[j--];
+      }
+    }
+
+    while (j >= 0) {
+      values[k--] = buffer[j--];
+    }
+  }
+}
+
+/**
+ * sorts values in an array using a stable natural merge sort (Timsort
+ * without galloping). buffer must have room for at least count / 2 + 1
+ * values and is only used as scratch space.
+ */
+void sort_values_with(b_value *values, int count, b_value *buffer,
+                      b_value_greater greater, void *data) {
+  if (count < 2) return;
+
+  int run_base[SORT_MAX_RUNS], run_length[SORT_MAX_RUNS];
+  int runs = 0, lo = 0, remaining = count;
+  int min_run = sort_min_run(count);
+
+  while (remaining > 0) {
+    int length = sort_count_run(values, lo, count, greater, data);
+
+    if (length < min_run) {
+      int forced = remaining <= min_run ? remaining : min_run;
+      sort_binary_insertion(values, lo, lo + forced, lo + length, greater, data);
+      length = forced;
+    }
+
+    run_base[runs] = lo;
+    run_length[runs] = length;
+    runs++;
+
+    // keep the pending run lengths decreasing faster than the fibonacci
+    // sequence so that the stack never overflows.
+    while (runs > 1) {
+      int n = runs - 2;
+
+      if ((n > 0 && run_length[n - 1] <= run_length[n] + run_length[n + 1]) ||
+          (n > 1 && run_length[n - 2] <= run_length[n - 1] + run_length[n])) {
+        if (run_length[n - 1] < run_length[n + 1]) n--;
+      } else if (run_length[n] > run_length[n + 1]) {
+        break;
+      }
+
+      sort_merge(values, run_base[n], run_base[n + 1],
+                 run_base[n + 1] + run_length[n + 1], buffer, greater, data);
+      run_length[n] += run_length[n + 1];
+      if (n == runs - 3) {
+        run_base[n + 1] = run_base[n + 2];
+        run_length[n + 1] = run_length[n + 2];
+      }
+      runs--;
+    }
+
+    lo += length;
+    remaining -= length;
+  }
+
+  while (runs > 1) {
+    int n = runs - 2;
+    if (n > 0 && run_length[n - 1] < run_length[n + 1]) n--;
+
+    sort_merge(values, run_base[n], run_base[n + 1],
+               run_base[n + 1] + run_length[n + 1], buffer, greater, data);
+    run_length[n] += run_length[n + 1];
+    if (n == runs - 3) {
+      run_base[n + 1] = run_base[n + 2];
+      run_length[n + 1] = run_length[n + 2];
+    }
+    runs--;
+  }
+}
+
+#undef SORT_MIN_MERGE
+#undef SORT_MAX_RUNS
+
+/**
+ * sorts values in an array in ascending order of Blade's object hierarchy.
+ * lists nested in the array are sorted as well.
  */
 void sort_values(b_value *values, int count) {
+  bool all_numbers = true, all_strings = true;
+
   for (int i = 0; i < count; i++) {
-    for (int j = 0; j < count; j++) {
-      if (values_equal(values[j], find_max_value(values[i], values[j]))) {
-        b_value temp = values[i];
-        values[i] = values[j];
-        values[j] = temp;
-
-        if (IS_LIST(values[i]))
-          sort_values(AS_LIST(values[i])->items.values,
-                      AS_LIST(values[i])->items.count);
-
-        if (IS_LIST(values[j]))
-          sort_values(AS_LIST(values[j])->items.values,
-                      AS_LIST(values[j])->items.count);
-      }
+    b_value value = values[i];
+
+    if (!IS_NUMBER(value)) all_numbers = false;
+    if (!IS_STRING(value)) all_strings = false;
+
+    if (IS_LIST(value) && AS_LIST(value)->items.values != values) {
+      sort_values(AS_LIST(value)->items.values, AS_LIST(value)->items.count);
     }
   }
+
+  if (count < 2) return;
+
+  b_value *buffer = (b_value *) malloc((count / 2 + 1) * sizeof(b_value));
+  if (buffer == NULL) return;
+
+  if (all_numbers) {
+    sort_values_with(values, count, buffer, number_greater, NULL);
+  } else if (all_strings) {
+    sort_values_with(values, count, buffer, string_greater, NULL);
+  } else {
+    sort_values_with(values, count, buffer, value_greater, NULL);
+  }
+
+  free(buffer);
 }
 
 b_value copy_value(b_vm *vm, b_value value) {
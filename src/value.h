@@ -128,6 +128,9 @@ typedef struct {
 typedef struct {
   int capacity;
   int count;
+  // number of slots released at the front of the allocation by shifting.
+  // the allocation itself starts at values - head.
+  int head;
   b_value *values;
 } b_value_arr;
 
@@ -144,6 +147,8 @@ void write_value_arr(b_vm *vm, b_value_arr *array, b_value value);
 
 void insert_value_arr(b_vm *vm, b_value_arr *array, b_value value, int index);
 
+void shift_value_arr(b_value_arr *array, int count);
+
 void print_value(b_value value);
 
 void echo_value(b_value value);
@@ -151,6 +156,14 @@ void echo_value(b_value value);
 const char *value_type(b_value value);
 
 bool values_equal(b_value a, b_value b);
+
+// large enough for any number written by format_number()
+#define NUMBER_BUFFER_SIZE 32
+
+int format_number(double x, char *buffer);
+
+double parse_number(const char *chars, size_t length);
+
 char *number_to_string(b_vm *vm, double x, int *length);
 
 b_obj_string *value_to_string(b_vm *vm, b_value value);
@@ -166,8 +179,16 @@ uint32_t hash_string(const char *key, int length);
 
 uint32_t hash_value(b_value value);
 
+// returns true if a must be ordered after b
+typedef bool (*b_value_greater)(void *data, b_value a, b_value b);
+
+int compare_values(b_value a, b_value b);
+
 void sort_values(b_value *values, int count);
 
+void sort_values_with(b_value *values, int count, b_value *buffer,
+                      b_value_greater greater, void *data);
+
 b_value copy_value(b_vm *vm, b_value value);
 
 #define EMPTY_STRING_VAL OBJ_VAL(copy_string(vm, "", 0))
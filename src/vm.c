@@ -1,11 +1,14 @@
 #include "vm.h"
+#include "bytecode.h"
 #include "common.h"
 #include "compiler.h"
 #include "config.h"
+#include "jit.h"
 #include "memory.h"
 #include "module.h"
 #include "native.h"
 #include "object.h"
+#include "pathinfo.h"
 #include "utf8.h"
 
 #include "bytes.h"
@@ -47,7 +50,7 @@ static b_value get_stack_trace(b_vm *vm) {
 
       // -1 because the IP is sitting on the next instruction to be executed
       size_t instruction = frame->ip - function->blob.code - 1;
-      int line = function->blob.lines[instruction];
+      int line = get_blob_line(&function->blob, (int) instruction);
 
       const char *trace_format = i != 0
           ? "    %s:%d -> %s()\n"
@@ -588,6 +591,7 @@ void init_vm(b_vm *vm) {
   vm->show_warnings = false;
   vm->should_print_bytecode = false;
   vm->should_exit_after_bytecode = false;
+  vm->use_bytecode_cache = false;
 
   vm->gray_count = 0;
   vm->gray_capacity = 0;
@@ -595,6 +599,13 @@ void init_vm(b_vm *vm) {
 
   vm->std_args = NULL;
   vm->std_args_count = 0;
+  vm->native_call_depth = 0;
+
+  for (int i = 0; i < REGEX_CACHE_SIZE; i++) {
+    vm->regexes[i] = NULL;
+  }
+  vm->regex_clock = 0;
+  vm->import_cache = NULL;
 
   init_table(&vm->modules);
   init_table(&vm->strings);
@@ -631,6 +642,8 @@ void free_vm(b_vm *vm) {
 
   // since every vm holds a unique copy.
   free_table(vm, &vm->strings);
+  free_regex_cache(vm);
+  free_import_cache(vm);
 
   free(vm->stack);
 
@@ -690,6 +703,12 @@ static bool call(b_vm *vm, b_obj_closure *closure, int arg_count) {
     return throw_exception(vm, "stack overflow");
   }
 
+#if defined(B_JIT)
+  if (++closure->function->hotness == JIT_THRESHOLD) {
+    jit_compile(vm, closure->function);
+  }
+#endif
+
   b_call_frame *frame = &vm->frames[vm->frame_count++];
   frame->closure = closure;
   frame->ip = closure->function->blob.code;
@@ -698,6 +717,312 @@ static bool call(b_vm *vm, b_obj_closure *closure, int arg_count) {
   return true;
 }
 
+/**
+ * small functions such as getters, predicates, setters and one-line lambdas
+ * are run in place of their call by call_inline without pushing a frame.
+ *
+ * a function qualifies if its body has no calls, no loops and reads no
+ * locals but its arguments and is at most INLINE_MAX_CODE bytes. an INLINE_PURE body only
+ * reads and computes, so it gives up and leaves the call to call() whenever
+ * an instruction needs more than the common case (a missing property, an
+ * operand that is not a number, an overloaded operator...). an
+ * INLINE_STORE body is a list of `local.name = local or constant` statements
+ * followed by the return of a local or constant. it cannot give up once it
+ * stores a property, so its locals are checked on entry instead.
+ */
+#define INLINE_MAX_CODE 64
+
+// the width of a `local or constant` operand of an INLINE_STORE at ip, or 0.
+static int inline_value_width(b_obj_func *function, int ip, uint32_t *locals) {
+  uint8_t *code = function->blob.code;
+  if (ip >= function->blob.count) {
+    return 0;
+  }
+
+  switch (code[ip]) {
+    case OP_GET_LOCAL: {
+      if (ip + 2 >= function->blob.count) {
+        return 0;
+      }
+
+      int slot = (code[ip + 1] << 8) | code[ip + 2];
+      if (slot > function->arity) {
+        return 0;
+      }
+
+      *locals |= 1u << slot;
+      return 3;
+    }
+    case OP_CONSTANT:
+      return ip + 2 < function->blob.count ? 3 : 0;
+    case OP_NIL:
+    case OP_TRUE:
+    case OP_FALSE:
+    case OP_ONE:
+      return 1;
+    default:
+      return 0;
+  }
+}
+
+static b_inline_kind classify_store(b_obj_func *function) {
+  uint8_t *code = function->blob.code;
+  int count = function->blob.count;
+  uint32_t instances = 0, values = 0;
+
+  int ip = 0;
+  for (;;) {
+    uint32_t instance = 0, value = 0;
+    if (code[ip] != OP_GET_LOCAL || inline_value_width(function, ip, &instance) == 0) {
+      break;
+    }
+
+    int width = inline_value_width(function, ip + 3, &value);
+    int store = ip + 3 + width;
+    if (width == 0 || store + 3 >= count || code[store] != OP_SET_PROPERTY || code[store + 3] != OP_POP) {
+      break;
+    }
+
+    instances |= instance;
+    values |= value;
+    ip = store + 4;
+  }
+
+  // an explicit return is followed by the implicit one the compiler adds.
+  uint32_t returned = 0;
+  int width = code[ip] == OP_EMPTY ? 1 : inline_value_width(function, ip, &returned);
+  int end = ip + width + 1;
+  if (ip == 0 || width == 0 || end > count || code[end - 1] != OP_RETURN ||
+      (end != count && (end + 2 != count || code[end] != OP_EMPTY))) {
+    return INLINE_NEVER;
+  }
+
+  function->inline_instances = instances;
+  function->inline_values = values;
+  return INLINE_STORE;
+}
+
+static b_inline_kind classify_inline(b_obj_func *function) {
+  uint8_t *code = function->blob.code;
+  int count = function->blob.count;
+
+  if (function->is_variadic || function->arity > 31 || count == 0 ||
+      count > INLINE_MAX_CODE || code[count - 1] != OP_RETURN) {
+    return INLINE_NEVER;
+  }
+
+  for (int ip = 0; ip < count;) {
+    switch (code[ip]) {
+      case OP_GET_LOCAL:
+      case OP_GET_UP_VALUE:
+      case OP_GET_GLOBAL:
+      case OP_CONSTANT:
+      case OP_GET_PROPERTY:
+      case OP_GET_SELF_PROPERTY:
+      case OP_JUMP_IF_FALSE:
+      case OP_JUMP: {
+        if (ip + 3 >= count) {
+          return INLINE_NEVER;
+        }
+
+        int operand = (code[ip + 1] << 8) | code[ip + 2];
+        if ((code[ip] == OP_GET_LOCAL && operand > function->arity) ||
+            ((code[ip] == OP_JUMP || code[ip] == OP_JUMP_IF_FALSE) && ip + 3 + operand >= count)) {
+          return INLINE_NEVER;
+        }
+        ip += 3;
+        break;
+      }
+
+      case OP_NIL:
+      case OP_TRUE:
+      case OP_FALSE:
+      case OP_ONE:
+      case OP_EMPTY:
+      case OP_ADD:
+      case OP_SUBTRACT:
+      case OP_MULTIPLY:
+      case OP_DIVIDE:
+      case OP_NEGATE:
+      case OP_NOT:
+      case OP_EQUAL:
+      case OP_GREATER:
+      case OP_LESS:
+      case OP_POP:
+      case OP_RETURN:
+        ip++;
+        break;
+
+      default:
+        return classify_store(function);
+    }
+  }
+
+  return INLINE_PURE;
+}
+
+static bool run_inline_pure(b_vm *vm, b_obj_closure *closure, b_value *slots) {
+  b_obj_func *function = closure->function;
+  uint8_t *ip = function->blob.code;
+  b_value *constants = function->blob.constants.values;
+  b_value *top = vm->stack_top;
+  b_value value;
+
+#define INLINE_SHORT() (ip += 2, (uint16_t)((ip[-2] << 8) | ip[-1]))
+#define INLINE_NUMBER_OP(type, op) \
+  if (!IS_NUMBER(top[-2]) || !IS_NUMBER(top[-1])) return false; \
+  top[-2] = type(AS_NUMBER(top[-2]) op AS_NUMBER(top[-1])); \
+  top--; \
+  break
+
+  for (;;) {
+    switch (*ip++) {
+      case OP_GET_LOCAL:
+        *top++ = slots[INLINE_SHORT()];
+        break;
+      case OP_GET_UP_VALUE:
+        *top++ = *closure->up_values[INLINE_SHORT()]->location;
+        break;
+      case OP_GET_GLOBAL: {
+        b_value name = constants[INLINE_SHORT()];
+        if (!table_get(&function->module->values, name, &value) && !table_get(&vm->globals, name, &value)) {
+          return false;
+        }
+        *top++ = value;
+        break;
+      }
+      case OP_CONSTANT:
+        *top++ = constants[INLINE_SHORT()];
+        break;
+      case OP_GET_PROPERTY:
+      case OP_GET_SELF_PROPERTY: {
+        b_value name = constants[INLINE_SHORT()];
+        if (!IS_INSTANCE(top[-1]) || !table_get(&AS_INSTANCE(top[-1])->properties, name, &value) ||
+            (ip[-3] == OP_GET_PROPERTY && is_private(AS_STRING(name)))) {
+          return false;
+        }
+        top[-1] = value;
+        break;
+      }
+      case OP_JUMP_IF_FALSE: {
+        uint16_t offset = INLINE_SHORT();
+        if (is_false(top[-1])) {
+          ip += offset;
+        }
+        break;
+      }
+      case OP_JUMP: {
+        uint16_t offset = INLINE_SHORT();
+        ip += offset;
+        break;
+      }
+      case OP_NIL: *top++ = NIL_VAL; break;
+      case OP_TRUE: *top++ = BOOL_VAL(true); break;
+      case OP_FALSE: *top++ = BOOL_VAL(false); break;
+      case OP_ONE: *top++ = NUMBER_VAL(1); break;
+      case OP_EMPTY: *top++ = EMPTY_VAL; break;
+      case OP_ADD: { INLINE_NUMBER_OP(NUMBER_VAL, +); }
+      case OP_SUBTRACT: { INLINE_NUMBER_OP(NUMBER_VAL, -); }
+      case OP_MULTIPLY: { INLINE_NUMBER_OP(NUMBER_VAL, *); }
+      case OP_DIVIDE: { INLINE_NUMBER_OP(NUMBER_VAL, /); }
+      case OP_GREATER: { INLINE_NUMBER_OP(BOOL_VAL, >); }
+      case OP_LESS: { INLINE_NUMBER_OP(BOOL_VAL, <); }
+      case OP_NEGATE:
+        if (!IS_NUMBER(top[-1])) {
+          return false;
+        }
+        top[-1] = NUMBER_VAL(-AS_NUMBER(top[-1]));
+        break;
+      case OP_NOT:
+        top[-1] = BOOL_VAL(is_false(top[-1]));
+        break;
+      case OP_EQUAL:
+        // instances may overload =
+        if (IS_INSTANCE(top[-2])) {
+          return false;
+        }
+        top[-2] = BOOL_VAL(values_equal(top[-2], top[-1]));
+        top--;
+        break;
+      case OP_POP:
+        top--;
+        break;
+      case OP_RETURN:
+        slots[0] = top[-1];
+        return true;
+      default:
+        return false;
+    }
+  }
+
+#undef INLINE_SHORT
+#undef INLINE_NUMBER_OP
+}
+
+static inline b_value read_inline_value(uint8_t **ip, b_value *slots, b_value *constants) {
+  uint8_t *code = *ip;
+  switch (code[0]) {
+    case OP_GET_LOCAL: *ip += 3; return slots[(code[1] << 8) | code[2]];
+    case OP_CONSTANT: *ip += 3; return constants[(code[1] << 8) | code[2]];
+    case OP_TRUE: *ip += 1; return BOOL_VAL(true);
+    case OP_FALSE: *ip += 1; return BOOL_VAL(false);
+    case OP_ONE: *ip += 1; return NUMBER_VAL(1);
+    case OP_EMPTY: *ip += 1; return EMPTY_VAL;
+    default: *ip += 1; return NIL_VAL;
+  }
+}
+
+static void run_inline_store(b_vm *vm, b_obj_func *function, b_value *slots) {
+  uint8_t *ip = function->blob.code;
+  b_value *constants = function->blob.constants.values;
+
+  for (;;) {
+    b_value target = read_inline_value(&ip, slots, constants);
+    if (*ip == OP_RETURN) {
+      slots[0] = target;
+      return;
+    }
+
+    b_value value = read_inline_value(&ip, slots, constants);
+    // OP_SET_PROPERTY name, OP_POP
+    table_set(vm, &AS_INSTANCE(target)->properties, constants[(ip[1] << 8) | ip[2]], value);
+    ip += 4;
+  }
+}
+
+static bool call_inline(b_vm *vm, b_obj_closure *closure, int arg_count) {
+  b_obj_func *function = closure->function;
+
+  if (B_UNLIKELY(function->inline_kind == INLINE_UNKNOWN)) {
+    function->inline_kind = classify_inline(function);
+  }
+
+  // the body can push at most one value per byte of code.
+  if (function->inline_kind == INLINE_NEVER || arg_count != function->arity ||
+      vm->stack_top - vm->stack + function->blob.count > (ptrdiff_t) vm->stack_capacity) {
+    return false;
+  }
+
+  b_value *slots = vm->stack_top - arg_count - 1;
+  if (function->inline_kind == INLINE_PURE) {
+    if (!run_inline_pure(vm, closure, slots)) {
+      return false;
+    }
+  } else {
+    for (int i = 0; i <= arg_count; i++) {
+      if (((function->inline_instances >> i) & 1 && !IS_INSTANCE(slots[i])) ||
+          ((function->inline_values >> i) & 1 && IS_EMPTY(slots[i]))) {
+        return false;
+      }
+    }
+
+    run_inline_store(vm, function, slots);
+  }
+
+  vm->stack_top = slots + 1;
+  return true;
+}
+
 static inline bool call_native_method(b_vm *vm, b_obj_native *native, int arg_count) {
   if (native->function(vm, arg_count, vm->stack_top - arg_count)) {
     CLEAR_GC();
@@ -708,12 +1033,94 @@ static inline bool call_native_method(b_vm *vm, b_obj_native *native, int arg_co
   return true;
 }
 
+static void write_loader_short(b_vm *vm, b_blob *blob, uint16_t value) {
+  write_blob(vm, blob, (value >> 8) & 0xff, 0);
+  write_blob(vm, blob, value & 0xff, 0);
+}
+
+/**
+ * lazily imported modules are compiled and run the first time they are
+ * used. the instruction using the module is finished by a loader function
+ * that runs the body of the module and then repeats op (with its name and
+ * arg_count arguments) on the module so that exceptions raised by the body
+ * unwind through the code using the module like those of any other call.
+ *
+ * the loader takes the place of the module and the arguments on the stack.
+ * an op of OP_RETURN leaves the value under it as it was for callers that
+ * step back to run their own instruction again.
+ */
+static bool load_lazy_module(b_vm *vm, b_obj_module *module, b_code op, b_obj_string *name, int arg_count) {
+  module->is_lazy = false;
+
+  b_obj_func *body = vm->use_bytecode_cache ? load_bytecode(vm, module) : NULL;
+  if (body == NULL) {
+    char *source = read_file(module->file);
+    if (source == NULL) {
+      return throw_exception(vm, "could not read import file %s", module->file);
+    }
+
+    body = compile(vm, module, source);
+    free(source);
+
+    if (body == NULL) {
+      return throw_exception(vm, "failed to import %s", module->name);
+    }
+
+    push(vm, OBJ_VAL(body));
+    if (vm->use_bytecode_cache) {
+      save_bytecode(vm, body);
+    }
+  } else {
+    push(vm, OBJ_VAL(body));
+  }
+  body->name = NULL;
+  register_module__FILE__(vm, module);
+
+  b_obj_closure *closure = new_closure(vm, body);
+  push(vm, OBJ_VAL(closure));
+
+  b_obj_func *function = new_function(vm, module, TYPE_FUNCTION);
+  function->arity = arg_count;
+  push(vm, OBJ_VAL(function));
+
+  b_blob *blob = &function->blob;
+  write_blob(vm, blob, OP_CONSTANT, 0);
+  write_loader_short(vm, blob, (uint16_t) add_constant(vm, blob, OBJ_VAL(closure)));
+  write_blob(vm, blob, OP_CALL, 0);
+  write_blob(vm, blob, 0, 0);
+  write_blob(vm, blob, OP_POP, 0);
+
+  for (int i = 0; i <= arg_count; i++) {
+    write_blob(vm, blob, OP_GET_LOCAL, 0);
+    write_loader_short(vm, blob, (uint16_t) i);
+  }
+
+  if (op != OP_RETURN) {
+    write_blob(vm, blob, op, 0);
+    if (name != NULL) {
+      write_loader_short(vm, blob, (uint16_t) add_constant(vm, blob, OBJ_VAL(name)));
+    }
+    if (op == OP_CALL || op == OP_INVOKE) {
+      write_blob(vm, blob, (uint8_t) arg_count, 0);
+    }
+  }
+  write_blob(vm, blob, OP_RETURN, 0);
+
+  b_obj_closure *loader = new_closure(vm, function);
+  pop_n(vm, 3);
+
+  return call(vm, loader, arg_count);
+}
+
 bool call_value(b_vm *vm, b_value callee, int arg_count) {
   if (IS_OBJ(callee)) {
     switch (OBJ_TYPE(callee)) {
       case OBJ_BOUND_METHOD: {
         b_obj_bound *bound = AS_BOUND(callee);
         vm->stack_top[-arg_count - 1] = bound->receiver;
+        if (call_inline(vm, bound->method, arg_count)) {
+          return true;
+        }
         return call(vm, bound->method, arg_count);
       }
 
@@ -721,6 +1128,9 @@ bool call_value(b_vm *vm, b_value callee, int arg_count) {
         b_obj_class *klass = AS_CLASS(callee);
         vm->stack_top[-arg_count - 1] = OBJ_VAL(new_instance(vm, klass));
         if (!IS_EMPTY(klass->initializer)) {
+          if (call_inline(vm, AS_CLOSURE(klass->initializer), arg_count)) {
+            return true;
+          }
           return call(vm, AS_CLOSURE(klass->initializer), arg_count);
         }
         if (klass->superclass != NULL && !IS_EMPTY(klass->superclass->initializer)) {
@@ -734,6 +1144,10 @@ bool call_value(b_vm *vm, b_value callee, int arg_count) {
 
       case OBJ_MODULE: {
         b_obj_module *module = AS_MODULE(callee);
+        if (module->is_lazy) {
+          return load_lazy_module(vm, module, OP_CALL, NULL, arg_count);
+        }
+
         b_value callable;
         if(table_get(&module->values, STRING_VAL(module->name), &callable)) {
           return call_value(vm, callable, arg_count);
@@ -743,6 +1157,9 @@ bool call_value(b_vm *vm, b_value callee, int arg_count) {
       }
 
       case OBJ_CLOSURE: {
+        if (call_inline(vm, AS_CLOSURE(callee), arg_count)) {
+          return true;
+        }
         return call(vm, AS_CLOSURE(callee), arg_count);
       }
 
@@ -887,6 +1304,10 @@ static bool invoke(b_vm *vm, b_obj_string *name, int arg_count) {
     switch (AS_OBJ(receiver)->type) {
       case OBJ_MODULE: {
         b_obj_module *module = AS_MODULE(receiver);
+        if (module->is_lazy) {
+          return load_lazy_module(vm, module, OP_INVOKE, name, arg_count);
+        }
+
         if (table_get(&module->values, OBJ_VAL(name), &value)) {
           if (is_private(name)) {
             return throw_access_error(vm, "cannot call private module method '%s'", name->chars);
@@ -1199,7 +1620,7 @@ static bool string_get_index(b_vm *vm, b_obj_string *string, bool will_assign) {
 
     int start = index, end = index + 1;
     if(!string->is_ascii){
-      utf8slice(string->chars, &start, &end);
+      string_utf8_slice(vm, string, &start, &end);
     }
 
     if (!will_assign) {
@@ -1228,7 +1649,13 @@ static bool string_get_ranged_index(b_vm *vm, b_obj_string *string, bool will_as
   int lower_index = IS_NUMBER(lower) ? AS_NUMBER(lower) : 0;
   int upper_index = IS_NIL(upper) ? length : AS_NUMBER(upper);
 
-  if (lower_index < 0 || (upper_index < 0 && ((length + upper_index) < 0)) || lower_index >= length) {
+  if (upper_index < 0)
+    upper_index = length + upper_index;
+
+  if (upper_index > length)
+    upper_index = length;
+
+  if (lower_index < 0 || upper_index < 0 || lower_index >= length || lower_index > upper_index) {
     // always return an empty string...
     if (!will_assign) {
       pop_n(vm, 3); // +1 for the string itself
@@ -1237,21 +1664,21 @@ static bool string_get_ranged_index(b_vm *vm, b_obj_string *string, bool will_as
     return true;
   }
 
-  if (upper_index < 0)
-    upper_index = length + upper_index;
-
-  if (upper_index > length)
-    upper_index = length;
-
   int start = lower_index, end = upper_index;
   if(!string->is_ascii) {
-    utf8slice(string->chars, &start, &end);
+    string_utf8_slice(vm, string, &start, &end);
   }
 
   if (!will_assign) {
     pop_n(vm, 3); // +1 for the string itself
   }
 
+  // strings are immutable so a full slice is the string itself.
+  if (start == 0 && end == string->length) {
+    push(vm, OBJ_VAL(string));
+    return true;
+  }
+
   push(vm, STRING_L_VAL(string->chars + start, end - start));
   return true;
 }
@@ -1311,11 +1738,12 @@ static bool bytes_get_ranged_index(b_vm *vm, b_obj_bytes *bytes, bool will_assig
   if (upper_index > bytes->bytes.count)
     upper_index = bytes->bytes.count;
 
+  // the bytes must stay on the stack while the slice is created.
+  b_obj_bytes *slice = slice_bytes(vm, bytes, lower_index, upper_index - lower_index);
   if (!will_assign) {
     pop_n(vm, 3); // +1 for the list itself
   }
-  push(vm, OBJ_VAL(copy_bytes(vm, bytes->bytes.bytes + lower_index,
-                              upper_index - lower_index)));
+  push(vm, OBJ_VAL(slice));
   return true;
 }
 
@@ -1444,6 +1872,7 @@ static bool bytes_set_index(b_vm *vm, b_obj_bytes *bytes, b_value index, b_value
   int position = _position < 0 ? bytes->bytes.count + _position : _position;
 
   if (position < bytes->bytes.count && position > -(bytes->bytes.count)) {
+    unshare_bytes(vm, bytes);
     bytes->bytes.bytes[position] = (unsigned char) byte;
     pop_n(vm, 3); // pop the value, index and bytes out
 
@@ -1469,22 +1898,18 @@ static bool concatenate(b_vm *vm) {
   } else if (IS_NUMBER(_a)) {
     double a = AS_NUMBER(_a);
 
-    int num_length = 0;
-    char *num_str = number_to_string(vm, a, &num_length);
+    char num_str[NUMBER_BUFFER_SIZE];
+    int num_length = format_number(a, num_str);
 
     b_obj_string *b = AS_STRING(_b);
 
     int length = num_length + b->length;
-    char *chars = ALLOCATE(char, (size_t) length + 1);
+    STRING_BUFFER(chars, length);
     memcpy(chars, num_str, num_length);
     memcpy(chars + num_length, b->chars, b->length);
     chars[length] = '\0';
 
-    int utf8len = utf8length(chars);
-    b_obj_string *result = take_string(vm, chars, length);
-    result->utf8_length = utf8len;
-
-    FREE(char, num_str);
+    b_obj_string *result = TAKE_STRING_BUFFER(chars, length);
 
     pop_n(vm, 2);
     push(vm, OBJ_VAL(result));
@@ -1492,20 +1917,16 @@ static bool concatenate(b_vm *vm) {
     b_obj_string *a = AS_STRING(_a);
     double b = AS_NUMBER(_b);
 
-    int num_length = 0;
-    char *num_str = number_to_string(vm, b, &num_length);
+    char num_str[NUMBER_BUFFER_SIZE];
+    int num_length = format_number(b, num_str);
 
     int length = num_length + a->length;
-    char *chars = ALLOCATE(char, (size_t) length + 1);
+    STRING_BUFFER(chars, length);
     memcpy(chars, a->chars, a->length);
     memcpy(chars + a->length, num_str, num_length);
     chars[length] = '\0';
 
-    int utf8len = utf8length(chars);
-    b_obj_string *result = take_string(vm, chars, length);
-    result->utf8_length = utf8len;
-
-    FREE(char, num_str);
+    b_obj_string *result = TAKE_STRING_BUFFER(chars, length);
 
     pop_n(vm, 2);
     push(vm, OBJ_VAL(result));
@@ -1514,15 +1935,12 @@ static bool concatenate(b_vm *vm) {
     b_obj_string *a = AS_STRING(_a);
 
     int length = a->length + b->length;
-    char *chars = ALLOCATE(char, length + 1);
+    STRING_BUFFER(chars, length);
     memcpy(chars, a->chars, a->length);
     memcpy(chars + a->length, b->chars, b->length);
     chars[length] = '\0';
 
-    // int new_utf8_length = utf8length(chars);
-    b_obj_string *result = take_string(vm, chars, length);
-    result->utf8_length = a->utf8_length + b->utf8_length;
-    // result->utf8_length = new_utf8_length;
+    b_obj_string *result = TAKE_STRING_BUFFER(chars, length);
 
     pop_n(vm, 2);
     push(vm, OBJ_VAL(result));
@@ -1533,6 +1951,44 @@ static bool concatenate(b_vm *vm) {
   return true;
 }
 
+/**
+ * joins the count stringified values on top of the stack with a single
+ * allocation. nil values are skipped the way concatenate() skips them and
+ * the result is nil when every value is nil.
+ */
+static void concatenate_n(b_vm *vm, int count) {
+  b_value *parts = vm->stack_top - count;
+  b_value last = NIL_VAL;
+  int length = 0, strings = 0;
+
+  for (int i = 0; i < count; i++) {
+    if (!IS_NIL(parts[i])) {
+      b_obj_string *part = AS_STRING(parts[i]);
+      length += part->length;
+      last = parts[i];
+      strings++;
+    }
+  }
+
+  if (strings > 1) {
+    STRING_BUFFER(chars, length);
+    char *end = chars;
+    for (int i = 0; i < count; i++) {
+      if (!IS_NIL(parts[i])) {
+        b_obj_string *part = AS_STRING(parts[i]);
+        memcpy(end, part->chars, part->length);
+        end += part->length;
+      }
+    }
+    chars[length] = '\0';
+
+    last = OBJ_VAL(TAKE_STRING_BUFFER(chars, length));
+  }
+
+  pop_n(vm, count);
+  push(vm, last);
+}
+
 static inline int floor_div(double a, double b) {
   int d = (int) a / (int) b;
   return d - ((d * b == a) & ((a < 0) ^ (b < 0)));
@@ -1569,6 +2025,21 @@ static double b_int_bin_op(b_code op, double a, double b) {
   return 0;
 }
 
+#if defined(B_JIT)
+double jit_number_op(b_code op, double a, double b) {
+  switch (op) {
+    case OP_REMINDER:
+      return modulo(a, b);
+    case OP_POW:
+      return pow(a, b);
+    case OP_F_DIVIDE:
+      return floor_div(a, b);
+    default:
+      return b_int_bin_op(op, a, b);
+  }
+}
+#endif
+
 b_ptr_result run(b_vm *vm, int exit_frame) {
   vm->current_frame = &vm->frames[vm->frame_count - 1];
 
@@ -1582,6 +2053,16 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
 
 #define READ_STRING() (AS_STRING(READ_CONSTANT()))
 
+// continues the current frame in machine code once its function is compiled.
+#if defined(B_JIT)
+#define JIT_RESUME() \
+  if (vm->current_frame->closure->function->jit != NULL) { \
+    jit_resume(vm, vm->current_frame); \
+  }
+#else
+#define JIT_RESUME()
+#endif
+
 #define PRE_BINARY_OP() \
       b_value __b = peek(vm, 0); \
       b_value __a = peek(vm, 1)
@@ -1871,6 +2352,13 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
       case OP_LOOP: {
         uint16_t offset = READ_SHORT();
         vm->current_frame->ip -= offset;
+#if defined(B_JIT)
+        b_obj_func *function = vm->current_frame->closure->function;
+        if (function->jit == NULL && ++function->hotness == JIT_THRESHOLD) {
+          jit_compile(vm, function);
+        }
+#endif
+        JIT_RESUME();
         break;
       }
 
@@ -1908,6 +2396,11 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
         break;
       }
 
+      case OP_CONCAT: {
+        concatenate_n(vm, READ_BYTE());
+        break;
+      }
+
       case OP_DUP: {
         push(vm, peek(vm, 0));
         break;
@@ -1997,6 +2490,14 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
           switch (AS_OBJ(peek(vm, 0))->type) {
             case OBJ_MODULE: {
               b_obj_module *module = AS_MODULE(peek(vm, 0));
+              if (module->is_lazy) {
+                if (!load_lazy_module(vm, module, OP_GET_PROPERTY, name, 0)) {
+                  EXIT_VM();
+                }
+                vm->current_frame = &vm->frames[vm->frame_count - 1];
+                break;
+              }
+
               if (table_get(&module->values, OBJ_VAL(name), &value)) {
                 if (is_private(name)) {
                   access_error("cannot get private module property '%s'", name->chars);
@@ -2175,6 +2676,14 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
           break;
         } else if (IS_MODULE(peek(vm, 0))) {
           b_obj_module *module = AS_MODULE(peek(vm, 0));
+          if (module->is_lazy) {
+            if (!load_lazy_module(vm, module, OP_GET_SELF_PROPERTY, name, 0)) {
+              EXIT_VM();
+            }
+            vm->current_frame = &vm->frames[vm->frame_count - 1];
+            break;
+          }
+
           if (table_get(&module->values, OBJ_VAL(name), &value)) {
             pop(vm); // pop the module...
             push(vm, value);
@@ -2266,6 +2775,7 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
           EXIT_VM();
         }
         vm->current_frame = &vm->frames[vm->frame_count - 1];
+        JIT_RESUME();
         break;
       }
       case OP_INVOKE: {
@@ -2275,6 +2785,7 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
           EXIT_VM();
         }
         vm->current_frame = &vm->frames[vm->frame_count - 1];
+        JIT_RESUME();
         break;
       }
       case OP_INVOKE_SELF: {
@@ -2284,6 +2795,7 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
           EXIT_VM();
         }
         vm->current_frame = &vm->frames[vm->frame_count - 1];
+        JIT_RESUME();
         break;
       }
 
@@ -2486,6 +2998,16 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
               break;
             }
             case OBJ_MODULE: {
+              if (AS_MODULE(peek(vm, 1))->is_lazy) {
+                // step back to index the module again once it is loaded.
+                vm->current_frame->ip -= 2;
+                if (!load_lazy_module(vm, AS_MODULE(peek(vm, 1)), OP_RETURN, NULL, 0)) {
+                  EXIT_VM();
+                }
+                vm->current_frame = &vm->frames[vm->frame_count - 1];
+                break;
+              }
+
               if (!module_get_index(vm, AS_MODULE(peek(vm, 1)), will_assign == (uint8_t) 1)) {
                 EXIT_VM();
               }
@@ -2540,6 +3062,16 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
               break;
             }
             case OBJ_MODULE: {
+              if (AS_MODULE(peek(vm, 2))->is_lazy) {
+                // step back to set the index again once the module is loaded.
+                vm->current_frame->ip--;
+                if (!load_lazy_module(vm, AS_MODULE(peek(vm, 2)), OP_RETURN, NULL, 0)) {
+                  EXIT_VM();
+                }
+                vm->current_frame = &vm->frames[vm->frame_count - 1];
+                break;
+              }
+
               module_set_index(vm, AS_MODULE(peek(vm, 2)), index, value);
               break;
             }
@@ -2588,6 +3120,7 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
           return PTR_OK;
         }
 
+        JIT_RESUME();
         break;
       }
 
@@ -2596,6 +3129,16 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
 
         b_value existing_module;
         if(table_get(&vm->modules, STRING_VAL(closure->function->module->file), &existing_module)) {
+          if (AS_MODULE(existing_module)->is_lazy) {
+            // step back to import the module again once it is loaded.
+            vm->current_frame->ip -= 3;
+            if (!load_lazy_module(vm, AS_MODULE(existing_module), OP_RETURN, NULL, 0)) {
+              EXIT_VM();
+            }
+            vm->current_frame = &vm->frames[vm->frame_count - 1];
+            break;
+          }
+
           add_known_module(vm, AS_MODULE(existing_module), closure->function->module->name);
           // attach same module to import closure for selective import
           closure->function->module = AS_MODULE(existing_module);
@@ -2608,6 +3151,21 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
         break;
       }
 
+      case OP_LAZY_IMPORT: {
+        b_obj_module *module = AS_MODULE(READ_CONSTANT());
+
+        b_value existing_module;
+        if (table_get(&vm->modules, STRING_VAL(module->file), &existing_module)) {
+          add_known_module(vm, AS_MODULE(existing_module), module->name);
+        } else {
+          // the module the compiler saw importing it may not be the one
+          // running now if its file was imported more than once.
+          module->parent = vm->current_frame->closure->function->module;
+          add_module(vm, module);
+        }
+        break;
+      }
+
       case OP_NATIVE_MODULE: {
         b_obj_string *module_name = READ_STRING();
         b_value value;
@@ -2800,6 +3358,7 @@ b_ptr_result run(b_vm *vm, int exit_frame) {
 #undef READ_LCONSTANT
 #undef READ_STRING
 #undef READ_LSTRING
+#undef JIT_RESUME
 #undef BINARY_OP
 #undef BINARY_MOD_OP
 }
@@ -2837,7 +3396,9 @@ b_value raw_closure_call(b_vm *vm, b_obj_closure *closure, b_obj_list *args, boo
   }
 
   call(vm, closure, arg_count);
+  vm->native_call_depth++;
   b_ptr_result vm_result = run(vm, vm->frame_count - 1);
+  vm->native_call_depth--;
 
   if(vm_result != PTR_OK) {
     exit(EXIT_RUNTIME);
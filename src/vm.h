@@ -2,6 +2,8 @@
 #define BLADE_VM_H
 
 typedef struct s_compiler b_compiler;
+typedef struct s_regex b_regex;
+typedef struct s_import_cache b_import_cache;
 
 #include "blob.h"
 #include "config.h"
@@ -70,9 +72,19 @@ struct s_vm {
   b_table methods_bytes;
   b_table methods_range;
 
+  // compiled regular expressions
+  b_regex *regexes[REGEX_CACHE_SIZE];
+  uint64_t regex_clock;
+
+  // resolved import paths
+  b_import_cache *import_cache;
+
   char **std_args;
   int std_args_count;
 
+  // closures called by native functions that have not returned yet.
+  int native_call_depth;
+
   // boolean flags
   bool is_repl;
   bool mark_value;
@@ -80,6 +92,7 @@ struct s_vm {
   bool show_warnings;
   bool should_print_bytecode;
   bool should_exit_after_bytecode;
+  bool use_bytecode_cache;
 
   // id
   uint64_t id;
@@ -91,6 +104,7 @@ void free_vm(b_vm *vm);
 void register__ROOT__(b_vm *vm);
 
 b_ptr_result interpret(b_vm *vm, b_obj_module *module, const char *source);
+b_ptr_result run(b_vm *vm, int exit_frame);
 
 void push(b_vm *vm, b_value value);
 b_value pop(b_vm *vm);
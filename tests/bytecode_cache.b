@@ -0,0 +1,68 @@
+import os
+import .scratch
+
+var dir = scratch.create('bytecode-cache')
+var cache_dir = os.join_paths(dir, 'cache')
+
+os.set_env('BLADE_CACHE_DIR', cache_dir, true)
+
+var module = os.join_paths(dir, 'module.b')
+var main = os.join_paths(dir, 'main.b')
+
+file(module, 'w').write('
+var greeting = "hello"
+
+def describe(x) {
+  using x {
+    when 1, 2 return "small"
+    when "big", true return "word"
+    default return greeting
+  }
+}
+
+class Counter {
+  var count = 0
+  increment() {
+    self.count++
+    return self
+  }
+}
+
+def adder(a) {
+  return @(b) { return a + b }
+}
+')
+
+file(main, 'w').write('
+import .module { describe, adder, Counter }
+import url
+
+echo [describe(1), describe("big"), describe(true), describe(nil), adder(2)(3.5), Counter().increment().increment().count]
+echo url.parse("http://example.com/a").host
+')
+
+var expected = '[small, word, word, hello, 5.5, 2]\nexample.com\n'
+var run = @() { return scratch.blade('"${main}"') }
+
+# the first run compiles the modules and caches them
+echo run() == expected
+echo os.read_dir(cache_dir).filter(@(f) { return f.ends_with('.bbc') }).length() > 0
+
+# the second run loads them from the cache
+echo run() == expected
+
+# changed modules are compiled again
+file(module, 'a').write('greeting = "changed"\n')
+echo run() == expected.replace('hello', 'changed')
+
+# even when the change keeps the size and the second of the modified time
+var mtime = file(module).stats().mtime
+var source = file(module).read()
+file(module, 'w').write(source.replace('changed', 'altered'))
+file(module).set_times(-1, mtime)
+echo run() == expected.replace('hello', 'altered')
+
+# and the cache can be turned off
+echo scratch.blade('-n "${main}"') == expected.replace('hello', 'altered')
+
+scratch.remove(dir)
@@ -13,3 +13,23 @@ c[4] = 79
 
 echo c
 echo c.to_string()
+
+# slices share the buffer of their parent until either is modified.
+var data = bytes(200)
+for i in 0..200 data[i] = i
+var part = data[10,150]
+data[10] = 255
+data.append(7)
+echo part[0] == 10 and part.length() == 140 and data[10] == 255
+part[1] = 0
+part.extend(bytes([1, 2]))
+echo data[11] == 11 and part[1] == 0 and part.length() == 142
+
+var fields = (bytes(100) + bytes([44]) + bytes(100)).split(bytes([44]))
+fields[0][0] = 9
+echo fields[0][0] == 9 and fields[1][0] == 0 and fields[1].length() == 100
+
+# a slice outlives its parent.
+var tail = bytes(1000)[900,]
+for i in 0..20000 { bytes(64) }
+echo tail.length() == 100 and tail[99] == 0
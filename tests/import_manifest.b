@@ -0,0 +1,45 @@
+import os
+import .scratch
+
+var dir = scratch.create('import-manifest')
+os.create_dir(os.join_paths(dir, '.blade'))
+os.create_dir(os.join_paths(dir, 'src'))
+
+file(os.join_paths(dir, 'src', 'greeter.b'), 'w').write('
+def greet(name) {
+  return "hello \${name}"
+}
+')
+
+file(os.join_paths(dir, 'src', 'names.b'), 'w').write('
+var first = "blade"
+')
+
+file(os.join_paths(dir, '.blade', 'imports'), 'w').write('
+# packages of this project
+greeter = src/greeter.b
+names=src/names.b
+')
+
+var main = os.join_paths(dir, 'main.b')
+file(main, 'w').write('
+import greeter
+import names
+import greeter as again
+import os
+
+echo greeter.greet(names.first)
+echo again.greet("again")
+echo os.platform != nil
+')
+
+var run = @() { return scratch.blade('-n "${main}"') }
+
+# packages listed in the manifest resolve to their paths
+echo run() == 'hello blade\nhello again\ntrue\n'
+
+# and packages missing from it are reported as before
+file(main, 'a').write('import missing\n')
+echo scratch.blade('-n "${main}" 2>&1').index_of('module not found') > -1
+
+scratch.remove(dir)
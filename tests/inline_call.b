@@ -0,0 +1,82 @@
+class Point {
+  Point(x, y) {
+    self.x = x
+    self.y = y
+  }
+
+  get_x() { return self.x }
+  sum() { return self.x + self.y }
+  is_origin() { return self.x == 0 and self.y == 0 }
+  peer_secret(other) { return other._secret }
+
+  move(x, y) {
+    self.x = x
+    self.y = y
+    return self
+  }
+}
+
+class Same {
+  def = {
+    return true
+  }
+}
+
+def less(a, b) { return a < b }
+def twice(a) { return a * 2 }
+def name_of(o) { return o.name }
+
+def rename(o, name) {
+  o.name = name
+  return o
+}
+
+var p = Point(3, 4)
+echo p.get_x()
+echo p.sum()
+echo p.is_origin()
+echo Point(0, 0).is_origin()
+echo p.move(5, 6).sum()
+echo p.x
+
+# calls that need more than the small body handles directly
+echo Point('a', 'b').sum()
+echo twice(21)
+echo twice('ab')
+echo less(1, 2)
+echo Same() == Same()
+echo name_of({name: 'dict'})
+echo rename({}, 'dict').name
+echo rename(p, 'point').name
+echo p.get_x(1)
+
+var factor = 3
+var scale = @(x) { return x * factor }
+echo [1, 2, 3].map(scale)
+
+def scaler(n) {
+  return @(x) { return x * n }
+}
+echo scaler(4)(5)
+
+p.x = p.get_x
+echo typeof(p.get_x())
+
+catch {
+  less('a', 'b')
+} as e
+echo e.message
+
+catch {
+  p.peer_secret(Point(1, 2))
+} as e
+echo e.message
+
+catch {
+  Point(1, 2).move(1)
+  echo Point(1, 2).sum()
+  Point(1, 2).sum(nil, nil)
+  p.peer_secret({_secret: true})
+  name_of(nil)
+} as e
+echo e.message
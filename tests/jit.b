@@ -0,0 +1,73 @@
+class Counter {
+  Counter() {
+    self.count = 0
+  }
+}
+
+def sum_to(n) {
+  var total = 0
+  iter var i = 0; i < n; i++ {
+    total = total + i * 2 - i / 2
+  }
+  return total
+}
+
+def mixed(values) {
+  var result = []
+  for value in values {
+    result.append(value + value)
+  }
+  return result
+}
+
+def fill(list, value) {
+  iter var i = 0; i < list.length(); i++ {
+    list[i] = value
+  }
+  return list
+}
+
+echo sum_to(5000)
+
+# a loop that changes the type of its operands part way
+var values = []
+iter var i = 0; i < 2000; i++ {
+  values.append(i < 1990 ? i : to_string(i))
+}
+echo mixed(values)[1986,]
+
+var counter = Counter()
+var step = 1
+var bump = @() {
+  iter var i = 0; i < 3000; i++ {
+    counter.count = counter.count + step
+    step = -step + 2
+  }
+}
+bump()
+echo counter.count
+
+echo fill([nil] * 5, 'x')
+
+var bits = 0
+iter var i = 0; i < 4000; i++ {
+  bits = (bits ^ i) % 1024 + (i >> 2 & 7) + (i // 3 == i / 3 ? 1 : 0)
+}
+echo bits
+
+catch {
+  var list = [1, 2, 3]
+  iter var i = 0; i < 5000; i++ {
+    list[i % 3] = list[i % 3] + 1
+    if i == 4500 list[i]
+  }
+} as e
+echo e.message
+
+catch {
+  var n = 0
+  iter var i = 0; i < 5000; i++ {
+    n = n + (i < 4000 ? i : nil)
+  }
+} as e
+echo e.message
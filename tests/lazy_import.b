@@ -0,0 +1,60 @@
+import os
+import .scratch
+
+var dir = scratch.create('lazy-import')
+
+file(os.join_paths(dir, 'shapes.b'), 'w').write('
+echo "loading shapes"
+
+var sides = 4
+
+def area(w, h) {
+  return w * h
+}
+
+class Square {
+  static describe() {
+    return "square"
+  }
+}
+')
+
+file(os.join_paths(dir, 'broken.b'), 'w').write('
+raise Exception("cannot load")
+')
+
+var main = os.join_paths(dir, 'main.b')
+file(main, 'w').write('
+import lazy .shapes
+import lazy .shapes as again
+import lazy .broken
+
+echo "started"
+echo typeof(shapes)
+echo shapes.area(3, 4)
+echo again.sides
+echo shapes["sides"]
+echo shapes.Square.describe()
+
+catch {
+  echo broken.anything
+} as e
+
+echo e.message
+')
+
+var expected = 'started\nmodule\nloading shapes\n12\n4\n4\nsquare\ncannot load\n'
+
+# the module body runs when the module is first used
+echo scratch.blade('-n "${main}"') == expected
+
+# including when the import is loaded from the bytecode cache
+os.set_env('BLADE_CACHE_DIR', os.join_paths(dir, 'cache'), true)
+echo scratch.blade('"${main}"') == expected
+echo scratch.blade('"${main}"') == expected
+
+# lazy modules cannot be imported selectively
+file(main, 'w').write('import lazy .shapes { area }\n')
+echo scratch.blade('-n "${main}" 2>&1').index_of('selective import on lazy module') > -1
+
+scratch.remove(dir)
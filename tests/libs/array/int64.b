@@ -24,4 +24,15 @@ echo f.to_bytes()
 
 echo f.first()
 echo f.get(11)
-echo f.last()
\ No newline at end of file
+echo f.last()
+var h = Int64Array([5, -3, 8, 1])
+echo h.sum()
+echo h.min()
+echo h.max()
+h.fill(2, 1, 3)
+echo h.to_list()
+echo h.slice(-2)
+h.copy(Int64Array([7, 7, 7]), 2)
+echo h.to_list()
+echo h.pop()
+echo h.to_list()
@@ -24,4 +24,15 @@ echo f.to_bytes()
 
 echo f.first()
 echo f.get(11)
-echo f.last()
\ No newline at end of file
+echo f.last()
+# values that do not fit the item type are rejected.
+catch {
+  g.fill(70000)
+} as e
+echo e.message
+catch {
+  g.fill(-1)
+} as e
+echo e.message
+g.fill(65535, 0, 2)
+echo g.first()
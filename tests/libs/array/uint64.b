@@ -0,0 +1,16 @@
+import array { * }
+
+# items of 2^63 and above do not fit a signed 64-bit integer.
+var g = UInt64Array([1, 2 ** 63])
+echo g.get(1) == 2 ** 63
+echo g.to_list() == [1, 2 ** 63]
+echo g.min()
+echo g.max() == 2 ** 63
+
+var h = UInt64Array([2 ** 63, 2 ** 63 + 4096])
+echo h.sum() == 2 ** 64 + 4096
+echo h.last() > h.first()
+
+h.fill(2 ** 64 - 2048)
+echo h.to_list() == [2 ** 64 - 2048, 2 ** 64 - 2048]
+echo h.reverse().first() == 2 ** 64 - 2048
@@ -0,0 +1,44 @@
+import heap
+
+var h = heap([5, 1, 4, 9, 2])
+echo h.peek()
+h.push(3)
+h.push(0)
+echo h.length()
+
+var popped = []
+while !h.is_empty() {
+  popped.append(h.pop())
+}
+echo popped
+echo h.pop()
+
+# comparator ordering
+var m = heap([5, 1, 4], @(a, b) { return b - a })
+m.push_all([7, 2, 8, 6])
+echo m.to_list()
+echo m.pop()
+echo m.push_pop(10)
+echo m.push_pop(3)
+echo m.pop()
+
+# priority queue of tasks
+var tasks = heap(nil, @(a, b) { return a.priority > b.priority })
+tasks.push({name: 'write', priority: 2})
+tasks.push({name: 'read', priority: 1})
+tasks.push({name: 'deploy', priority: 3})
+echo tasks.pop().name
+echo tasks.pop().name
+echo tasks
+
+# bound methods and natives work as comparators too
+class Descending {
+  compare(a, b) {
+    return b - a
+  }
+}
+
+var d = heap([5, 1, 4, 9, 2], Descending().compare)
+echo d.pop()
+echo d.pop()
+echo heap([0, 0, 0], max).pop()
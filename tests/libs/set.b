@@ -0,0 +1,28 @@
+import set
+
+var s = set([1, 2, 2, 3])
+echo s
+echo s.add(4)
+echo s.add(1)
+echo s.contains(4)
+echo s.contains(10)
+echo s.remove(2)
+echo s
+
+# dict initialization keeps the keys
+echo set({a: 1, b: 2})
+
+var a = set([1, 2, 3, 4, 5])
+var b = set([4, 5, 6, 7, 8])
+echo a.union(b)
+echo a.intersect(b)
+echo a.difference(b)
+echo a.symetric_difference(b)
+echo a.is_disjoint(b)
+echo set([1, 2]).is_subset(a)
+echo a.is_superset(set([1, 2]))
+echo a == set([5, 4, 3, 2, 1])
+
+for item in b {
+  echo item
+}
@@ -0,0 +1,31 @@
+import stringbuilder
+
+var sb = stringbuilder()
+for i in 0..3 {
+  sb.append('<li>').append(i).append('</li>')
+}
+echo sb.length()
+echo sb.to_string()
+echo sb.length()
+
+# mixed values
+sb.append('é').append(2.5).append(nil).append(true).append([1, 2]).append(bytes([33, 63]))
+echo sb.length()
+echo sb.to_string()
+
+# bytes output
+var b = stringbuilder(4).append_all(['ab', 'cd', 'ef'])
+echo b.to_bytes()
+echo b.length()
+
+# reuse after clear
+b.append('discarded')
+b.clear()
+echo b.append('kept').to_string()
+
+# large output
+var big = stringbuilder()
+for i in 0..10000 {
+  big.append('x')
+}
+echo big.to_string().length()
@@ -29,3 +29,17 @@ var list2 = [
 
 echo list2[0][2]++
 echo list2
+
+var unsorted = [5, 'b', nil, 2.5, 'a', true, [3, 1, 2]]
+echo unsorted.sort()
+echo [[1, 'b'], [0, 'c'], [1, 'a'], [0, 'd']].sort(@(x, y) { return x[0] > y[0] })
+echo [3, 1, 2].isort(@(x, y) { return y - x })
+
+var queue = [1, 2, 3, 4, 5]
+echo queue.shift()
+echo queue.shift(2)
+queue.insert(0, 0)
+queue.append(6)
+echo queue
+echo queue.remove_at(0)
+echo queue
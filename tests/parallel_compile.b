@@ -0,0 +1,55 @@
+import os
+import .scratch
+
+var dir = scratch.create('parallel-compile')
+var cache_dir = os.join_paths(dir, 'cache')
+var app_dir = os.join_paths(dir, 'app')
+os.create_dir(os.join_paths(app_dir, 'lib'))
+
+os.set_env('BLADE_CACHE_DIR', cache_dir, true)
+
+# a chain of modules where every module waits on the ones it imports
+for i in 0..10 {
+  var source = 'def value() { return ${i} }\n'
+  if i < 9 {
+    source = 'import .m${i + 1}\ndef value() { return ${i} + m${i + 1}.value() }\n'
+    if i < 8 source = 'import .m${i + 2}\n' + source
+  }
+
+  file(os.join_paths(app_dir, 'lib', 'm${i}.b'), 'w').write(source)
+}
+
+file(os.join_paths(app_dir, 'unused.b'), 'w').write('var unused = true\n')
+file(os.join_paths(app_dir, 'later.b'), 'w').write('def value() { return "later" }\n')
+
+var main = os.join_paths(app_dir, 'index.b')
+file(main, 'w').write('
+import .lib.m0
+import lazy .later
+
+echo m0.value()
+echo later.value()
+')
+
+var cached = @() {
+  return os.read_dir(cache_dir).filter(@(f) { return f.ends_with('.bbc') }).length()
+}
+
+# a file is compiled together with everything it imports
+echo scratch.blade_status('-j 4 "${main}"') == '0\n'
+echo cached() == 12
+
+# and a directory with every module in it
+echo scratch.blade_status('-j 0 "${app_dir}"') == '0\n'
+echo cached() == 13
+
+# the modules are then loaded from the cache
+echo scratch.blade('"${main}"') == '45\nlater\n'
+
+# modules that do not compile are reported
+file(os.join_paths(app_dir, 'broken.b'), 'w').write('var broken = \n')
+var output = scratch.blade_status('-j 2 "${app_dir}" 2>&1')
+echo output.index_of('broken.b') > -1
+echo output.ends_with('\n10\n')
+
+scratch.remove(dir)
@@ -0,0 +1,34 @@
+# helpers for the tests that run blade on scripts they write to a
+# directory of their own.
+import os
+
+# creates the empty directory of the named test and returns its path.
+def create(name) {
+  var temp = os.get_env('TMPDIR', os.get_env('TEMP', '/tmp'))
+  var dir = os.join_paths(temp, 'blade-${name}-test')
+  if os.dir_exists(dir) os.remove_dir(dir, true)
+  os.create_dir(dir)
+  return dir
+}
+
+def remove(dir) {
+  os.remove_dir(dir, true)
+}
+
+# returns the output of blade run with the given arguments.
+def blade(args) {
+  var command = '"${os.exe_path}" ${args}'
+
+  # cmd.exe drops the first and the last quote of the line it runs.
+  if os.platform == 'windows' command = '"${command}"'
+  return os.exec(command)
+}
+
+# returns the output of blade run with the given arguments followed by its
+# exit code on a line of its own.
+def blade_status(args) {
+  if os.platform == 'windows' {
+    return blade('${args} & call echo %^errorlevel%')
+  }
+  return blade('${args}; echo \$?')
+}
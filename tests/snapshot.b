@@ -0,0 +1,53 @@
+import os
+import .scratch
+
+var dir = scratch.create('snapshot')
+var script = os.join_paths(dir, 'main.b')
+var snapshot = os.join_paths(dir, 'main.snapshot')
+
+# passed by the environment as a path in the source would need escaping.
+os.set_env('BLADE_SNAPSHOT_TEST', snapshot, true)
+
+file(script, 'w').write('
+import os
+import reflect
+import url
+
+class Counter {
+  var count = 0
+  increment() {
+    self.count++
+    return self
+  }
+}
+
+var counter = Counter().increment()
+var squares = {}
+for i in 0..100 { squares[i] = i * i }
+
+def run() {
+  var name = "before"
+  var get_name = @() { return name }
+
+  catch {
+    var resumed = reflect.snapshot(os.get_env("BLADE_SNAPSHOT_TEST"))
+    name = "after"
+    echo [resumed, get_name(), counter.increment().count, squares[99], os.args[2,]]
+    raise Exception("caught")
+  } as e
+
+  echo e.message
+}
+
+run()
+echo url.parse("http://example.com/a").host
+')
+
+echo scratch.blade('"${script}" a')
+echo file(snapshot).exists()
+
+# resuming starts again from the call that saved the snapshot
+echo scratch.blade('-r "${snapshot}" b c')
+echo scratch.blade('-r "${snapshot}" d')
+
+scratch.remove(dir)
@@ -7,3 +7,47 @@ var message = '"I am great"'
 echo 'Simon says ${message}'
 
 echo '${message} at ${5 * 5}, This is ${"john's ${'last'.upper()} ${20}"} cent'
+
+# indexing long non-ASCII strings
+var text = ''
+for i in 0..150 {
+  text += ['a', 'é', '€', '𝄞'][i % 4]
+}
+echo text.length()
+echo text[0] + text[1] + text[2] + text[3]
+echo text[129] + text[-1]
+echo text[62,67]
+echo text[146,]
+
+# literal search methods
+echo 'a,b,,c,'.split(',')
+echo 'aaaa'.count('aa')
+echo 'the cat sat on the mat'.replace('at', 'og')
+echo 'héllo wörld wörld'.index_of('wörld', 8)
+
+# number parsing
+echo ['42'.to_number(), '  -3.25kg'.to_number(), '1.5e3'.to_number(), '0.10000000000000001'.to_number()]
+echo ['1e'.to_number(), '.5'.to_number(), 'abc'.to_number(), '0x1A'.to_number()]
+echo to_number('12345678901234567890') == 12345678901234567890
+
+# interpolation with skipped nil parts
+var nothing = nil
+echo '${nothing}|${1}${nothing}${"é"}|${[nothing]}|${nothing}${nothing}'.length()
+
+# untrimmed and fully sliced strings are returned as they are.
+var untrimmed = 'no surrounding spaces'
+echo untrimmed.trim() == untrimmed and untrimmed.ltrim() == untrimmed and untrimmed.rtrim() == untrimmed
+echo untrimmed[0,] == untrimmed and ' x '.trim() == 'x' and 'ab  '.rtrim() == 'ab'
+
+# short strings are stored inline, longer ones are not.
+var short = 'a' * 31, long = 'a' * 32
+echo short.length() == 31 and long.length() == 32 and short + 'a' == long and long[0,31] == short
+
+# reversed ranges are empty.
+echo 'abcdef'[4,1] == '' and 'abcdef'[4,-3] == '' and text[100,90] == ''
+
+# ASCII strings are detected when they are created.
+echo 'Hello, World'.upper() == 'HELLO, WORLD' and 'Hello, World'.lower() == 'hello, world'
+echo 'abc'.is_lower() and !'aBc'.is_lower() and 'ABC'.is_upper() and !'ABc'.is_upper()
+echo 'MiXeD'.case_fold() == 'mixed' and 'ÀB'.lower() == 'àb' and 'àb'.upper() == 'ÀB'
+echo 'héllo'.length() == 5 and 'héllo'[1] == 'é' and 'hello'[1] == 'e'